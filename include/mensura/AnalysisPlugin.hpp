@@ -39,6 +39,18 @@ public:
     /// Trivial destructor
     virtual ~AnalysisPlugin();
     
+public:
+    /**
+     * \brief Returns a string that fully describes the selection applied in the current dataset
+     * 
+     * A non-empty string declares that decisions of the filter are fully determined by this
+     * description and the content of the input file, so that they can be cached between runs
+     * (see PECEventIndexCache). Any change in the configuration that can affect the decisions must
+     * result in a different string. The method is called after BeginRun. The default
+     * implementation returns an empty string, which means that decisions cannot be cached.
+     */
+    virtual std::string GetCacheKey() const;
+    
 private:
     /**
      * \brief Reinterprets boolean decision issued by ProcessEvent
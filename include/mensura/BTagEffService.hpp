@@ -11,6 +11,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <regex>
 #include <string>
 #include <vector>
@@ -38,9 +39,27 @@ class Jet;
  * 
  * Histograms with efficiencies may be placed in in-file directories. This is useful to store
  * efficiencies for multiple versions of event selection.
+ * 
+ * Each histogram is read from the file only once, and it is shared among all clones of the
+ * service.
  */
 class BTagEffService: public Service
 {
+private:
+    /// Histograms read from the input file, shared among all clones of the service
+    struct HistCache
+    {
+        /// Mutex to protect the cache
+        std::mutex mutex;
+        
+        /**
+         * \brief Histograms indexed by their full paths in the input file
+         * 
+         * A null pointer is stored if the histogram is not found in the file.
+         */
+        std::map<std::string, std::shared_ptr<TH2 const>> hists;
+    };
+    
 public:
     /**
      * \brief Creates a service with the given name
@@ -65,7 +84,8 @@ private:
     /**
      * \brief Copy constructor
      * 
-     * The input file is shared with the source. The map with efficiency histograms is not copied.
+     * The input file and the cache of histograms read from it are shared with the source. The map
+     * with efficiency histograms for the current dataset is not copied.
      */
     BTagEffService(BTagEffService const &src) noexcept;
     
@@ -116,6 +136,14 @@ public:
     void SetDefaultEffLabel(std::string const &label);
     
 private:
+    /**
+     * \brief Returns histogram with the given full path in the input file
+     * 
+     * The histogram is read from the file if this has not been done by this or any other clone
+     * of the service. Returns a null pointer if the histogram does not exist.
+     */
+    std::shared_ptr<TH2 const> GetHistogram(std::string const &path);
+    
     /// Reads histograms with efficiencies for the given b tagger and current efficiency label
     void LoadEfficiencies(BTagger const &bTagger);
     
@@ -130,6 +158,9 @@ private:
      */
     std::shared_ptr<TFile> srcFile;
     
+    /// Cache of histograms read from the input file, shared among all clones of this
+    std::shared_ptr<HistCache> histCache;
+    
     /// Directory in the input ROOT file that contains histograms with b-tagging efficiencies
     std::string inFileDirectory;
     
@@ -151,5 +182,5 @@ private:
      * 
      * The key of the enclosed map is the absolute value of jet flavour.
      */
-    mutable std::unordered_map<BTagger, std::map<unsigned, std::shared_ptr<TH2>>> effHists;
+    mutable std::unordered_map<BTagger, std::map<unsigned, std::shared_ptr<TH2 const>>> effHists;
 };
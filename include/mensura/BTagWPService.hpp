@@ -3,6 +3,7 @@
 #include <mensura/Service.hpp>
 
 #include <mensura/BTagger.hpp>
+#include <mensura/JetCollection.hpp>
 #include <mensura/PhysicsObjects.hpp>
 
 #include <string>
@@ -67,6 +68,9 @@ public:
      */
     bool IsTagged(BTagger const &tagger, Jet const &jet) const;
     
+    /// Overloaded version of the above for jets stored in a JetCollection
+    bool IsTagged(BTagger const &tagger, JetCollection::JetProxy const &jet) const;
+    
     /// Sets or changes numeric threshold for the given b tagger
     void SetThreshold(BTagger const &tagger, double threshold);
     
@@ -24,6 +24,14 @@ public:
         DeepCSV  ///< CSV with DeepNN
     };
     
+    /**
+     * \brief Number of supported b-tagging algorithms
+     * 
+     * Algorithms are numbered consecutively from zero, and this constant can be used to define
+     * arrays indexed with them.
+     */
+    static constexpr unsigned numAlgorithms = 4;
+    
     /// Supported working points for b-tagging algorithms
     enum class WorkingPoint
     {
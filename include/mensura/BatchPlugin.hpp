@@ -0,0 +1,83 @@
+/**
+ * \file BatchPlugin.hpp
+ * 
+ * The module defines an abstract base class for filters that evaluate blocks of events.
+ */
+
+#pragma once
+
+#include <mensura/AnalysisPlugin.hpp>
+
+#include <vector>
+
+
+/**
+ * \class BatchPlugin
+ * \brief Abstract base class for filters that can evaluate a block of events at once
+ * 
+ * Some filters rely only on information that can be accessed ahead of the current event, such as
+ * event ID. Such a filter can compute decisions for the current event and a number of subsequent
+ * ones in a single call, which allows to implement the selection as a tight loop over contiguous
+ * arrays. Derived classes implement method ProcessBlock for this. When a plugin of this type is
+ * encountered in a path, the parent Processor requests decisions for a block of events once and
+ * then uses the stored selection mask for the following events instead of calling ProcessEvent
+ * for each of them.
+ * 
+ * The blocks evaluated must be consistent with the order in which events are delivered by
+ * readers. It is guaranteed that the Processor requests a new block only when all preceding
+ * plugins have processed the current event. Method ProcessEvent must still be implemented in a
+ * derived class and give the same decisions; it is used when the plugin is executed outside of
+ * a Processor.
+ */
+class BatchPlugin: public AnalysisPlugin
+{
+public:
+    /// Constructor
+    BatchPlugin(std::string const &name);
+    
+    /// Default copy constructor
+    BatchPlugin(BatchPlugin const &) = default;
+    
+    /// Default move constructor
+    BatchPlugin(BatchPlugin &&) = default;
+    
+    /// Default assignment operator
+    BatchPlugin &operator=(BatchPlugin const &) = default;
+    
+    /// Trivial destructor
+    virtual ~BatchPlugin();
+    
+public:
+    /**
+     * \brief Evaluates the filter for a block of events starting from the current one
+     * 
+     * The given mask is filled with decisions for the current event and up to (GetBlockSize() - 1)
+     * subsequent events. The actual processing is delegated to pure virtual method ProcessBlock.
+     * Throws an exception if no decision, even for the current event, has been provided.
+     */
+    void EvaluateBlock(std::vector<char> &mask);
+    
+    /// Returns maximal number of events to evaluate in a single block
+    unsigned GetBlockSize() const;
+    
+    /**
+     * \brief Sets maximal number of events to evaluate in a single block
+     * 
+     * Throws an exception if the given value is zero. The default value is 1024.
+     */
+    void SetBlockSize(unsigned blockSize);
+    
+private:
+    /**
+     * \brief Computes decisions for a block of events starting from the current one
+     * 
+     * The mask must be resized to the number of evaluated events, which must be at least one and
+     * must not exceed the value given as the first argument. Non-zero elements of the mask denote
+     * events that pass the filter.
+     */
+    virtual void ProcessBlock(unsigned maxEvents, std::vector<char> &mask) = 0;
+    
+private:
+    /// Maximal number of events to evaluate in a single block
+    unsigned blockSize;
+};
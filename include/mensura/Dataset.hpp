@@ -22,6 +22,10 @@
  * 
  * User can add arbitrary boolean flags to provide additional information about the dataset to
  * custom plugins.
+ * 
+ * Optionally, processing can be restricted to a range of entries in the input files. This is
+ * exploited by RunManager to spread a single large file over several threads and is only
+ * meaningful for datasets that contain a single file.
  */
 class Dataset
 {
@@ -76,6 +80,20 @@ public:
     
     /// Returns label that uniquely identifies the source dataset
     std::string const &GetSourceDatasetID() const;
+    
+    /// Returns index of the first entry to be processed in each input file
+    unsigned long GetFirstEntry() const;
+    
+    /**
+     * \brief Returns index of the last entry to be processed in each input file
+     * 
+     * The entry is included in the range. If the range has not been restricted, the largest
+     * representable value is returned.
+     */
+    unsigned long GetLastEntry() const;
+    
+    /// Checks if processing is restricted to a range of entries with the help of SetEntryRange
+    bool HasEntryRange() const;
 
     /**
      * \brief Computes event weight to obtain correct normalization in simulation
@@ -94,6 +112,14 @@ public:
      */
     bool IsMC() const;
     
+    /**
+     * \brief Restricts processing to the given range of entries in each input file
+     * 
+     * Both boundaries are included in the range. A reader plugin is expected to skip entries
+     * outside of the range. An exception is thrown if the range is empty.
+     */
+    void SetEntryRange(unsigned long firstEntry, unsigned long lastEntry);
+    
     /**
      * \brief Sets a flag with given name
      * 
@@ -179,4 +205,11 @@ private:
     
     /// A facility to emulate user-defined flags
     std::unordered_set<std::string> flags;
+    
+    /**
+     * \brief Range of entries to be processed in each input file
+     * 
+     * Both boundaries are included. By default, the range covers all entries.
+     */
+    unsigned long firstEntry, lastEntry;
 };
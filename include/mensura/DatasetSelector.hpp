@@ -53,6 +53,13 @@ public:
      */
     virtual Plugin *Clone() const override;
     
+    /**
+     * \brief Returns a description of the decision for the current dataset
+     * 
+     * Reimplemented from AnalysisPlugin.
+     */
+    virtual std::string GetCacheKey() const override;
+    
 private:
     /**
      * \brief Keeps or rejects the current event depending on whether the dataset is selected.
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+
+
+/**
+ * \class DeltaR2Kernel
+ * \brief Vectorised computation of squared angular distances
+ * 
+ * The methods compute the squared distance dR^2 = dEta^2 + dPhi^2 between a reference direction
+ * and each of n directions given by separate arrays of pseudorapidities and azimuthal angles
+ * (structure-of-arrays layout). When the CPU supports AVX2, four distances are computed at once;
+ * otherwise a scalar implementation is used. The choice is made at run time.
+ * 
+ * Both implementations reproduce bit for bit the expression
+ *   std::pow(eta - etas[i], 2) + std::pow(TVector2::Phi_mpi_pi(phi - phis[i]), 2)
+ * that is commonly used in the framework. The squared distance is used instead of dR itself to
+ * avoid evaluation of the square root.
+ */
+class DeltaR2Kernel
+{
+public:
+    /// Constructor is deleted
+    DeltaR2Kernel() = delete;
+    
+public:
+    /**
+     * \brief Computes squared distances to all given directions
+     * 
+     * The results are written to array dR2, which must have room for n elements.
+     */
+    static void Compute(double eta, double phi, double const *etas, double const *phis,
+      std::size_t n, double *dR2);
+    
+    /**
+     * \brief Finds the closest direction that satisfies given requirements
+     * 
+     * Only directions with dR^2 < maxDR2 and |pt - pts[i]| < maxDPt are considered. If several
+     * directions are equally close, the one with the smallest index is chosen. Returns n if no
+     * direction satisfies the requirements.
+     */
+    static std::size_t FindClosest(double eta, double phi, double pt, double const *etas,
+      double const *phis, double const *pts, std::size_t n, double maxDR2, double maxDPt);
+    
+    /**
+     * \brief Finds the first direction with dR^2 < maxDR2
+     * 
+     * Returns n if there is no such direction.
+     */
+    static std::size_t FindFirstWithin(double eta, double phi, double const *etas,
+      double const *phis, std::size_t n, double maxDR2);
+    
+    /// Checks whether the vectorised implementation is used
+    static bool UsesAVX2() noexcept;
+    
+private:
+    /// Vectorised version of Compute
+    static void ComputeAVX2(double eta, double phi, double const *etas, double const *phis,
+      std::size_t n, double *dR2);
+    
+    /// Scalar version of Compute
+    static void ComputeScalar(double eta, double phi, double const *etas, double const *phis,
+      std::size_t n, double *dR2);
+    
+    /// Squared distance between two directions computed with scalar arithmetics
+    static double Scalar(double eta1, double phi1, double eta2, double phi2);
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+
+/**
+ * \class EventArena
+ * \brief A monotonic memory resource whose memory is reused from event to event
+ * 
+ * Memory is handed out by advancing a pointer in large blocks, and deallocation is a no-op. All
+ * memory is reclaimed at once with method Reset, which is called by Processor at the start of
+ * each event. Blocks are kept across resets. If several blocks have been needed in an event, they
+ * are replaced by a single block of their total size at the next reset, so that once the arena has
+ * grown to the typical size of an event, no further allocations from the system are performed.
+ * 
+ * The arena is meant for containers that only live for the duration of an event, such as
+ * relations between particles. Objects allocated from it must not be used after the next reset.
+ * The class is not thread-safe; each Processor owns its own arena.
+ */
+class EventArena: public std::pmr::memory_resource
+{
+private:
+    /// A contiguous block of memory
+    struct Block
+    {
+        /// Start of the block
+        std::unique_ptr<std::byte[]> data;
+        
+        /// Size of the block, in bytes
+        std::size_t size;
+    };
+    
+public:
+    /// Creates an arena whose first block will have the given size
+    EventArena(std::size_t initialSize = 65536);
+    
+    /// Copy constructor is deleted
+    EventArena(EventArena const &) = delete;
+    
+    /// Assignment operator is deleted
+    EventArena &operator=(EventArena const &) = delete;
+    
+    /// Trivial destructor
+    virtual ~EventArena() noexcept;
+    
+public:
+    /// Returns total size of allocated blocks, in bytes
+    std::size_t GetCapacity() const noexcept;
+    
+    /**
+     * \brief Makes all memory available for new allocations
+     * 
+     * All memory previously obtained from the arena becomes invalid.
+     */
+    void Reset();
+    
+private:
+    /**
+     * \brief Allocates memory with the given size and alignment
+     * 
+     * Implemented from std::pmr::memory_resource.
+     */
+    virtual void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    
+    /**
+     * \brief Does nothing since memory is only reclaimed in Reset
+     * 
+     * Implemented from std::pmr::memory_resource.
+     */
+    virtual void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override;
+    
+    /**
+     * \brief Checks if the given resource is this arena
+     * 
+     * Implemented from std::pmr::memory_resource.
+     */
+    virtual bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override;
+    
+private:
+    /// Size of the first block to be allocated
+    std::size_t initialSize;
+    
+    /// Allocated blocks
+    std::vector<Block> blocks;
+    
+    /// Index of the block from which memory is currently being handed out
+    std::size_t curBlock;
+    
+    /// Offset of the first free byte in the current block
+    std::size_t offset;
+};
@@ -70,6 +70,13 @@ public:
      */
     virtual Plugin *Clone() const override;
     
+    /**
+     * \brief Returns a description of the list of event IDs for the current dataset
+     * 
+     * Reimplemented from AnalysisPlugin.
+     */
+    virtual std::string GetCacheKey() const override;
+    
     /// Changes name of the plugin that provides event ID
     void SetEventIDPluginName(std::string const &name);
     
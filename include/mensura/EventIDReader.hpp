@@ -33,6 +33,17 @@ public:
     /// Returns ID of the current event
     EventID const &GetEventID() const;
     
+    /**
+     * \brief Provides IDs of the current event and events that will be read after it
+     * 
+     * The given vector is filled with IDs of the current event and up to (maxEvents - 1)
+     * subsequent events, in the order in which they will be read. Fewer events can be provided if
+     * the reader cannot look further ahead, e.g. because the current input file ends. This is
+     * exploited by filters that evaluate blocks of events (see class BatchPlugin). The default
+     * implementation provides the current event only.
+     */
+    virtual void PeekEventIDs(unsigned maxEvents, std::vector<EventID> &eventIDs) const;
+    
 protected:
     /// ID of the current event converted into the standard format of the framework
     EventID eventID;
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <mensura/EventIDReader.hpp>
+
+#include <mensura/Dataset.hpp>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TTreeReader.h>
+#include <TTreeReaderValue.h>
+
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <string>
+
+
+/**
+ * \class FlatInputData
+ * \brief Opens flat columnar files and provides access to their columns
+ * 
+ * The plugin reads files in which each event is described by a single entry in a tree with
+ * branches of fundamental types and variable-length arrays of them (the format is described in
+ * README.md in the directory of this header). All files in a dataset are read one after another.
+ * The plugin reads the event ID, while dependant readers access other columns through the shared
+ * TTreeReader (see GetTreeReader). Columns are only read from the input file when they are
+ * accessed, and no dictionaries are needed.
+ * 
+ * If the dataset is restricted to a range of entries (see Dataset::SetEntryRange), only events
+ * from this range are read in each file.
+ */
+class FlatInputData: public EventIDReader
+{
+public:
+    /**
+     * \brief Creates plugin with the given name
+     * 
+     * User is encouraged to keep the default name.
+     */
+    FlatInputData(std::string const name = "InputData");
+    
+    /// The copy constructor is deleted
+    FlatInputData(FlatInputData const &) = delete;
+    
+    /// Default move constructor
+    FlatInputData(FlatInputData &&) = default;
+    
+    /// Assignment operator is deleted
+    FlatInputData &operator=(FlatInputData const &) = delete;
+    
+    /// Trivial destructor
+    virtual ~FlatInputData();
+    
+public:
+    /**
+     * \brief Performs initialization for a new dataset and opens first input file
+     * 
+     * Reimplemented from Plugin.
+     */
+    virtual void BeginRun(Dataset const &dataset) override;
+    
+    /**
+     * \brief Creates a newly configured clone
+     * 
+     * Implemented from Plugin.
+     */
+    virtual Plugin *Clone() const override;
+    
+    /**
+     * \brief Closes the current input file
+     * 
+     * Reimplemented from Plugin.
+     */
+    virtual void EndRun() override;
+    
+    /**
+     * \brief Returns the reader that provides access to columns in the input tree
+     * 
+     * Dependant plugins should create their TTreeReaderValue and TTreeReaderArray objects with
+     * this reader in their BeginRun. They remain valid when a new input file is opened. The reader
+     * is restarted at the end of each dataset so that objects for the next dataset can be
+     * registered with it. The reader is positioned at the current event by this plugin; the user
+     * must not change the entry.
+     */
+    TTreeReader &GetTreeReader() const;
+    
+    /// Changes the name of the input tree
+    void SetTreeName(std::string const &name);
+    
+private:
+    /**
+     * \brief Opens the next input file in the dataset
+     * 
+     * Returns true in case of success and false if there are no more input files left.
+     */
+    bool NextInputFile();
+    
+    /**
+     * \brief Reads the next event
+     * 
+     * Positions the tree reader at the next event and reads its ID. Calls NextInputFile if there
+     * are no events left in the current file. Returns true in case of success and false if there
+     * are no more events in the dataset.
+     * Implemented from Plugin.
+     */
+    virtual bool ProcessEvent() override;
+    
+private:
+    /// Files in the current dataset
+    std::list<std::filesystem::path> inputFiles;
+    
+    /// Iterator pointing to the next file in the dataset
+    std::list<std::filesystem::path>::const_iterator nextFileIt;
+    
+    /// Currently opened input file
+    std::unique_ptr<TFile> curInputFile;
+    
+    /// Name of the input tree
+    std::string treeName;
+    
+    /// Input tree from the current file
+    std::unique_ptr<TTree> tree;
+    
+    /**
+     * \brief Reader for the input tree
+     * 
+     * The same object is used for all input files so that dependant plugins do not need to be
+     * notified when a new file is opened.
+     */
+    std::unique_ptr<TTreeReader> treeReader;
+    
+    /// Indicates that the reader has been given a new tree, and its branches are not set up yet
+    bool newTreeSet;
+    
+    /// Columns with run and luminosity block numbers
+    std::unique_ptr<TTreeReaderValue<UInt_t>> runColumn, lumiColumn;
+    
+    /// Column with event number
+    std::unique_ptr<TTreeReaderValue<ULong64_t>> eventColumn;
+    
+    /// Index of the next event to read from the tree
+    unsigned long nextEvent;
+    
+    /// Index of the event that follows the last event to be read from the current tree
+    unsigned long endEvent;
+    
+    /**
+     * \brief Range of entries to read in each input file
+     * 
+     * Copied from the current dataset. Both boundaries are included.
+     */
+    unsigned long firstEntry, lastEntry;
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <mensura/JetMETReader.hpp>
+
+#include <mensura/LeptonReader.hpp>
+
+#include <TTreeReaderArray.h>
+#include <TTreeReaderValue.h>
+
+#include <memory>
+
+
+class FlatInputData;
+
+
+/**
+ * \class FlatJetMETReader
+ * \brief Provides reconstructed jets and MET from a flat columnar file
+ * 
+ * This plugin is the counterpart of PECJetMETReader for flat columnar files read with a
+ * FlatInputData plugin. Properties of jets are read from per-event arrays, one array per
+ * property, and jets are constructed directly from them. Jets that fail the kinematic selection
+ * (see SetSelection) or the ID are rejected before their four-momenta are built. By default, jets
+ * are cleaned against tight leptons produced by a LeptonReader with name "Leptons", which can be
+ * changed with ConfigureLeptonCleaning. Expected columns are listed in README.md in the directory
+ * of this header. Flavours of jets are read in simulation only.
+ * 
+ * Systematic variations and matching to generator-level jets are not supported.
+ */
+class FlatJetMETReader: public JetMETReader
+{
+public:
+    /**
+     * \brief Creates plugin with the given name
+     * 
+     * User is encouraged to keep the default name.
+     */
+    FlatJetMETReader(std::string const name = "JetMET");
+    
+    /// Copy constructor
+    FlatJetMETReader(FlatJetMETReader const &src) noexcept;
+    
+    /// Default move constructor
+    FlatJetMETReader(FlatJetMETReader &&) = default;
+    
+    /// Assignment operator is deleted
+    FlatJetMETReader &operator=(FlatJetMETReader const &) = delete;
+    
+    /// Trivial destructor
+    virtual ~FlatJetMETReader() noexcept;
+    
+public:
+    /**
+     * \brief Sets up reading of columns with jets and MET
+     * 
+     * Reimplemented from Plugin.
+     */
+    virtual void BeginRun(Dataset const &dataset) override;
+    
+    /**
+     * \brief Creates a newly configured clone
+     * 
+     * Implemented from Plugin.
+     */
+    virtual Plugin *Clone() const override;
+    
+    /**
+     * \brief Changes parameters of jet-lepton cleaning
+     * 
+     * Same as PECJetMETReader::ConfigureLeptonCleaning.
+     */
+    void ConfigureLeptonCleaning(std::string const leptonPluginName, double dR);
+    
+    /// A short-cut for the above method that uses jet radius as the minimal allowed separation
+    void ConfigureLeptonCleaning(std::string const leptonPluginName = "Leptons");
+    
+    /**
+     * \brief Returns radius parameter used in the jet clustering algorithm
+     * 
+     * Implemented from JetMETReader.
+     */
+    virtual double GetJetRadius() const override;
+    
+    /// Requests reading of raw MET
+    void ReadRawMET(bool enable = true);
+    
+    /**
+     * \brief Specifies whether jet ID selection should be applied or not
+     * 
+     * Same as PECJetMETReader::SetApplyJetID.
+     */
+    void SetApplyJetID(bool applyJetID);
+    
+    /// Specifies desired selection on jets
+    void SetSelection(double minPt, double maxAbsEta);
+    
+private:
+    /**
+     * \brief Marks the current event as pending
+     * 
+     * Columns are read only when jets and MET are requested for the first time.
+     * Reimplemented from Plugin.
+     */
+    virtual bool ProcessEvent() override;
+    
+    /**
+     * \brief Builds jets and MET from the columns
+     * 
+     * Reimplemented from ReaderPlugin.
+     */
+    virtual void UnpackEvent() override;
+    
+private:
+    /// Name of a plugin that reads flat files
+    std::string inputDataPluginName;
+    
+    /// Non-owning pointer to a plugin that reads flat files
+    FlatInputData const *inputDataPlugin;
+    
+    /// Columns with corrected four-momenta of jets
+    std::unique_ptr<TTreeReaderArray<Float_t>> jetPt, jetEta, jetPhi, jetMass;
+    
+    /// Column with fractions by which corrected jet momenta must be reduced to get raw momenta
+    std::unique_ptr<TTreeReaderArray<Float_t>> jetRawFactor;
+    
+    /// Columns with jet area and pileup discriminator
+    std::unique_ptr<TTreeReaderArray<Float_t>> jetArea, jetPileUpID;
+    
+    /// Columns with b-tagging discriminators
+    std::unique_ptr<TTreeReaderArray<Float_t>> jetBTagCSV, jetBTagCMVA, jetBTagDeepCSV;
+    
+    /// Column with bit flags of jet ID
+    std::unique_ptr<TTreeReaderArray<Int_t>> jetID;
+    
+    /**
+     * \brief Columns with jet flavours
+     * 
+     * Only set up in simulation.
+     */
+    std::unique_ptr<TTreeReaderArray<Int_t>> jetHadronFlavour, jetPartonFlavour;
+    
+    /// Columns with corrected MET
+    std::unique_ptr<TTreeReaderValue<Float_t>> metPt, metPhi;
+    
+    /**
+     * \brief Columns with raw MET
+     * 
+     * Only set up if reading of raw MET has been requested.
+     */
+    std::unique_ptr<TTreeReaderValue<Float_t>> rawMETPt, rawMETPhi;
+    
+    /// Minimal allowed transverse momentum
+    double minPt;
+    
+    /// Maximal allowed absolute value of pseudorapidity
+    double maxAbsEta;
+    
+    /// Specifies whether raw MET should be read
+    bool readRawMET;
+    
+    /// Specifies whether selection on jet ID should be applied
+    bool applyJetID;
+    
+    /**
+     * \brief Name of the plugin that produces leptons
+     * 
+     * If name is an empty string, no cleaning against leptons will be performed
+     */
+    std::string leptonPluginName;
+    
+    /// Non-owning pointer to a plugin that produces leptons
+    LeptonReader const *leptonPlugin;
+    
+    /**
+     * \brief Minimal squared dR distance to leptons
+     * 
+     * Exploited in jet cleaning.
+     */
+    double leptonDR2;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <mensura/LeptonReader.hpp>
+
+#include <TTreeReaderArray.h>
+
+#include <memory>
+#include <string>
+
+
+class FlatInputData;
+
+
+/**
+ * \class FlatLeptonReader
+ * \brief Constructs collections of analysis-level electrons and muons from a flat columnar file
+ * 
+ * This plugin is the counterpart of PECLeptonReader for flat columnar files read with a
+ * FlatInputData plugin. It applies the same selection to define loose and tight leptons, except
+ * that the selection on impact parameters of tight electrons is not available. Expected columns
+ * are listed in README.md in the directory of this header.
+ */
+class FlatLeptonReader: public LeptonReader
+{
+public:
+    /**
+     * \brief Creates plugin with the given name
+     * 
+     * User is encouraged to keep the default name.
+     */
+    FlatLeptonReader(std::string const name = "Leptons");
+    
+    /// Copy constructor
+    FlatLeptonReader(FlatLeptonReader const &src) noexcept;
+    
+    /// Default move constructor
+    FlatLeptonReader(FlatLeptonReader &&) = default;
+    
+    /// Assignment operator is deleted
+    FlatLeptonReader &operator=(FlatLeptonReader const &) = delete;
+    
+    /// Trivial destructor
+    virtual ~FlatLeptonReader() noexcept;
+    
+public:
+    /**
+     * \brief Sets up reading of columns with electrons and muons
+     * 
+     * Reimplemented from Plugin.
+     */
+    virtual void BeginRun(Dataset const &) override;
+    
+    /**
+     * \brief Creates a newly configured clone
+     * 
+     * Implemented from Plugin.
+     */
+    virtual Plugin *Clone() const override;
+    
+private:
+    /**
+     * \brief Marks the current event as pending
+     * 
+     * Columns are read only when leptons are requested for the first time.
+     * Reimplemented from Plugin.
+     */
+    virtual bool ProcessEvent() override;
+    
+    /**
+     * \brief Builds leptons from the columns
+     * 
+     * Reimplemented from ReaderPlugin.
+     */
+    virtual void UnpackEvent() override;
+    
+private:
+    /// Name of the plugin that reads flat files
+    std::string inputDataPluginName;
+    
+    /// Non-owning pointer to a plugin that reads flat files
+    FlatInputData const *inputDataPlugin;
+    
+    /// Columns with momenta of electrons
+    std::unique_ptr<TTreeReaderArray<Float_t>> electronPt, electronEta, electronPhi;
+    
+    /// Column with differences between pseudorapidities of superclusters and electrons
+    std::unique_ptr<TTreeReaderArray<Float_t>> electronDEtaSC;
+    
+    /// Column with relative isolation of electrons
+    std::unique_ptr<TTreeReaderArray<Float_t>> electronRelIso;
+    
+    /// Columns with charges of electrons and indices of tightest passed cut-based ID
+    std::unique_ptr<TTreeReaderArray<Int_t>> electronCharge, electronCutBasedID;
+    
+    /// Columns with momenta of muons
+    std::unique_ptr<TTreeReaderArray<Float_t>> muonPt, muonEta, muonPhi;
+    
+    /// Column with relative isolation of muons
+    std::unique_ptr<TTreeReaderArray<Float_t>> muonRelIso;
+    
+    /// Column with charges of muons
+    std::unique_ptr<TTreeReaderArray<Int_t>> muonCharge;
+    
+    /// Columns with decisions of loose and tight muon ID
+    std::unique_ptr<TTreeReaderArray<Bool_t>> muonLooseID, muonTightID;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <mensura/PileUpReader.hpp>
+
+#include <TTreeReaderValue.h>
+
+#include <memory>
+
+
+class FlatInputData;
+
+
+/**
+ * \class FlatPileUpReader
+ * \brief Reads information on pile-up from a flat columnar file
+ * 
+ * This plugin relies on FlatInputData to get access to the input file. The expected pile-up is
+ * only read in simulation.
+ */
+class FlatPileUpReader: public PileUpReader
+{
+public:
+    /**
+     * \brief Creates plugin with the given name
+     * 
+     * User is encouraged to keep the default name.
+     */
+    FlatPileUpReader(std::string const name = "PileUp");
+    
+    /// Copy constructor
+    FlatPileUpReader(FlatPileUpReader const &src) noexcept;
+    
+    /// Default move constructor
+    FlatPileUpReader(FlatPileUpReader &&) = default;
+    
+    /// Assignment operator is deleted
+    FlatPileUpReader &operator=(FlatPileUpReader const &) = delete;
+    
+    /// Trivial destructor
+    virtual ~FlatPileUpReader() noexcept;
+    
+public:
+    /**
+     * \brief Sets up reading of columns with pile-up information
+     * 
+     * Reimplemented from Plugin.
+     */
+    virtual void BeginRun(Dataset const &dataset) override;
+    
+    /**
+     * \brief Creates a newly configured clone
+     * 
+     * Implemented from Plugin.
+     */
+    virtual Plugin *Clone() const override;
+    
+private:
+    /**
+     * \brief Marks the current event as pending
+     * 
+     * Columns are read only when pile-up information is requested for the first time.
+     * Reimplemented from Plugin.
+     */
+    virtual bool ProcessEvent() override;
+    
+    /**
+     * \brief Reads pile-up information from the columns
+     * 
+     * Reimplemented from ReaderPlugin.
+     */
+    virtual void UnpackEvent() override;
+    
+private:
+    /// Name of the plugin that reads flat files
+    std::string inputDataPluginName;
+    
+    /// Non-owning pointer to a plugin that reads flat files
+    FlatInputData const *inputDataPlugin;
+    
+    /// Column with the number of reconstructed primary vertices
+    std::unique_ptr<TTreeReaderValue<Int_t>> numVerticesColumn;
+    
+    /**
+     * \brief Column with expected pile-up
+     * 
+     * Only set up in simulation.
+     */
+    std::unique_ptr<TTreeReaderValue<Float_t>> expectedPileUpColumn;
+    
+    /// Column with median angular pt density
+    std::unique_ptr<TTreeReaderValue<Float_t>> rhoColumn;
+};
@@ -2,8 +2,9 @@
 
 #include <mensura/PhysicsObjects.hpp>
 
-#include <list>
 #include <initializer_list>
+#include <memory_resource>
+#include <vector>
 
 
 /**
@@ -11,20 +12,30 @@
  * \brief Describes a generator-level particle
  * 
  * A particle is described by its four-momentum and PDG ID codes. It also stores collections of
- * (non-owning) pointers to its mothers and daughters.
+ * (non-owning) pointers to its mothers and daughters. Memory for these collections is obtained
+ * from the memory resource given to the constructor. Readers use the event arena of the Processor
+ * (see Processor::GetEventArena), and thus the collections of a particle owned by a reader are only
+ * valid for the current event. Copies of a particle use the default memory resource and are not
+ * subject to this restriction.
  */
 class GenParticle: public Candidate
 {
 public:
     /// Type of the container to store mothers and daughters
-    typedef std::list<GenParticle const *> collection_t;
+    typedef std::pmr::vector<GenParticle const *> collection_t;
 
 public:
     /// Default constructor
     GenParticle() noexcept;
     
-    /// Constructor with four-momentum and PDG ID code
-    GenParticle(TLorentzVector const &p4, int pdgId = 0) noexcept;
+    /**
+     * \brief Constructor with four-momentum and PDG ID code
+     * 
+     * The memory resource is used to allocate collections of mothers and daughters. It must
+     * outlive the particle.
+     */
+    GenParticle(PtEtaPhiMVector const &p4, int pdgId = 0,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) noexcept;
     
     /// Default copy constructor
     GenParticle(GenParticle const &) = default;
@@ -0,0 +1,552 @@
+#pragma once
+
+#include <mensura/BTagger.hpp>
+#include <mensura/PhysicsObjects.hpp>
+#include <mensura/UserProperties.hpp>
+
+#include <TLorentzVector.h>
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * \class JetCollection
+ * \brief A collection of jets stored as a structure of arrays
+ * 
+ * Each property of jets is stored in a separate contiguous array indexed with the position of the
+ * jet in the collection. This keeps loops that only access a few properties, such as transverse
+ * momenta and values of a b-tagging discriminator, compact in memory, and the arrays are reused
+ * from event to event without new allocations. Four-momenta are stored in terms of the fully
+ * corrected pt, pseudorapidity, azimuthal angle, and mass.
+ * 
+ * Individual jets are accessed through light-weight proxies of type JetCollection::JetProxy,
+ * which provide the same accessors as class Jet. A proxy can be converted into a standalone Jet
+ * when an object of that class is needed, but this is comparatively expensive. Proxies and
+ * iterators are invalidated when the collection is modified.
+ * 
+ * Jets are added with method Add, which returns the index of the new jet, and their properties are
+ * then set with setters that take this index. User-defined properties are stored in a separate
+ * array for each handle (see UserPropertyRegistry). The arrays are kept between events, so using a
+ * fixed set of properties does not lead to any allocations once the collection has reached its
+ * typical size.
+ */
+class JetCollection
+{
+public:
+    /**
+     * \class JetProxy
+     * \brief Provides read access to a single jet in the collection
+     * 
+     * Accessors follow those of class Jet. The proxy only stores a pointer to the collection and
+     * an index and is meant to be passed by value.
+     */
+    class JetProxy
+    {
+    public:
+        /// Constructor from the collection and index of the jet in it
+        JetProxy(JetCollection const &collection, std::size_t index) noexcept;
+    
+    public:
+        /**
+         * \brief Returns value of the requested b-tagging discriminator
+         * 
+         * Throws an exception if no value has been set for this algorithm.
+         */
+        double BTag(BTagger::Algorithm algo) const;
+        
+        /// Returns the electric charge
+        double Charge() const noexcept;
+        
+        /// Returns fully corrected four-momentum in the compact representation
+        PtEtaPhiMVector CompactP4() const noexcept;
+        
+        /// Returns energy, GeV
+        double E() const noexcept;
+        
+        /// Returns pseudorapidity
+        double Eta() const noexcept;
+        
+        /**
+         * \brief Returns jet flavour according to the requested definition
+         * 
+         * A value of zero is returned if flavour of the jet is not identified or has never been
+         * filled.
+         */
+        int Flavour(Jet::FlavourType type = Jet::FlavourType::Hadron) const;
+        
+        /// Returns the pull angle
+        double GetPullAngle() const noexcept;
+        
+        /// Returns jet area
+        double Area() const noexcept;
+        
+        /// Returns index of the jet in the collection
+        std::size_t Index() const noexcept;
+        
+        /// Returns mass, GeV/c^2
+        double M() const noexcept;
+        
+        /**
+         * \brief Returns matched generator-level jet (if applicable)
+         * 
+         * If no jet is matched or generator-level jets are not available, returns a null pointer.
+         */
+        GenJet const *MatchedGenJet() const noexcept;
+        
+        /// Returns fully corrected four-momentum
+        TLorentzVector P4() const noexcept;
+        
+        /// Returns azimuthal angle
+        double Phi() const noexcept;
+        
+        /// Returns value of pile-up ID discriminator
+        double PileUpID() const noexcept;
+        
+        /// Returns transverse momentum, GeV/c
+        double Pt() const noexcept;
+        
+        /// Returns raw four-momentum
+        TLorentzVector RawP4() const noexcept;
+        
+        /// Returns scale factor to compute raw momentum from the fully corrected one
+        double RawMomentumSF() const noexcept;
+        
+        /**
+         * \brief Returns value of the user-defined property with the given label
+         * 
+         * An exception is thrown if the property is not defined for this jet.
+         */
+        double UserFloat(std::string const &label) const;
+        
+        /// Returns value of the user-defined property with the given handle
+        double UserFloat(UserPropertyHandle handle) const;
+        
+        /**
+         * \brief Returns value of the user-defined property with the given label
+         * 
+         * An exception is thrown if the property is not defined for this jet.
+         */
+        long UserInt(std::string const &label) const;
+        
+        /// Returns value of the user-defined property with the given handle
+        long UserInt(UserPropertyHandle handle) const;
+        
+        /**
+         * \brief Builds a standalone Jet with the same properties
+         * 
+         * This involves allocation of memory and should be avoided in performance-critical code.
+         */
+        operator Jet() const;
+        
+        /// Ordering operator, which compares transverse momenta
+        bool operator<(JetProxy const &rhs) const noexcept;
+    
+    private:
+        /// Collection to which the jet belongs
+        JetCollection const *collection;
+        
+        /// Index of the jet in the collection
+        std::size_t index;
+    
+    friend class JetCollection;
+    };
+    
+    
+    /**
+     * \class ConstIterator
+     * \brief Iterator over jets in the collection
+     * 
+     * Dereferencing returns a proxy by value.
+     */
+    class ConstIterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = JetProxy;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = JetProxy;
+    
+    public:
+        /// Constructor from the collection and index of the jet it points to
+        ConstIterator(JetCollection const &collection, std::size_t index) noexcept;
+    
+    public:
+        /// Returns proxy for the jet the iterator points to
+        JetProxy operator*() const noexcept;
+        
+        /// Advances the iterator to the next jet
+        ConstIterator &operator++() noexcept;
+        
+        /// Checks if the two iterators point to the same jet
+        bool operator==(ConstIterator const &rhs) const noexcept;
+        
+        /// Checks if the two iterators point to different jets
+        bool operator!=(ConstIterator const &rhs) const noexcept;
+    
+    private:
+        /// Collection over which the iteration is performed
+        JetCollection const *collection;
+        
+        /// Index of the current jet
+        std::size_t index;
+    };
+    
+public:
+    /// Constructs an empty collection
+    JetCollection() noexcept;
+    
+    /// Default copy constructor
+    JetCollection(JetCollection const &) = default;
+    
+    /// Default move constructor
+    JetCollection(JetCollection &&) = default;
+    
+    /// Default assignment operator
+    JetCollection &operator=(JetCollection const &) = default;
+    
+public:
+    /**
+     * \brief Adds a new jet with the given fully corrected four-momentum
+     * 
+     * The second argument is a scale factor to calculate the raw momentum from the corrected one,
+     * as in Jet::SetCorrectedP4. Other properties of the jet are set to their default values,
+     * which are the same as for a default-constructed Jet. Returns index of the new jet.
+     */
+    std::size_t Add(PtEtaPhiMVector const &correctedP4, double rawMomentumSF);
+    
+    /**
+     * \brief Adds a copy of the given jet, which might belong to another collection
+     * 
+     * All properties, including user-defined ones, are copied. Returns index of the new jet.
+     */
+    std::size_t Add(JetProxy const &jet);
+    
+    /// Returns iterator pointing to the first jet
+    ConstIterator begin() const noexcept;
+    
+    /// Removes all jets from the collection without releasing allocated memory
+    void clear() noexcept;
+    
+    /// Checks if the collection is empty
+    bool empty() const noexcept;
+    
+    /// Returns iterator pointing past the last jet
+    ConstIterator end() const noexcept;
+    
+    /// Returns array of pseudorapidities of all jets
+    std::vector<double> const &EtaColumn() const noexcept;
+    
+    /// Returns array of azimuthal angles of all jets
+    std::vector<double> const &PhiColumn() const noexcept;
+    
+    /// Returns array of fully corrected transverse momenta of all jets
+    std::vector<double> const &PtColumn() const noexcept;
+    
+    /// Reserves memory for the given number of jets
+    void reserve(std::size_t capacity);
+    
+    /// Sets area of the jet with the given index
+    void SetArea(std::size_t index, double area);
+    
+    /// Sets value of a b-tagging discriminator for the jet with the given index
+    void SetBTag(std::size_t index, BTagger::Algorithm algo, double value);
+    
+    /// Sets electric charge of the jet with the given index
+    void SetCharge(std::size_t index, double charge);
+    
+    /**
+     * \brief Sets corrected and raw momentum of the jet with the given index
+     * 
+     * The meaning of the arguments is the same as in Jet::SetCorrectedP4.
+     */
+    void SetCorrectedP4(std::size_t index, PtEtaPhiMVector const &correctedP4,
+      double rawMomentumSF);
+    
+    /// Sets flavour of the jet with the given index according to the given definition
+    void SetFlavour(std::size_t index, Jet::FlavourType type, int flavour);
+    
+    /// Sets matched generator-level jet for the jet with the given index
+    void SetMatchedGenJet(std::size_t index, GenJet const *matchedJet);
+    
+    /// Sets value of pile-up ID discriminator for the jet with the given index
+    void SetPileUpID(std::size_t index, double puDiscriminator);
+    
+    /// Sets pull angle of the jet with the given index
+    void SetPullAngle(std::size_t index, double pullAngle);
+    
+    /// Sets or changes value of a user-defined real-valued property of the given jet
+    void SetUserFloat(std::size_t index, std::string const &label, double value);
+    
+    /// Sets or changes value of a user-defined real-valued property of the given jet
+    void SetUserFloat(std::size_t index, UserPropertyHandle handle, double value);
+    
+    /// Sets or changes value of a user-defined integer-valued property of the given jet
+    void SetUserInt(std::size_t index, std::string const &label, long value);
+    
+    /// Sets or changes value of a user-defined integer-valued property of the given jet
+    void SetUserInt(std::size_t index, UserPropertyHandle handle, long value);
+    
+    /// Returns number of jets in the collection
+    std::size_t size() const noexcept;
+    
+    /**
+     * \brief Orders jets in decreasing transverse momentum
+     * 
+     * The permutation is applied to all arrays in place. If the jets are already ordered, which
+     * is often the case, the arrays are not touched.
+     */
+    void SortByPt();
+    
+    /// Returns proxy for the jet with the given index
+    JetProxy operator[](std::size_t index) const noexcept;
+    
+private:
+    /**
+     * \brief Reorders the given array in place according to orderBuffer
+     * 
+     * The new i-th element is the old element with index orderBuffer[i]. The permutation is
+     * applied cycle by cycle, without copying the array.
+     */
+    template<typename T>
+    void ApplyPermutation(std::vector<T> &column);
+    
+    /// Reorders all arrays according to orderBuffer
+    void Permute();
+    
+    /// Throws an exception reporting that the requested b-tagging discriminator is not available
+    [[noreturn]] static void ThrowMissingBTag(BTagger::Algorithm algo);
+    
+    /// Throws an exception reporting an unsupported flavour definition
+    [[noreturn]] static void ThrowUnknownFlavour(Jet::FlavourType type);
+    
+private:
+    /// Fully corrected kinematics of the jets
+    std::vector<double> pt, eta, phi, mass;
+    
+    /// Scale factors to build raw four-momenta
+    std::vector<double> rawMomentumSF;
+    
+    /// Jet areas
+    std::vector<double> area;
+    
+    /// Pile-up ID discriminators
+    std::vector<double> puDiscriminator;
+    
+    /// Electric charges
+    std::vector<double> charge;
+    
+    /// Pull angles
+    std::vector<double> pullAngle;
+    
+    /**
+     * \brief Values of b-tagging discriminators
+     * 
+     * The outer array is indexed with the algorithm.
+     */
+    std::array<std::vector<double>, BTagger::numAlgorithms> bTags;
+    
+    /**
+     * \brief Masks that indicate which b-tagging discriminators have been set for each jet
+     * 
+     * The bit with index given by the algorithm is set if the corresponding value is available.
+     */
+    std::vector<unsigned char> bTagMasks;
+    
+    /**
+     * \brief Jet flavours
+     * 
+     * The outer array is indexed in the same way as the enumeration Jet::FlavourType.
+     */
+    std::array<std::vector<int>, 3> flavours;
+    
+    /// Pointers to matched generator-level jets
+    std::vector<GenJet const *> matchedGenJets;
+    
+    /**
+     * \brief Arrays of user-defined real-valued properties indexed by their handles
+     * 
+     * An empty value means that the property has not been set for the corresponding jet.
+     */
+    std::unordered_map<UserPropertyHandle, std::vector<std::optional<double>>> userFloats;
+    
+    /// Arrays of user-defined integer-valued properties indexed by their handles
+    std::unordered_map<UserPropertyHandle, std::vector<std::optional<long>>> userInts;
+    
+    /**
+     * \brief Buffers used in reordering of the arrays
+     * 
+     * The first one holds the new order of jets, and the second one is a working copy of it.
+     */
+    std::vector<std::size_t> orderBuffer, permBuffer;
+};
+
+
+// Simple accessors are defined in the header so that they can be inlined in loops over jets
+
+inline JetCollection::JetProxy::JetProxy(JetCollection const &collection_,
+  std::size_t index_) noexcept:
+    collection(&collection_), index(index_)
+{}
+
+
+inline double JetCollection::JetProxy::BTag(BTagger::Algorithm algo) const
+{
+    unsigned const slot = unsigned(algo);
+    
+    if (slot >= BTagger::numAlgorithms or not (collection->bTagMasks[index] & (1u << slot)))
+        ThrowMissingBTag(algo);
+    
+    return collection->bTags[slot][index];
+}
+
+
+inline double JetCollection::JetProxy::Charge() const noexcept
+{
+    return collection->charge[index];
+}
+
+
+inline double JetCollection::JetProxy::Eta() const noexcept
+{
+    return collection->eta[index];
+}
+
+
+inline int JetCollection::JetProxy::Flavour(Jet::FlavourType type /*= Jet::FlavourType::Hadron*/)
+  const
+{
+    unsigned const slot = unsigned(type);
+    
+    if (slot >= collection->flavours.size())
+        ThrowUnknownFlavour(type);
+    
+    return collection->flavours[slot][index];
+}
+
+
+inline double JetCollection::JetProxy::GetPullAngle() const noexcept
+{
+    return collection->pullAngle[index];
+}
+
+
+inline double JetCollection::JetProxy::Area() const noexcept
+{
+    return collection->area[index];
+}
+
+
+inline std::size_t JetCollection::JetProxy::Index() const noexcept
+{
+    return index;
+}
+
+
+inline double JetCollection::JetProxy::M() const noexcept
+{
+    return collection->mass[index];
+}
+
+
+inline GenJet const *JetCollection::JetProxy::MatchedGenJet() const noexcept
+{
+    return collection->matchedGenJets[index];
+}
+
+
+inline double JetCollection::JetProxy::Phi() const noexcept
+{
+    return collection->phi[index];
+}
+
+
+inline double JetCollection::JetProxy::PileUpID() const noexcept
+{
+    return collection->puDiscriminator[index];
+}
+
+
+inline double JetCollection::JetProxy::Pt() const noexcept
+{
+    return collection->pt[index];
+}
+
+
+inline double JetCollection::JetProxy::RawMomentumSF() const noexcept
+{
+    return collection->rawMomentumSF[index];
+}
+
+
+inline bool JetCollection::JetProxy::operator<(JetProxy const &rhs) const noexcept
+{
+    return (Pt() < rhs.Pt());
+}
+
+
+inline JetCollection::ConstIterator::ConstIterator(JetCollection const &collection_,
+  std::size_t index_) noexcept:
+    collection(&collection_), index(index_)
+{}
+
+
+inline JetCollection::JetProxy JetCollection::ConstIterator::operator*() const noexcept
+{
+    return JetProxy(*collection, index);
+}
+
+
+inline JetCollection::ConstIterator &JetCollection::ConstIterator::operator++() noexcept
+{
+    ++index;
+    return *this;
+}
+
+
+inline bool JetCollection::ConstIterator::operator==(ConstIterator const &rhs) const noexcept
+{
+    return (index == rhs.index and collection == rhs.collection);
+}
+
+
+inline bool JetCollection::ConstIterator::operator!=(ConstIterator const &rhs) const noexcept
+{
+    return not (*this == rhs);
+}
+
+
+inline JetCollection::ConstIterator JetCollection::begin() const noexcept
+{
+    return ConstIterator(*this, 0);
+}
+
+
+inline bool JetCollection::empty() const noexcept
+{
+    return pt.empty();
+}
+
+
+inline JetCollection::ConstIterator JetCollection::end() const noexcept
+{
+    return ConstIterator(*this, pt.size());
+}
+
+
+inline std::size_t JetCollection::size() const noexcept
+{
+    return pt.size();
+}
+
+
+inline JetCollection::JetProxy JetCollection::operator[](std::size_t index) const noexcept
+{
+    return JetProxy(*this, index);
+}
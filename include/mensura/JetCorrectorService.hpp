@@ -4,6 +4,7 @@
 
 #include <mensura/EventID.hpp>
 #include <mensura/FileInPath.hpp>
+#include <mensura/JetCollection.hpp>
 #include <mensura/SystService.hpp>
 
 #include <TRandom3.h>
@@ -16,8 +17,6 @@
 #include <vector>
 
 
-class Jet;
-
 class FactorizedJetCorrector;
 class JetCorrectionUncertainty;
 
@@ -52,6 +51,11 @@ class JetResolutionScaleFactor;
  * deterministic JER smearing is applied for jets that have matched generator-level jets. If pt
  * resolution in simulation is specified in addition, jets that do not have generator-level matches
  * are smeared stochastically using this resolution and the scale factors.
+ * 
+ * Text files with JEC, JEC uncertainties, and JER scale factors are parsed only once for each IOV,
+ * and the resulting read-only parameters are shared among all copies of the service. Evaluators
+ * that keep per-jet state are constructed from them by each copy. Pt resolutions in simulation are
+ * read by each copy separately because the underlying evaluator is not thread-safe.
  */
 class JetCorrectorService: public Service
 {
@@ -103,6 +107,16 @@ private:
         std::string jerSFFile, jerMCFile;
     };
     
+    /// Parsed JERC parameters for a single IOV. The structure is defined in the source file
+    struct IOVData;
+    
+    /**
+     * \brief Parsed JERC parameters for all IOVs, shared among copies of the service
+     * 
+     * The structure is defined in the source file.
+     */
+    struct SharedData;
+    
 public:
     /// Creates a service with the given name
     JetCorrectorService(std::string const name = "JetCorrector");
@@ -130,6 +144,10 @@ public:
     double Eval(Jet const &jet, double rho, SystType syst = SystType::None,
       SystService::VarDirection direction = SystService::VarDirection::Undefined) const;
     
+    /// Overloaded version of the above for jets stored in a JetCollection
+    double Eval(JetCollection::JetProxy const &jet, double rho, SystType syst = SystType::None,
+      SystService::VarDirection direction = SystService::VarDirection::Undefined) const;
+    
     /**
      * \brief Computes JEC uncertainty with the current IOV
      * 
@@ -230,6 +248,15 @@ public:
     void SetJER(std::string const &jerSFFile, std::string const &jerMCFile);
     
 private:
+    /**
+     * \brief Computes full correction factor for a jet with given properties
+     * 
+     * Implements both versions of Eval. The first two arguments are the raw and fully corrected
+     * transverse momenta of the jet.
+     */
+    double EvalImpl(double rawPt, double corrPt, double eta, double area, GenJet const *genJet,
+      double rho, SystType syst, SystService::VarDirection direction) const;
+    
     /**
      * \brief Finds IOV for the given label
      * 
@@ -238,14 +265,22 @@ private:
      */
     IOVParams &GetIOVByLabel(std::string const &label);
     
+    /**
+     * \brief Returns parsed JERC parameters for the current IOV
+     * 
+     * The parameters are read from text files if this has not been done yet by this or any other
+     * copy of the service.
+     */
+    std::shared_ptr<IOVData const> GetIOVData() const;
+    
     /// (Re)creates an object to evaluate JEC for the current IOV
-    void UpdateJECEvaluator();
+    void UpdateJECEvaluator(IOVData const &iovData);
     
     /// (Re)creates an object to evaluate JEC uncertainty for the current IOV
-    void UpdateJECUncEvaluator();
+    void UpdateJECUncEvaluator(IOVData const &iovData);
     
     /// (Re)creates objects to evaluate effect of JER smearing for the current IOV
-    void UpdateJEREvaluator();
+    void UpdateJEREvaluator(IOVData const &iovData);
     
 private:
     /// Parameter sets for all IOVs
@@ -261,6 +296,13 @@ private:
     /// Flag indicating that a single match-all IOV is used
     bool matchAllMode;
     
+    /**
+     * \brief Cache with parsed JERC parameters
+     * 
+     * Shared among all copies of this. It is recreated whenever the configuration changes.
+     */
+    std::shared_ptr<SharedData> sharedData;
+    
     /// Index of the current IOV
     mutable unsigned curIOV;
     
@@ -295,9 +337,10 @@ private:
     /**
      * \brief An object that provides data/MC scale factors for JER with the current IOV
      * 
-     * Can be uninitialized if the scale factors have not been specified.
+     * The object is shared among copies of the service. Can be uninitialized if the scale factors
+     * have not been specified.
      */
-    std::unique_ptr<JME::JetResolutionScaleFactor> jerSFProvider;
+    std::shared_ptr<JME::JetResolutionScaleFactor const> jerSFProvider;
     
     /**
      * \brief Random-number generator
@@ -2,7 +2,7 @@
 
 #include <mensura/AnalysisPlugin.hpp>
 
-#include <mensura/PhysicsObjects.hpp>
+#include <mensura/JetCollection.hpp>
 
 #include <functional>
 
@@ -15,12 +15,20 @@ class JetMETReader;
  * \brief Filters events based on the number of jets that pass a generic selection
  * 
  * This plugin selects an event if it contains a desired number of jets that pass a selection. The
- * selection is specified with the help of std::function and, therefore, can be very general.
+ * selection is specified with the help of std::function and, therefore, can be very general. It is
+ * evaluated on proxies of jets in the JetCollection (JetCollection::JetProxy), which provide the
+ * same accessors as class Jet. A selector that takes a Jet is accepted as well, but then each jet
+ * is converted into a standalone Jet before the selection is evaluated, which is comparatively
+ * expensive.
  * 
  * The filter relies on the presence of a JetMETReader with a default name "JetMET".
  */
 class JetFunctorFilter: public AnalysisPlugin
 {
+public:
+    /// Type of the jet selector
+    using Selector = std::function<bool(JetCollection::JetProxy const &)>;
+    
 public:
     /**
      * \brief Constructor
@@ -29,7 +37,7 @@ public:
      * jets to pass the selection. If the last argument is omitted, there is no upper limit on the
      * number of jets.
      */
-    JetFunctorFilter(std::string const &name, std::function<bool(Jet const &)> const &selector,
+    JetFunctorFilter(std::string const &name, Selector const &selector,
       unsigned minNumJets, unsigned maxNumJets = -1) noexcept;
     
     /**
@@ -37,7 +45,7 @@ public:
      * 
      * A short-cut for the version above that uses a default name "JetFunctorFilter".
      */
-    JetFunctorFilter(std::function<bool(Jet const &)> const &selector,
+    JetFunctorFilter(Selector const &selector,
       unsigned minNumJets, unsigned maxNumJets = -1) noexcept;
     
 public:
@@ -71,7 +79,7 @@ private:
     JetMETReader const *jetPlugin;
     
     /// Generic jet selector
-    std::function<bool(Jet const &)> const &selector;
+    Selector selector;
     
     /// Minimal number of jets passing the threshold
     unsigned minNumJets, maxNumJets;
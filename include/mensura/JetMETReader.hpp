@@ -2,10 +2,9 @@
 
 #include <mensura/ReaderPlugin.hpp>
 
+#include <mensura/JetCollection.hpp>
 #include <mensura/PhysicsObjects.hpp>
 
-#include <vector>
-
 
 /**
  * \class JetMETReader
@@ -36,8 +35,12 @@ public:
     virtual ~JetMETReader() noexcept;
     
 public:
-    /// Returns collection of corrected jets in the current event
-    std::vector<Jet> const &GetJets() const;
+    /**
+     * \brief Returns collection of corrected jets in the current event
+     * 
+     * Jets are ordered in decreasing transverse momentum.
+     */
+    JetCollection const &GetJets() const;
     
     /// Returns radius parameter used in the jet clustering algorithm
     virtual double GetJetRadius() const = 0;
@@ -50,7 +53,7 @@ public:
     
 protected:
     /// Collection of (corrected) jets in the current event
-    std::vector<Jet> jets;
+    JetCollection jets;
     
     /// Corrected MET in the current event
     MET met;
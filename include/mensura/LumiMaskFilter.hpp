@@ -1,11 +1,12 @@
 #pragma once
 
-#include <mensura/AnalysisPlugin.hpp>
+#include <mensura/BatchPlugin.hpp>
 
 #include <mensura/EventID.hpp>
 
 #include <istream>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,8 +24,11 @@ class EventIDReader;
  * JSON format.
  * 
  * The filter relies on the presence of a EventIDReader with a default name "EventID".
+ * 
+ * Since the decision depends on event ID only, the filter evaluates blocks of events at once (see
+ * BatchPlugin), using event IDs peeked from the EventIDReader.
  */
-class LumiMaskFilter: public AnalysisPlugin
+class LumiMaskFilter: public BatchPlugin
 {
 private:
     /**
@@ -77,13 +81,30 @@ public:
      */
     virtual Plugin *Clone() const override;
     
+    /**
+     * \brief Returns a description of the luminosity mask and the filtering logic
+     * 
+     * Reimplemented from AnalysisPlugin.
+     */
+    virtual std::string GetCacheKey() const override;
+    
     /// Changes name of the plugin that provides event ID
     void SetEventIDPluginName(std::string const &name);
     
 private:
+    /// Checks if the given event is compatible with the luminosity mask
+    bool IsInMask(EventID const &id) const;
+    
     /// Reads JSON file with luminosity mask
     void LoadLumiMask(std::string const &lumiMaskFileName);
     
+    /**
+     * \brief Checks a block of events against the luminosity mask
+     * 
+     * Implemented from BatchPlugin.
+     */
+    virtual void ProcessBlock(unsigned maxEvents, std::vector<char> &mask) override;
+    
     /**
      * \brief Checks the current event against the luminosity mask
      * 
@@ -112,7 +133,11 @@ private:
     /**
      * \brief Luminosity mask for filtering
      * 
-     * The key of the map is the run number. Entries for each run are ordered.
+     * The key of the map is the run number. Entries for each run are ordered. The mask is shared
+     * among all clones of this.
      */
-    std::map<unsigned long, std::vector<lumiRange_t>> lumiMask;
+    std::shared_ptr<std::map<unsigned long, std::vector<lumiRange_t>> const> lumiMask;
+    
+    /// Buffer to store IDs of events in the current block
+    std::vector<EventID> blockEventIDs;
 };
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <TFile.h>
+
+#include <string>
+
+
+/**
+ * \class MappedROOTFile
+ * \brief A read-only local ROOT file accessed through a memory mapping
+ * 
+ * Once the file has been opened and its header has been read in the usual way, the whole file is
+ * mapped into the address space of the process. All subsequent reads, which ROOT performs with
+ * low-level methods TFile::SysSeek and TFile::SysRead, are served by copying from the mapped
+ * pages instead of issuing read system calls. Before a vector read, with which TTreeCache fills
+ * its buffer, the kernel is advised with madvise that the whole range spanned by the read will be
+ * needed, so that the pages are brought in with few large reads. Other functionality, including
+ * the bookkeeping of read statistics and the interplay with read caches, is inherited from TFile
+ * without changes.
+ * 
+ * If the mapping fails, the object silently falls back to ordinary reading. This class is only
+ * suitable for local files. Objects must be created and deleted under ROOTLock, as any TFile.
+ */
+class MappedROOTFile: public TFile
+{
+public:
+    /**
+     * \brief Opens the file with the given path for reading and maps it
+     * 
+     * As with TFile, failures to open the file are reported by marking the object as zombie.
+     */
+    MappedROOTFile(std::string const &path);
+    
+    /// Closes the file and removes the mapping
+    virtual ~MappedROOTFile();
+    
+public:
+    /// Checks if the given path refers to a local file, i.e. does not specify a remote protocol
+    static bool IsLocalPath(std::string const &path);
+    
+    /// Checks if the file is accessed through the mapping
+    bool IsMapped() const;
+    
+    /**
+     * \brief Advises the kernel that the given range of the file will be needed soon
+     * 
+     * TTreeCache only calls this method if asynchronous reading is enabled with the ROOT
+     * configuration option TFile.AsyncReading, which is off by default. Returns false in case of
+     * success, following the convention of TFile; requests beyond the end of the file are
+     * ignored. Reimplemented from TFile.
+     */
+    virtual Bool_t ReadBufferAsync(Long64_t offset, Int_t len) override;
+    
+    /**
+     * \brief Reads the given segments of the file
+     * 
+     * Advises the kernel that the range spanned by all segments will be needed and then reads
+     * them with the implementation from TFile. Returns true in case of failure. Reimplemented
+     * from TFile.
+     */
+    virtual Bool_t ReadBuffers(char *buffer, Long64_t *positions, Int_t *lengths, Int_t nBuffers)
+      override;
+    
+protected:
+    /**
+     * \brief Removes the mapping and closes the file descriptor
+     * 
+     * Reimplemented from TFile.
+     */
+    virtual Int_t SysClose(Int_t fd) override;
+    
+    /**
+     * \brief Copies the given number of bytes from the current position in the mapping
+     * 
+     * Reimplemented from TFile.
+     */
+    virtual Int_t SysRead(Int_t fd, void *buffer, Int_t len) override;
+    
+    /**
+     * \brief Changes the current position in the mapping
+     * 
+     * Reimplemented from TFile.
+     */
+    virtual Long64_t SysSeek(Int_t fd, Long64_t offset, Int_t whence) override;
+    
+private:
+    /**
+     * \brief Advises the kernel that the range [begin, end) of the file will be needed soon
+     * 
+     * The range is clipped to the mapping. Returns true in case of failure.
+     */
+    bool AdviseWillNeed(Long64_t begin, Long64_t end) const;
+    
+    /// Removes the mapping if it exists
+    void Unmap();
+    
+private:
+    /**
+     * \brief Start of the mapping
+     * 
+     * Null pointer if the file is not mapped.
+     */
+    char const *mappedData;
+    
+    /// Size of the mapped file, in bytes
+    Long64_t mappedSize;
+    
+    /// Current position in the mapping
+    Long64_t position;
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <mensura/AnalysisPlugin.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <set>
+#include <string>
+#include <vector>
+
+
+class PECInputData;
+
+
+/**
+ * \class PECEventIndexCache
+ * \brief Caches on disk indices of events accepted by selected filters
+ * 
+ * The plugin is given names of filters whose decisions only depend on their configuration and on
+ * the content of the input file, such as LumiMaskFilter, PECTriggerFilterData, EventIDFilter, and
+ * DatasetSelector (see AnalysisPlugin::GetCacheKey). For each input file, it records indices of
+ * entries accepted by all of them and saves the list on disk when the file has been processed
+ * completely. When PECInputData is configured to use the cache (see
+ * PECInputData::SetEventIndexCache), it looks up the list at the moment a file is opened and then
+ * reads only the accepted entries, skipping the rest of the file.
+ * 
+ * A cache file is keyed by the absolute path to the input file, its size and modification time,
+ * the range of entries to be read in the dataset, and a hash of descriptions of the filters. If
+ * any of them changes, the cache is not used and is rebuilt. Cache files are placed next to the
+ * input files unless a different directory is given. They are named after the input file with a
+ * hash of the key and extension ".evtidx.root" added. Input files whose size and modification
+ * time cannot be determined, e.g. remote ones, are not cached.
+ * 
+ * The filters must be placed in the path before this plugin. The plugin should be registered with
+ * an explicit dependency on the PECInputData only so that it is executed for every event. It never
+ * rejects events.
+ */
+class PECEventIndexCache: public AnalysisPlugin
+{
+public:
+    /**
+     * \brief Creates plugin with the given name
+     * 
+     * The second argument lists names of filters whose decisions are to be cached.
+     */
+    PECEventIndexCache(std::string const &name,
+      std::initializer_list<std::string> const &filterNames);
+    
+    /// A short-cut for the above version with a default name "EventIndexCache"
+    PECEventIndexCache(std::initializer_list<std::string> const &filterNames);
+    
+    /// Default move constructor
+    PECEventIndexCache(PECEventIndexCache &&) = default;
+    
+    /// Assignment operator is deleted
+    PECEventIndexCache &operator=(PECEventIndexCache const &) = delete;
+    
+    /// Trivial destructor
+    virtual ~PECEventIndexCache() noexcept;
+    
+private:
+    /**
+     * \brief Copy constructor that produces a newly initialized clone
+     * 
+     * Only the configuration is copied. Made private to prevent using it outside of method Clone.
+     */
+    PECEventIndexCache(PECEventIndexCache const &src);
+    
+public:
+    /**
+     * \brief Computes the hash of the configuration of the filters for the new dataset
+     * 
+     * Throws an exception if one of the filters does not support caching. Reimplemented from
+     * Plugin.
+     */
+    virtual void BeginRun(Dataset const &dataset) override;
+    
+    /**
+     * \brief Creates a newly configured clone
+     * 
+     * Implemented from Plugin.
+     */
+    virtual Plugin *Clone() const override;
+    
+    /**
+     * \brief Saves the cache for the last input file
+     * 
+     * Reimplemented from Plugin.
+     */
+    virtual void EndRun() override;
+    
+    /**
+     * \brief Looks up cached indices of accepted entries for the given input file
+     * 
+     * Returns true and fills the given vector with the indices, in increasing order, if a valid
+     * cache is found. Otherwise returns false. Events from an input file for which the cache has
+     * been used are not recorded again.
+     */
+    bool LookUp(std::filesystem::path const &inputFilePath,
+      std::vector<unsigned long> &entries) const;
+    
+    /**
+     * \brief Sets directory in which cache files are stored
+     * 
+     * The directory is created if needed. An empty string, which is the default, means that the
+     * cache is stored next to each input file.
+     */
+    void SetDirectory(std::string const &directory);
+    
+private:
+    /**
+     * \brief Builds the key for the given input file
+     * 
+     * Returns an empty string if the size or modification time of the file cannot be determined.
+     */
+    std::string BuildKey(std::filesystem::path const &inputFilePath) const;
+    
+    /// Builds path to the cache file for the given input file and key
+    std::filesystem::path GetCachePath(std::filesystem::path const &inputFilePath,
+      std::string const &key) const;
+    
+    /// Computes a 64-bit FNV-1a hash of the given string, which is stable between runs
+    static std::uint64_t Hash(std::string const &text);
+    
+    /**
+     * \brief Records the current event if it has been accepted by all filters
+     * 
+     * Always returns true. Implemented from Plugin.
+     */
+    virtual bool ProcessEvent() override;
+    
+    /// Saves indices of accepted entries for the current input file
+    void WriteCache() const;
+    
+private:
+    /// Name of the plugin that reads PEC files
+    std::string inputDataPluginName;
+    
+    /// Non-owning pointer to the plugin that reads PEC files
+    PECInputData const *inputDataPlugin;
+    
+    /// Names of filters whose decisions are cached
+    std::vector<std::string> filterNames;
+    
+    /**
+     * \brief Directory for cache files
+     * 
+     * If empty, cache files are stored next to the input files.
+     */
+    std::string directory;
+    
+    /// Hash of descriptions of the filters for the current dataset
+    std::uint64_t configHash;
+    
+    /**
+     * \brief Range of entries to be read in each input file
+     * 
+     * Copied from the current dataset.
+     */
+    unsigned long firstEntry, lastEntry;
+    
+    /// Input file to which the last processed event belongs
+    std::filesystem::path curFilePath;
+    
+    /// Indicates whether accepted events in the current input file are being recorded
+    bool recording;
+    
+    /// Indices of entries in the current input file accepted by all filters
+    std::vector<unsigned long> acceptedEntries;
+    
+    /**
+     * \brief Input files in the current dataset for which the cache has been used
+     * 
+     * Filled in the constant method LookUp, which is why it is mutable.
+     */
+    mutable std::set<std::filesystem::path> cachedFiles;
+};
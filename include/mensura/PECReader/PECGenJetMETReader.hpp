@@ -71,12 +71,20 @@ public:
     
 private:
     /**
-     * \brief Reads jets and MET from the input tree
+     * \brief Marks the current event as pending
      * 
+     * The input tree is read only when jets and MET are requested for the first time.
      * Reimplemented from Plugin.
      */
     virtual bool ProcessEvent() override;
     
+    /**
+     * \brief Reads generator-level jets and MET from the input tree
+     * 
+     * Reimplemented from ReaderPlugin.
+     */
+    virtual void UnpackEvent() override;
+    
 private:
     /// Name of the plugin that reads PEC files
     std::string inputDataPluginName;
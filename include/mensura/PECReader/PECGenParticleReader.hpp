@@ -59,12 +59,20 @@ public:
     
 private:
     /**
-     * \brief Reads electrons and muons from input trees and applied physics selection
+     * \brief Marks the current event as pending
      * 
+     * The input tree is read only when particles are requested for the first time.
      * Reimplemented from Plugin.
      */
     virtual bool ProcessEvent() override;
     
+    /**
+     * \brief Reads generator-level particles from the input tree
+     * 
+     * Reimplemented from ReaderPlugin.
+     */
+    virtual void UnpackEvent() override;
+    
 private:
     /// Name of the plugin that reads PEC files
     std::string inputDataPluginName;
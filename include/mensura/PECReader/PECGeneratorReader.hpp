@@ -110,12 +110,20 @@ public:
     
 private:
     /**
-     * \brief Reads generator information from a PEC file
+     * \brief Marks the current event as pending
      * 
+     * The input tree is read only when generator information is requested for the first time.
      * Reimplemented from Plugin.
      */
     virtual bool ProcessEvent() override;
     
+    /**
+     * \brief Reads generator information from a PEC file
+     * 
+     * Reimplemented from ReaderPlugin.
+     */
+    virtual void UnpackEvent() override;
+    
 private:
     /// Name of the plugin that reads PEC files
     std::string inputDataPluginName;
@@ -5,19 +5,28 @@
 #include <mensura/EventID.hpp>
 #include <mensura/Dataset.hpp>
 
+#include <TEntryList.h>
 #include <TFile.h>
 #include <TTree.h>
 
+#include <ROOT/TThreadExecutor.hxx>
+
 #include <filesystem>
+#include <future>
+#include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 
 namespace pec {
 class EventID;
 };
 
+class PECEventIndexCache;
+
 
 /**
  * \class PECInputData
@@ -27,11 +36,46 @@ class EventID;
  * it also to judge when there are no more events in an input file. Other plugins can request it
  * to extract additional trees from the file. The trees are owned by this plugin.
  * 
- * Currently the framework does not provide an elegant way to notify other plugins when a new file
- * is opened. This is a problem because dependant plugins much update their pointers to trees and
- * set up branch addresses whenever a new input file is opened. However, the framework typically
- * operates with atomic datasets, so this should not be a large problem. For the time being,
- * reading of multiple files in a dataset is disabled; only the first file will be read.
+ * All files in a dataset are read one after another. When switching to a new file, trees with the
+ * same names as the loaded ones are read from it, and statuses and addresses of their branches
+ * are copied from the trees in the previous file. Thus dependant plugins only need to set up the
+ * trees once, in their BeginRun. Optionally, the next file is opened in a background thread while
+ * the current one is being processed, and baskets of the first cluster of entries to be read are
+ * fetched from it (see SetPrefetchNextFile). The same is then done for the first file of the next
+ * dataset if it is known to the processor (see Processor::GetNextDataset), so that switching to
+ * a new dataset only requires taking over the trees read in advance. Note that RunManager gives
+ * each file to the processor as a separate dataset unless configured otherwise (see
+ * RunManager::SetMaxFilesPerDataset).
+ * 
+ * If the dataset is restricted to a range of entries (see Dataset::SetEntryRange), only events
+ * from this range are read in each file.
+ * 
+ * Event IDs are not read entry by entry. Instead, they are loaded for a whole cluster of entries of
+ * the tree at once and stored as flat arrays, one for each component of the ID (see
+ * GetEventIDBlock). IDs of the current and subsequent events are served from these arrays.
+ * 
+ * Plugins that read a tree can declare which of its branches they need (see RequestBranches).
+ * Once this has been done for a tree, all its other branches are disabled, so that only the data
+ * actually used are read and decompressed. Branch usage can be printed at the end of each dataset
+ * (see SetPrintBranchUsage).
+ * 
+ * Reading can be restricted to entries listed in a TEntryList, such as one produced by
+ * PECSkimWriter in a previous pass over the same files (see SetEntryList). Other entries are then
+ * skipped without being read from any tree. Alternatively, entries can be selected with cached
+ * decisions of filters stored by PECEventIndexCache (see SetEventIndexCache).
+ * 
+ * Each loaded tree is given a read cache (ROOT's TTreeCache), which is filled with baskets of
+ * enabled branches in few large read calls. Its parameters can be adjusted with SetReadCache,
+ * and statistics of reading can be printed at the end of each dataset.
+ * 
+ * Local input files can be accessed through a memory mapping instead of read system calls (see
+ * SetMemoryMapping).
+ * 
+ * Optionally, decompression of baskets can be overlapped with the processing of events (see
+ * SetReadAhead). In this mode, the read cache of each loaded tree decompresses baskets for
+ * upcoming events in the thread pool of ROOT's implicit multithreading. Events are still
+ * unpacked from the baskets one at a time, when they are read. Independent trees can also be
+ * read in parallel for each event (see SetParallelUnpacking).
  */
 class PECInputData: public EventIDReader
 {
@@ -44,6 +88,37 @@ public:
         NotFound  ///< Requested tree is not found in the input file
     };
     
+    /**
+     * \brief IDs of a range of events in the current input file
+     * 
+     * The IDs are stored as columns: the i-th event in the block is described by the i-th
+     * elements of all arrays.
+     */
+    struct EventIDBlock
+    {
+        /// Returns the number of events in the block
+        unsigned long Size() const;
+        
+        /**
+         * \brief Indices of entries in the input file
+         * 
+         * The entries are contiguous unless an entry list is used.
+         */
+        std::vector<unsigned long> entries;
+        
+        /// Run numbers
+        std::vector<EventID::RunNumber_t> runs;
+        
+        /// Luminosity block numbers
+        std::vector<EventID::LumiBlockNumber_t> lumiBlocks;
+        
+        /// Event numbers
+        std::vector<EventID::EventNumber_t> events;
+        
+        /// Bunch crossing numbers
+        std::vector<EventID::BXNumber_t> bunchCrossings;
+    };
+    
 public:
     /**
      * \brief Creates plugin with the given name
@@ -61,9 +136,39 @@ public:
     /// Assignment operator is deleted
     PECInputData &operator=(PECInputData const &) = delete;
     
-    /// Trivial destructor
+    /// Destructor
     virtual ~PECInputData();
     
+private:
+    /// Statistics of reading a tree through its read cache, accumulated over input files
+    struct CacheStat
+    {
+        CacheStat();
+        
+        /// Total number of bytes read from the input files
+        unsigned long bytesRead;
+        
+        /// Total number of read calls
+        unsigned long numReadCalls;
+        
+        /**
+         * \brief Sum of fractions of basket requests served by the cache, weighted with bytes read
+         * 
+         * Corresponds to TTreeCache::GetEfficiencyRel.
+         */
+        double weightedHitRate;
+    };
+    
+    /// An input file together with trees read from it
+    struct InputFile
+    {
+        /// The file
+        std::unique_ptr<TFile> file;
+        
+        /// Trees read from the file, indexed by their names
+        std::map<std::string, std::unique_ptr<TTree>> trees;
+    };
+    
 public:
     /**
      * \brief Performs initialization for a new dataset and opens first input file
@@ -82,7 +187,7 @@ public:
     /**
      * \brief Clears collections of input files and loaded trees
      * 
-     * Reimplemented from Plugin.
+     * Prints statistics of read caches if requested. Reimplemented from Plugin.
      */
     virtual void EndRun() override;
     
@@ -93,9 +198,43 @@ public:
      * thrown. The user should not perform destructive operations using the returned pointer. Note
      * that it is not possible to call TTree::GetEntry with this pointer since the index of the
      * current event is not exposed. To read the current event use the ReadEventFromTree method.
+     * 
+     * The returned pointer is only valid until the next input file is opened. Statuses and
+     * addresses of branches set with it are carried over to the following files automatically.
      */
     TTree *ExposeTree(std::string const &name) const;
     
+    /// Returns name of the tree with event IDs
+    std::string const &GetEventIDTreeName() const;
+    
+    /// Returns index of the current event in the trees of the current input file
+    unsigned long GetCurrentEntry() const;
+    
+    /**
+     * \brief Returns path to the current input file
+     * 
+     * The path is given as it is specified in the dataset. Must not be called before the first
+     * input file is opened.
+     */
+    std::filesystem::path const &GetCurrentFilePath() const;
+    
+    /**
+     * \brief Returns IDs of events in the block that contains the current event
+     * 
+     * The block normally covers a cluster of entries in the tree with event IDs, restricted to the
+     * range of entries to be read and to selected entries if an entry list or an event index
+     * cache is used. A filter can use the arrays to evaluate its decisions for all events in the
+     * block at once. The position of the current event in the block is given by
+     * GetPosInEventIDBlock. The block is replaced when the current event moves beyond it.
+     */
+    EventIDBlock const &GetEventIDBlock() const;
+    
+    /// Returns index of the current event in the block given by GetEventIDBlock
+    unsigned long GetPosInEventIDBlock() const;
+    
+    /// Returns names of all loaded trees, including the tree with event IDs
+    std::vector<std::string> ListLoadedTrees() const;
+    
     /**
      * \brief Reads the tree with the given name from the current file
      * 
@@ -107,14 +246,231 @@ public:
      */
     LoadTreeStatus LoadTree(std::string const &name) const;
     
+    /**
+     * \brief Provides IDs of the current event and events that will be read after it
+     * 
+     * Events are taken from the current block of event IDs (see GetEventIDBlock) as long as it
+     * extends. If more events are requested, IDs of the following entries to be read are read
+     * from the tree directly, up to the end of the current input file, without loading them into
+     * the block. Reimplemented from EventIDReader.
+     */
+    virtual void PeekEventIDs(unsigned maxEvents, std::vector<EventID> &eventIDs) const override;
+    
     /**
      * \brief Reads current event in the tree with the given name
      * 
-     * Throws an exception if the tree has not been loaded.
+     * Throws an exception if the tree has not been loaded. If parallel unpacking is enabled, the
+     * current event has normally been read from all trees other than the one with event IDs
+     * already, and for them the method does nothing unless the force flag is set. The flag must be
+     * used after branches of the tree have been enabled or given new addresses while processing
+     * the current event.
+     */
+    void ReadEventFromTree(std::string const &name, bool force = false) const;
+    
+    /**
+     * \brief Keeps all branches of all trees enabled in the current dataset
+     * 
+     * Has the same effect as a request for "*" (see RequestBranches) for every tree that has been
+     * loaded already or will be loaded later in the current dataset. Trees loaded by plugins
+     * after the caller in the path are thus read in full from the first event. Used by
+     * PECSkimWriter to copy input trees completely. Forgotten at the end of each dataset.
+     */
+    void RequestAllBranches() const;
+    
+    /**
+     * \brief Declares branches of a loaded tree that the caller needs
+     * 
+     * Names of the branches may contain wildcards, as in TTree::SetBranchStatus. Requests from all
+     * plugins are combined. Before the next event is read, all branches of the tree are disabled,
+     * and then only the requested ones are enabled, together with the branches that contain them
+     * (which is needed for split objects). Thus, if any plugin declares its needs for a tree, all
+     * other plugins that read it must do the same. Trees for which nothing has been requested
+     * are not affected. Requests are forgotten at the end of each dataset and therefore are
+     * normally made in BeginRun, after the tree has been loaded. A request for "*" keeps all
+     * branches of the tree enabled (see also RequestAllBranches).
      */
-    void ReadEventFromTree(std::string const &name) const;
+    void RequestBranches(std::string const &treeName,
+      std::vector<std::string> const &branchNames) const;
+    
+    /**
+     * \brief Restricts reading to entries included in an entry list
+     * 
+     * The TEntryList with the given name is read from the given ROOT file. The path may contain
+     * symbol "%", which is replaced by the base name of the first file in each dataset, in the
+     * same way as in TFileService. The list must contain a sublist for each input file, for the
+     * tree with event IDs, identified by the absolute path to the input file. Input files
+     * without a sublist are skipped entirely. An empty path disables the restriction, which is
+     * the default.
+     */
+    void SetEntryList(std::string const &path, std::string const &listName = "SkimEntries");
+    
+    /**
+     * \brief Restricts reading to entries accepted according to an event index cache
+     * 
+     * The cache is provided by a PECEventIndexCache with the given name, which must be added to
+     * the same processor. When an input file is opened, the cache is looked up for it. If a
+     * valid cache is found, only entries listed in it are read from the file. Otherwise all
+     * entries are read, and the cache plugin records the decisions of the filters. An empty name
+     * disables the lookup, which is the default. Cannot be combined with an entry list.
+     */
+    void SetEventIndexCache(std::string const &pluginName = "EventIndexCache");
+    
+    /**
+     * \brief Enables or disables reading of local input files through a memory mapping
+     * 
+     * When enabled, local files are opened as MappedROOTFile, and the data are copied from the
+     * mapped pages of the page cache rather than read with system calls. Remote files are always
+     * opened with TFile::Open. Disabled by default.
+     */
+    void SetMemoryMapping(bool enable = true);
+    
+    /**
+     * \brief Enables or disables parallel decompression of baskets ahead of the current event
+     * 
+     * When enabled, the read cache of each loaded tree is a TTreeCacheUnzip, which decompresses
+     * baskets for upcoming events in the thread pool of ROOT's implicit multithreading. The pool
+     * is needed for the decompression to run in parallel with the processing, and thus implicit
+     * multithreading is enabled for the process if it has not been done already. The amount of
+     * data decompressed ahead is bounded by the size of the unzip buffer, which is given relative
+     * to the size of the read cache; a non-positive value means the default of ROOT. Note that
+     * ROOT switches on parallel unzipping for the whole process. Has no effect if read caches are
+     * disabled (see SetReadCache). Disabled by default.
+     */
+    void SetReadAhead(bool enable = true, float unzipBufferRelSize = -1.f);
+    
+    /**
+     * \brief Configures read caches of loaded trees
+     * 
+     * The size of the cache for each tree is given in bytes. A negative value means the default
+     * size chosen by ROOT, which is based on the clustering of the tree, and zero disables the
+     * caches. During the learning phase, which lasts for the given number of entries, branches
+     * that are actually read are registered in the cache. If the number of learning entries is
+     * zero, the learning phase is skipped, and all branches that are enabled at the moment of
+     * reading are cached. Note that ROOT uses the same number of learning entries for all trees
+     * in the process. If the last flag is set, statistics of reading are printed at the end of
+     * each dataset. By default, the caches have the default size and learn from 100 entries.
+     */
+    void SetReadCache(long size, unsigned learnEntries = 100, bool printStat = false);
+    
+    /**
+     * \brief Requests that usage of branches of loaded trees be printed
+     * 
+     * If enabled, enabled terminal branches (i.e. leaves) of each loaded tree are listed at the
+     * end of each dataset, together with their shares of the total uncompressed size of the tree
+     * in the last input file. Disabled by default.
+     */
+    void SetPrintBranchUsage(bool enable = true);
+    
+    /**
+     * \brief Enables or disables asynchronous opening of the next input file in the dataset
+     * 
+     * When enabled, the next file is opened in a background thread once the first event in the
+     * current file has been read. Baskets of all enabled branches of the loaded trees are fetched
+     * for the first cluster of entries to be read, so that the switch to the new file does not
+     * stall on I/O. When the last file of a dataset is being read, the first file of the next
+     * dataset is opened in the same way, provided that the processor knows the next dataset. ROOT's
+     * thread safety is enabled when the first file is opened in the background. Trees loaded
+     * after the next file has started to be opened are read from it synchronously when the
+     * reading switches to it. Disabled by default.
+     */
+    void SetPrefetchNextFile(bool enable = true);
+    
+    /**
+     * \brief Enables or disables parallel unpacking of loaded trees
+     * 
+     * When enabled, the current event is read from all loaded trees at once, in parallel, as soon
+     * as its ID has been read. This is done with the thread pool of ROOT's implicit
+     * multithreading, which is enabled for the whole process if needed. Decompression of
+     * different trees then overlaps, which reduces the latency of the event. On the other hand,
+     * trees are read even if dependant plugins would not request the event, e.g. because it is
+     * rejected by an earlier filter. Disabled by default.
+     */
+    void SetParallelUnpacking(bool enable = true);
     
 private:
+    /**
+     * \brief Sets statuses of branches according to requests made with RequestBranches
+     * 
+     * The caller must hold ROOTLock.
+     */
+    void ApplyBranchRequests();
+    
+    /**
+     * \brief Copies statuses and addresses of branches from one tree to another
+     * 
+     * Branches are matched by their names. The caller must hold ROOTLock.
+     */
+    static void CopyBranchSetup(TTree *source, TTree *target);
+    
+    /**
+     * \brief Waits for the file being opened in the background and deletes it
+     * 
+     * Errors that might have occurred while opening the file are ignored. Does nothing if no file
+     * is being opened.
+     */
+    void DiscardPrefetchedFile();
+    
+    /**
+     * \brief Lists enabled branches in loaded trees
+     * 
+     * Returns a map from the names of loaded trees to the names of their enabled branches,
+     * including subbranches.
+     */
+    std::map<std::string, std::vector<std::string>> ListEnabledBranches() const;
+    
+    /// Returns all branches of the given tree, including subbranches
+    static std::vector<TBranch *> ListBranches(TTree *tree);
+    
+    /**
+     * \brief Opens an input file and reads the given trees from it
+     * 
+     * The trees to be read are specified with a map whose keys are names of the trees and values
+     * are names of branches to be enabled. If the prefetch flag is set, the enabled branches of
+     * each tree are given a read cache, and baskets of the cluster that contains the given entry
+     * are loaded into it. Can be called from a background thread. An exception is thrown if the
+     * file cannot be opened or some of the trees are not found.
+     */
+    InputFile OpenInputFile(std::filesystem::path const &path,
+      std::map<std::string, std::vector<std::string>> const &enabledBranches,
+      bool prefetch, unsigned long startEntry) const;
+    
+    /**
+     * \brief Adds statistics of read caches of the loaded trees to the accumulated ones
+     * 
+     * Must be called before the trees from the current input file are deleted.
+     */
+    void RecordCacheStat();
+    
+    /**
+     * \brief Sets up a read cache for the given tree
+     * 
+     * Follows the configuration given with SetReadCache and SetReadAhead. The caller must hold
+     * ROOTLock.
+     */
+    void SetUpReadCache(TTree *tree) const;
+    
+    /**
+     * \brief Starts opening the given file in a background thread
+     * 
+     * The same trees as currently loaded are read from the file, with the same branches enabled.
+     * ROOT's thread safety is enabled before the first file is opened in this way.
+     */
+    void StartPrefetch(std::filesystem::path const &path, unsigned long startEntry);
+    
+    /// Clears the current block of event IDs
+    void ClearEventIDBlock();
+    
+    /**
+     * \brief Loads IDs of events in the next block
+     * 
+     * The block starts from the next entry to be read and extends up to the end of the cluster of
+     * entries in the tree with event IDs that contains it or up to the end of the range of
+     * entries to be read, whichever comes first. If an entry list or an event index cache is
+     * used, only entries selected by it are loaded. Returns false if there are no more entries to
+     * read in the current input file.
+     */
+    bool LoadEventIDBlock();
+    
     /**
      * \brief Opens the next input file in the dataset
      * 
@@ -132,6 +488,15 @@ private:
      */
     virtual bool ProcessEvent() override;
     
+    /**
+     * \brief Selects entries to be read from the current input file
+     * 
+     * Uses the entry list or the event index cache, whichever is configured. Deferred until the
+     * first block of event IDs is loaded from the file since the cache plugin is set up for a new
+     * dataset after this plugin.
+     */
+    void SelectEntries();
+    
 private:
     /// Files in the current dataset
     std::list<std::filesystem::path> inputFiles;
@@ -145,12 +510,129 @@ private:
     /// Name of the tree with event IDs
     std::string eventIDTreeName;
     
+    /// Indicates whether local input files should be accessed through a memory mapping
+    bool memoryMapping;
+    
+    /// Indicates whether pipelined reading of trees has been requested
+    bool readAhead;
+    
+    /// Size of the unzip buffer relative to the read cache, used with pipelined reading
+    float unzipBufferRelSize;
+    
+    /// Size of the read cache for each tree, in bytes
+    long cacheSize;
+    
+    /// Number of entries in the learning phase of read caches
+    unsigned cacheLearnEntries;
+    
+    /// Indicates whether statistics of read caches should be printed at the end of each dataset
+    bool printCacheStat;
+    
+    /**
+     * \brief Branches requested for loaded trees, indexed with names of the trees
+     * 
+     * Mutable because it is modified by other plugins via the RequestBranches method.
+     */
+    mutable std::map<std::string, std::set<std::string>> requestedBranches;
+    
+    /// Indicates whether there are requests that have not been applied yet
+    mutable bool branchRequestsPending;
+    
+    /**
+     * \brief Indicates whether all branches of all trees should be read
+     * 
+     * Mutable because it is set by other plugins via the RequestAllBranches method.
+     */
+    mutable bool allBranchesRequested;
+    
+    /// Indicates whether usage of branches should be printed at the end of each dataset
+    bool printBranchUsage;
+    
+    /// Statistics of read caches in the current dataset, indexed with names of the trees
+    std::map<std::string, CacheStat> cacheStat;
+    
+    /// Indicates whether the next input file should be opened asynchronously
+    bool prefetchNextFile;
+    
+    /// Indicates whether trees should be read in parallel for each event
+    bool parallelUnpacking;
+    
+    /**
+     * \brief Executor to read trees in parallel
+     * 
+     * Created in BeginRun if parallel unpacking is enabled.
+     */
+    std::unique_ptr<ROOT::TThreadExecutor> executor;
+    
+    /// Trees to be read in parallel, i.e. all loaded trees except for the tree with event IDs
+    std::vector<TTree *> parallelTrees;
+    
+    /**
+     * \brief Index of the entry that has been read from all trees in parallel
+     * 
+     * Set to the maximal possible value if this has not been done for the current event.
+     */
+    unsigned long parallelReadEntry;
+    
+    /**
+     * \brief Pattern of the path to the file with the entry list
+     * 
+     * Empty if no entry list is used.
+     */
+    std::string entryListPath;
+    
+    /// Name of the entry list in its file
+    std::string entryListName;
+    
+    /// Entry list for the current dataset
+    std::unique_ptr<TEntryList> entryList;
+    
+    /**
+     * \brief Name of the plugin that provides the event index cache
+     * 
+     * Empty if no cache is used.
+     */
+    std::string eventIndexCacheName;
+    
+    /// Non-owning pointer to the plugin that provides the event index cache
+    PECEventIndexCache const *eventIndexCache;
+    
+    /// Indicates whether SelectEntries has been called for the current input file
+    bool entriesSelected;
+    
+    /**
+     * \brief Indicates whether only entries from selectedEntries are read in the current file
+     * 
+     * Set when there is an entry list or a valid event index cache has been found.
+     */
+    bool useSelectedEntries;
+    
+    /**
+     * \brief Entries to be read from the current input file
+     * 
+     * Restricted to the range of entries to be read.
+     */
+    std::vector<unsigned long> selectedEntries;
+    
+    /// Index of the next element in selectedEntries to be read
+    unsigned long nextSelected;
+    
     /// Total number of events in the current tree
     unsigned long nEvents;
     
-    /// Index of the next event to read from the tree
+    /// Index of the next event to be loaded from the tree
     unsigned long nextEvent;
     
+    /// Index of the event that follows the last event to be read from the current tree
+    unsigned long endEvent;
+    
+    /**
+     * \brief Range of entries to read in each input file
+     * 
+     * Copied from the current dataset. Both boundaries are included.
+     */
+    unsigned long firstEntry, lastEntry;
+    
     /**
      * \brief Map of loaded trees
      * 
@@ -171,4 +653,42 @@ private:
      * The buffer is allocated by TBranch.
      */
     pec::EventID *bfEventIDP;
+    
+    /// IDs of events in the current block
+    EventIDBlock eventIDBlock;
+    
+    /// Position of the current event in the block
+    unsigned long posInBlock;
+    
+    /// Index of the current event in the trees
+    unsigned long curEntry;
+    
+    /**
+     * \brief Trees read in advance from the first input file of the dataset
+     * 
+     * Filled when the file has been opened while the previous dataset was being processed. The
+     * trees are taken over by LoadTree. Those not requested by the time the next file is opened
+     * are deleted. Mutable for the same reason as loadedTrees.
+     */
+    mutable std::map<std::string, std::unique_ptr<TTree>> prefetchedTrees;
+    
+    /// Path to the file being opened in a background thread
+    std::filesystem::path prefetchedFilePath;
+    
+    /**
+     * \brief Indicates whether the file being opened in a background thread belongs to the next
+     * dataset
+     * 
+     * Such a file is kept when the current dataset is closed.
+     */
+    bool prefetchingNextDataset;
+    
+    /**
+     * \brief Next input file being opened in a background thread
+     * 
+     * Valid only while the prefetching is in progress or its result has not been used yet. This
+     * must be the last data member so that it is destroyed (which waits for the background
+     * thread) before other members are.
+     */
+    std::future<InputFile> nextInputFile;
 };
@@ -8,6 +8,7 @@
 #include <mensura/SystService.hpp>
 
 #include <memory>
+#include <vector>
 
 
 class PileUpReader;
@@ -153,12 +154,20 @@ public:
     
 private:
     /**
-     * \brief Reads jets and MET from the input tree
+     * \brief Marks the current event as pending
      * 
+     * The input tree is read only when jets and MET are requested for the first time.
      * Reimplemented from Plugin.
      */
     virtual bool ProcessEvent() override;
     
+    /**
+     * \brief Reads jets and MET from the input tree
+     * 
+     * Reimplemented from ReaderPlugin.
+     */
+    virtual void UnpackEvent() override;
+    
 private:
     /// Name of a plugin that reads PEC files
     std::string inputDataPluginName;
@@ -234,6 +243,20 @@ private:
     /// Non-owning pointer to a plugin that produces generator-level jets
     GenJetMETReader const *genJetPlugin;
     
+    /**
+     * \brief Pseudorapidities and azimuthal angles of leptons used for cleaning
+     * 
+     * Filled for each event to allow vectorised computation of angular distances.
+     */
+    std::vector<double> leptonEtas, leptonPhis;
+    
+    /**
+     * \brief Pseudorapidities, azimuthal angles, and transverse momenta of generator-level jets
+     * 
+     * Filled for each event to allow vectorised computation of angular distances.
+     */
+    std::vector<double> genJetEtas, genJetPhis, genJetPts;
+    
     /// Name of the plugin that provides information about pileup
     std::string puPluginName;
     
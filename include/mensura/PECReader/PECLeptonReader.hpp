@@ -61,12 +61,20 @@ public:
     
 private:
     /**
-     * \brief Reads electrons and muons from input trees and applied physics selection
+     * \brief Marks the current event as pending
      * 
+     * The input trees are read only when leptons are requested for the first time.
      * Reimplemented from Plugin.
      */
     virtual bool ProcessEvent() override;
     
+    /**
+     * \brief Reads leptons from the input trees
+     * 
+     * Reimplemented from ReaderPlugin.
+     */
+    virtual void UnpackEvent() override;
+    
 private:
     /// Name of the plugin that reads PEC files
     std::string inputDataPluginName;
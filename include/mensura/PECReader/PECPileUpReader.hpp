@@ -55,12 +55,20 @@ public:
     
 private:
     /**
-     * \brief Reads pile-up information for a PEC file
+     * \brief Marks the current event as pending
      * 
+     * The input tree is read only when pile-up information is requested for the first time.
      * Reimplemented from Plugin.
      */
     virtual bool ProcessEvent() override;
     
+    /**
+     * \brief Reads pile-up information from the input tree
+     * 
+     * Reimplemented from ReaderPlugin.
+     */
+    virtual void UnpackEvent() override;
+    
 private:
     /// Name of the plugin that reads PEC files
     std::string inputDataPluginName;
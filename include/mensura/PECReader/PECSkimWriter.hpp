@@ -0,0 +1,158 @@
+#pragma once
+
+#include <mensura/AnalysisPlugin.hpp>
+
+#include <filesystem>
+#include <map>
+#include <string>
+
+
+class PECInputData;
+class TEntryList;
+class TFileService;
+class TTree;
+
+
+/**
+ * \class PECSkimWriter
+ * \brief Records events that reach it so that later passes over PEC files can process only them
+ * 
+ * The plugin records every event for which it is executed, i.e. every event that has passed all
+ * filters preceding it in the path. Depending on the mode, it either stores indices of these
+ * events in a TEntryList or copies them into a reduced PEC file.
+ * 
+ * The entry list is named "SkimEntries" and is stored in the root directory of the output file.
+ * It contains a sublist for each input file, for the tree with event IDs, and files are
+ * identified by their absolute paths. The list can be given to PECInputData::SetEntryList, which
+ * then reads only the recorded entries from the same input files.
+ * 
+ * In the copy mode, all trees loaded by PECInputData by the time the first event of a dataset
+ * reaches this plugin are copied under their original names. In BeginRun, the plugin requests all
+ * branches of all trees from PECInputData (see PECInputData::RequestAllBranches), which switches
+ * off pruning of branches, also for trees loaded by plugins that follow this one. Thus the copies
+ * include all branches of the input trees, also those that no plugin in the current job reads, at
+ * the price of reading them. Plugins must not disable branches of loaded trees directly. The
+ * resulting file can be read in the usual way.
+ * 
+ * The output is written with a TFileService with a default name "TFileService". It is advisable
+ * to use a dedicated service for this plugin. Input files are accessed via a PECInputData with a
+ * default name "InputData". The plugin never rejects events.
+ */
+class PECSkimWriter: public AnalysisPlugin
+{
+public:
+    /// Supported types of output
+    enum class Mode
+    {
+        EntryList,  ///< Store indices of recorded events in a TEntryList
+        CopyTrees  ///< Copy recorded events into a reduced PEC file
+    };
+    
+private:
+    /// A loaded input tree and its copy in the output file
+    struct TreePair
+    {
+        /// Non-owning pointer to the input tree, which is replaced when a new file is opened
+        TTree *source;
+        
+        /// Non-owning pointer to the output tree, which is owned by the output file
+        TTree *clone;
+    };
+    
+public:
+    /// Creates plugin with the given name and mode
+    PECSkimWriter(std::string const &name, Mode mode = Mode::EntryList);
+    
+    /// A short-cut for the above version with a default name "SkimWriter"
+    PECSkimWriter(Mode mode = Mode::EntryList);
+    
+    /// Default move constructor
+    PECSkimWriter(PECSkimWriter &&) = default;
+    
+    /// Assignment operator is deleted
+    PECSkimWriter &operator=(PECSkimWriter const &) = delete;
+    
+    /// Trivial destructor
+    virtual ~PECSkimWriter() noexcept;
+    
+private:
+    /**
+     * \brief Copy constructor that produces a newly initialized clone
+     * 
+     * Only the configuration is copied. Made private to prevent using it outside of method Clone.
+     */
+    PECSkimWriter(PECSkimWriter const &src);
+    
+public:
+    /**
+     * \brief Sets up the output for the new dataset
+     * 
+     * Reimplemented from Plugin.
+     */
+    virtual void BeginRun(Dataset const &dataset) override;
+    
+    /**
+     * \brief Creates a newly configured clone
+     * 
+     * Implemented from Plugin.
+     */
+    virtual Plugin *Clone() const override;
+    
+    /**
+     * \brief Forgets non-owning pointers to the input and output trees
+     * 
+     * Reimplemented from Plugin.
+     */
+    virtual void EndRun() override;
+    
+    /// Sets name of the TFileService to be used for the output
+    void SetFileServiceName(std::string const &name);
+    
+private:
+    /// Clones loaded input trees into the output file
+    void CloneTrees();
+    
+    /**
+     * \brief Records the current event
+     * 
+     * Always returns true. Implemented from Plugin.
+     */
+    virtual bool ProcessEvent() override;
+    
+private:
+    /// Type of the output
+    Mode mode;
+    
+    /// Name of TFileService
+    std::string fileServiceName;
+    
+    /// Non-owning pointer to TFileService
+    TFileService const *fileService;
+    
+    /// Name of the plugin that reads PEC files
+    std::string inputDataPluginName;
+    
+    /// Non-owning pointer to the plugin that reads PEC files
+    PECInputData const *inputDataPlugin;
+    
+    /**
+     * \brief Non-owning pointer to the output entry list
+     * 
+     * The list is owned by the output file. Only used in the entry list mode.
+     */
+    TEntryList *entryList;
+    
+    /**
+     * \brief Path to the input file of the last recorded event
+     * 
+     * As it is specified in the dataset. Only used in the entry list mode.
+     */
+    std::filesystem::path curFilePath;
+    
+    /**
+     * \brief Input and output trees, indexed by names of the input trees
+     * 
+     * Only used in the copy mode. Empty until the first event of a dataset is recorded.
+     */
+    std::map<std::string, TreePair> trees;
+};
@@ -6,7 +6,6 @@
 
 #include <Rtypes.h>
 
-#include <deque>
 #include <map>
 #include <stdexcept>
 #include <utility>
@@ -62,7 +61,12 @@ protected:
     /// Name of the tree containing trigger information
     std::string triggerTreeName;
     
-    /// Non-owning pointer to the tree with trigger information
+    /**
+     * \brief Non-owning pointer to the tree with trigger information
+     * 
+     * The tree is replaced when a new input file is opened. Because of this, the pointer must be
+     * updated with PECInputData::ExposeTree before use outside of BeginRun.
+     */
     TTree *triggerTree;
 };
 
@@ -118,6 +122,14 @@ public:
      */
     virtual Plugin *Clone() const override;
     
+    /**
+     * \brief Returns a description of the trigger selection
+     * 
+     * Includes the data-taking period and the data triggers of each TriggerRange. Reimplemented
+     * from AnalysisPlugin.
+     */
+    virtual std::string GetCacheKey() const override;
+    
 private:
     /// Stores pointers to provided TriggerRange objects in the internal collection
     template<typename C>
@@ -143,11 +155,16 @@ private:
     TriggerRange const *currentRange;
     
     /**
-     * \brief Buffers into which decision of triggers in the current range are read
+     * \brief Buffers into which decisions of data triggers are read, indexed with trigger patterns
      * 
-     * Use deque instead of a vector to avoid the vector<bool> specialization.
+     * Branches of triggers from previously visited ranges stay enabled until the end of the
+     * dataset, and their buffers are kept so that the addresses given to these branches remain
+     * valid.
      */
-    std::deque<Bool_t> buffers;
+    std::map<std::string, Bool_t> buffers;
+    
+    /// Non-owning pointers to buffers of triggers in the current range
+    std::vector<Bool_t const *> currentBuffers;
 };
 
 
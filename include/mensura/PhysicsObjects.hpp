@@ -7,12 +7,14 @@
 #pragma once
 
 #include <mensura/BTagger.hpp>
+#include <mensura/PtEtaPhiMVector.hpp>
+#include <mensura/UserProperties.hpp>
 
 #include <TLorentzVector.h>
 
 #include <array>
-#include <map>
-#include <unordered_map>
+#include <bitset>
+#include <string>
 
 
 // Forward declarations
@@ -23,8 +25,14 @@ class GenJet;
  * \class Candidate
  * \brief Represents a general object with a four-momentum
  * 
+ * The four-momentum is stored as a PtEtaPhiMVector, so that transverse momentum, pseudorapidity,
+ * azimuthal angle, and mass are accessed without any computation. Methods that accept a
+ * four-momentum also take a TLorentzVector through an implicit conversion.
+ * 
  * An object of this class can also contain an arbitrary number of real- and integer-valued
- * properties defined by user.
+ * properties defined by user. They are identified by labels, which are translated into handles
+ * with the help of UserPropertyRegistry. Versions of the accessors that take handles avoid this
+ * translation and should be preferred in code executed for every event.
  */
 class Candidate
 {
@@ -33,11 +41,11 @@ public:
     Candidate() noexcept;
     
     /// Constructor from a 4-momentum
-    Candidate(TLorentzVector const &p4_) noexcept;
+    Candidate(PtEtaPhiMVector const &p4_) noexcept;
 
 public:
     /// Sets four-momentum
-    void SetP4(TLorentzVector const &p4_) noexcept;
+    void SetP4(PtEtaPhiMVector const &p4_) noexcept;
     
     /// Sets four-momentum
     void SetPtEtaPhiM(double pt, double eta, double phi, double mass) noexcept;
@@ -48,11 +56,25 @@ public:
     /// Sets or changes value of a user-defined real-valued property
     void SetUserFloat(std::string const &label, double value);
     
+    /// Sets or changes value of a user-defined real-valued property
+    void SetUserFloat(UserPropertyHandle handle, double value);
+    
     /// Sets or changes value of a user-defined integer-valued property
     void SetUserInt(std::string const &label, long value);
     
-    /// Four-momentum
-    TLorentzVector const &P4() const noexcept;
+    /// Sets or changes value of a user-defined integer-valued property
+    void SetUserInt(UserPropertyHandle handle, long value);
+    
+    /// Four-momentum in the compact representation
+    PtEtaPhiMVector const &CompactP4() const noexcept;
+    
+    /**
+     * \brief Four-momentum converted to TLorentzVector
+     * 
+     * The conversion evaluates trigonometric functions. Consider using CompactP4 or dedicated
+     * accessors like Pt instead in code executed for every object.
+     */
+    TLorentzVector P4() const noexcept;
     
     /// Transverse momentum, GeV/c
     double Pt() const noexcept;
@@ -76,6 +98,9 @@ public:
      */
     double UserFloat(std::string const &label) const;
     
+    /// Returns value of the user-defined property with the given handle
+    double UserFloat(UserPropertyHandle handle) const;
+    
     /**
      * \brief Returns value of the user-defined property with the given label
      * 
@@ -83,18 +108,21 @@ public:
      */
     long UserInt(std::string const &label) const;
     
+    /// Returns value of the user-defined property with the given handle
+    long UserInt(UserPropertyHandle handle) const;
+    
     /// Ordering operator
     bool operator<(Candidate const &rhs) const noexcept;
 
 private:
     /// Four-momentum
-    TLorentzVector p4;
+    PtEtaPhiMVector p4;
     
-    /// Map implementing user-defined real-valued properties
-    std::unordered_map<std::string, double> userFloats;
+    /// User-defined real-valued properties
+    UserPropertyStore<double> userFloats;
     
-    /// Map implementing user-defined integer-valued properties
-    std::unordered_map<std::string, long> userInts;
+    /// User-defined integer-valued properties
+    UserPropertyStore<long> userInts;
 };
 
 
@@ -119,7 +147,7 @@ public:
     Lepton() noexcept;
     
     /// Constructor with the flavour and the 4-momentum
-    Lepton(Flavour flavour_, TLorentzVector const &p4) noexcept;
+    Lepton(Flavour flavour_, PtEtaPhiMVector const &p4) noexcept;
 
 public:
     /// Sets the relative isolation
@@ -177,7 +205,7 @@ public:
     Jet() noexcept;
     
     /// Constuctor from the fully-corrected four-momentum
-    Jet(TLorentzVector const &correcteP4) noexcept;
+    Jet(PtEtaPhiMVector const &correcteP4) noexcept;
     
     /**
      * \brief Constructor from the raw four-momentum and total correction scale factor
@@ -185,7 +213,7 @@ public:
      * The scale factor includes full JEC and, in case of simulation, JER. A fully-corrected
      * momentum is calculated as rawP4 * corrSF.
      */
-    Jet(TLorentzVector const &rawP4, double corrSF) noexcept;
+    Jet(PtEtaPhiMVector const &rawP4, double corrSF) noexcept;
 
 public:
     /**
@@ -194,7 +222,7 @@ public:
      * The first argument is a fully-corrected four-momentum. The second argument is a scale factor
      * to calculate the raw momentum from it.
      */
-    void SetCorrectedP4(TLorentzVector const &correctedP4, double rawMomentumSF) noexcept;
+    void SetCorrectedP4(PtEtaPhiMVector const &correctedP4, double rawMomentumSF) noexcept;
     
     /// Sets value of a b-tagging discriminator
     void SetBTag(BTagger::Algorithm algo, double value) noexcept;
@@ -270,8 +298,15 @@ private:
     /// A scale factor to build raw four-momentum
     double rawMomentumSF;
     
-    /// Values of b-tagging discriminators
-    std::map<BTagger::Algorithm, double> bTagValues;
+    /**
+     * \brief Values of b-tagging discriminators
+     * 
+     * The array is indexed with BTagger::Algorithm.
+     */
+    std::array<double, BTagger::numAlgorithms> bTagValues;
+    
+    /// Flags that show which b-tagging discriminators have been set
+    std::bitset<BTagger::numAlgorithms> bTagSet;
     
     /**
      * \brief Jet flavours
@@ -312,7 +347,7 @@ public:
     GenJet() noexcept;
     
     /// Constructor from a four-momentum
-    GenJet(TLorentzVector const &p4) noexcept;
+    GenJet(PtEtaPhiMVector const &p4) noexcept;
 
 public:
     /// Sets multipliticy of b and c quarks with status 2 near the jet
@@ -354,7 +389,7 @@ public:
     ShowerParton() noexcept;
     
     /// Constructor from a four-momentum, PDG ID, and a code of origin
-    ShowerParton(TLorentzVector const &p4, int pdgId, Origin origin = Origin::Unknown) noexcept;
+    ShowerParton(PtEtaPhiMVector const &p4, int pdgId, Origin origin = Origin::Unknown) noexcept;
     
     /**
      * \brief Constructor from three-momentum, PDG ID, and a code of origin
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <mensura/Dataset.hpp>
+#include <mensura/EventArena.hpp>
 #include <mensura/Plugin.hpp>
 #include <mensura/Service.hpp>
 
+#include <chrono>
 #include <initializer_list>
 #include <map>
 #include <memory>
@@ -13,6 +15,7 @@
 #include <vector>
 
 
+class BatchPlugin;
 class RunManager;
 
 
@@ -29,13 +32,33 @@ class RunManager;
  * has returned false. If a reader plugin declares that there are no events left, processing of the
  * current dataset is stopped immediately.
  * 
+ * When a plugin is registered, the path is compiled into an execution plan. For each plugin it
+ * contains the position in the path to jump to when the plugin rejects an event, so that the whole
+ * group of subsequent plugins that depend on it, directly or indirectly, is skipped at once. The
+ * cost of processing an event is thus proportional to the number of plugins actually executed.
+ * 
+ * Optionally, the order of plugins can be adapted to measured pass rates and timings (see
+ * SetAdaptiveOrdering) so that filters reject events before expensive producers are executed.
+ * 
+ * Plugins derived from BatchPlugin are evaluated for blocks of events. Their decisions are stored
+ * in a selection mask, which is then consulted for subsequent events instead of executing the
+ * plugins event by event.
+ * 
  * Instances of this class are spanned by RunManager to process a queue of datasets. Each processor
  * is run in a separate thread. The entry point for execution is operator(). This class is a friend
- * of RunManager and profits from this to pop up datasets from the queue RunManager::datasets.
+ * of RunManager and profits from this to request new datasets from it. Optionally, the next
+ * dataset is requested before the current one is processed, so that plugins can prepare it in the
+ * background (see GetNextDataset and SetDatasetLookAhead).
  * 
  * It is also possible to run a Processor independently of a RunManager. In this case method
  * OpenDataset must be called before the event loop, and then each single event can be processed
  * with method ProcessEvent. The dataset as a whole can be processed using method ProcessDataset.
+ * 
+ * The path is naturally split into two stages: reader plugins, which unpack input data, and
+ * other plugins, which analyse it. Throughput of each stage can be measured and reported at the
+ * end of each dataset (see MeasureStageThroughput). Decompression of input data can be overlapped
+ * with the analysis stage by a reader that does it in other threads, such as PECInputData with
+ * read-ahead enabled.
  */
 class Processor
 {
@@ -63,16 +86,74 @@ private:
          */
         std::vector<unsigned> dependencies;
         
-        /// Indicates whether last time this plugin was executed it returned status Ok
-        bool lastResult;
+        /**
+         * \brief Index of the plugin to be executed next if this one rejects the current event
+         * 
+         * All plugins between this one and the target depend on this plugin, directly or
+         * indirectly. Computed in method BuildExecutionPlan.
+         */
+        unsigned skipTarget;
+        
+        /**
+         * \brief Index of the last event accepted by this plugin
+         * 
+         * The index refers to Processor::eventCounter. This allows to evaluate dependencies
+         * without resetting decisions of plugins that have been skipped.
+         */
+        unsigned long passedEvent;
+        
+        /// Indicates whether the plugin is a reader, i.e. belongs to the reading stage
+        bool isReader;
+        
+        /// Non-owning pointer to the plugin if it evaluates blocks of events; null otherwise
+        BatchPlugin *batchPlugin;
+        
+        /**
+         * \brief Decisions of a batch plugin for the current block of events
+         * 
+         * Element with index blockPos corresponds to the current event. If blockPos is equal to
+         * the size of the mask, a new block needs to be evaluated.
+         */
+        std::vector<char> blockMask;
+        
+        /// Position of the current event in the block
+        unsigned blockPos;
         
         /// Numbers of events visited this plugin and accepted by it
         unsigned long numVisited, numPassed;
+        
+        /// Time spent in this plugin while collecting statistics for adaptive ordering
+        std::chrono::steady_clock::duration time;
+        
+        /**
+         * \brief Indices of other plugins in the path that this one has accessed
+         * 
+         * Filled when the plugin requests a plugin with GetPluginBefore (which is called, e.g.,
+         * from Plugin::GetDependencyPlugin). Such plugins are treated as implicit dependencies
+         * when the path is reordered.
+         */
+        mutable std::vector<unsigned> accessedPlugins;
+    };
+    
+    /// Information about a plugin that is skipped more often after the path has been reordered
+    struct ReorderedPlugin
+    {
+        /// Name of the plugin
+        std::string name;
+        
+        /// Fraction of events that visited the plugin before the reordering
+        double visitRate;
+        
+        /// Mean time spent in the plugin per visit, in seconds
+        double meanTime;
+        
+        /// Number of events that visited the plugin before the reordering
+        unsigned long numVisitedAtReorder;
     };
     
 public:
     /// Default constructor
-    Processor() = default;
+    Processor();
     
     /// Move constructor
     Processor(Processor &&src) noexcept;
@@ -150,6 +231,50 @@ public:
      */
     void ProcessDataset(Dataset const &dataset);
     
+    /**
+     * \brief Notifies services that all datasets have been processed
+     * 
+     * Calls Service::EndJob for all services. Called by RunManager.
+     */
+    void EndJob();
+    
+    /**
+     * \brief Requests that throughput of the reading and analysis stages be measured
+     * 
+     * If enabled, time spent in reader plugins and in other plugins is measured for each event,
+     * and the resulting throughputs are reported when a dataset has been processed. Disabled by
+     * default.
+     */
+    void MeasureStageThroughput(bool enable = true);
+    
+    /**
+     * \brief Enables adaptive ordering of the path
+     * 
+     * Pass rates of all plugins and time spent in them are measured for the given number of
+     * first events. After that, each filter that has rejected some events is moved towards the
+     * beginning of the path, as far as dependencies allow. Dependencies include plugins accessed
+     * with GetPluginBefore (and hence Plugin::GetDependencyPlugin) in addition to the declared
+     * ones. Filters with a higher rejection rate per unit of time are moved first.
+     * 
+     * When a filter is moved before a reader (other than an EventIDReader) or an event weight
+     * plugin, the latter is made dependent on the filter provided that all plugins that depend on
+     * it also depend on the filter. It is then not executed for events rejected by the filter. It
+     * is assumed that such plugins only produce information for their dependants. The chosen order
+     * and the time saved are reported with ReportAdaptiveOrdering.
+     * 
+     * A zero value disables the reordering, which is the default.
+     */
+    void SetAdaptiveOrdering(unsigned long numEventsObserve);
+    
+    /**
+     * \brief Reports the order of plugins chosen adaptively
+     * 
+     * Prints the original and the new paths and an estimate of time saved, which is based on the
+     * pass rates and timing measured before the reordering. Does nothing if the path has not been
+     * reordered.
+     */
+    void ReportAdaptiveOrdering() const;
+    
     /**
      * \brief Returns pointer to service with given name
      * 
@@ -214,13 +339,80 @@ public:
     /// Returns number of visited and accepted events
     std::pair<unsigned long, unsigned long> GetStat(std::string const &pluginName) const;
     
-    /// Sets owning RunManager
-    void SetManager(RunManager *manager);
+    /**
+     * \brief Returns memory resource for containers that only live for the current event
+     * 
+     * The arena is reset at the start of each event, which invalidates all memory obtained from
+     * it. Plugins can use it for event-level containers, such as relations between particles, to
+     * avoid allocations from the system in the steady state. Memory is never returned to the arena
+     * before the reset, so it is not suitable for containers that are repeatedly reallocated within
+     * an event.
+     */
+    std::pmr::memory_resource *GetEventArena() const;
+    
+    /**
+     * \brief Returns the dataset that will be processed after the current one
+     * 
+     * Plugins can use this to prepare the next dataset, e.g. to open its input files, while the
+     * current one is being processed. Returns a null pointer if the next dataset is not known,
+     * which is always the case when the processor is not run by a RunManager.
+     */
+    Dataset const *GetNextDataset() const;
+    
+    /**
+     * \brief Checks whether the plugin with the given name has accepted the current event
+     * 
+     * Returns false if the plugin has rejected the event or has not been executed for it. The
+     * result is only meaningful for plugins placed in the path before the caller. Throws an
+     * exception if the plugin is not found.
+     */
+    bool HasPassed(std::string const &pluginName) const;
+    
+    /**
+     * \brief Enables or disables requesting the next dataset in advance
+     * 
+     * When enabled, the processor requests the next dataset from the RunManager before it starts
+     * processing the current one, which makes it available with GetNextDataset. The drawback is
+     * that the requested dataset cannot be taken by other threads when they run out of work. For
+     * this reason, look-ahead is not performed when RunManager distributes datasets with work
+     * stealing (see RunManager::Scheduling). Disabled by default.
+     */
+    void SetDatasetLookAhead(bool enable = true);
+    
+    /**
+     * \brief Sets owning RunManager
+     * 
+     * The second argument is the index of the thread slot occupied by this processor in the
+     * manager.
+     */
+    void SetManager(RunManager *manager, unsigned slot = 0);
     
 private:
+    /**
+     * \brief Computes skip targets for all plugins in the path
+     * 
+     * Must be called whenever the path is modified.
+     */
+    void BuildExecutionPlan();
+    
+    /**
+     * \brief Finds all plugins on which each plugin depends, directly or indirectly
+     * 
+     * Element [i][j] of the returned matrix is true if plugin i depends on plugin j. The latter
+     * always precedes plugin i in the path. If the flag is true, plugins accessed with
+     * GetPluginBefore are considered as dependencies.
+     */
+    std::vector<std::vector<bool>> FindAncestors(bool includeAccessed) const;
+    
+    /// Reorders the path according to collected statistics (see SetAdaptiveOrdering)
+    void ReorderPath();
+    
     /// Retuns index in the path of a plugin with given name. Throws an exception if not found
     unsigned GetPluginIndex(std::string const &name) const;
     
+    /// Reports throughput of the reading and analysis stages and resets the counters
+    void ReportStageThroughput();
+    
 private:
     /**
      * \brief Parent RunManager instance
@@ -229,6 +421,9 @@ private:
      */
     RunManager *manager;
     
+    /// Index of the thread slot in the parent RunManager
+    unsigned slot;
+    
     /**
      * \brief Registered services
      * 
@@ -246,4 +441,50 @@ private:
     
     /// Mapping from plugin names to their indices in vector path
     std::unordered_map<std::string, unsigned> pluginNameMap;
+    
+    /// Indices of plugins in the path that evaluate blocks of events
+    std::vector<unsigned> batchPluginIndices;
+    
+    /// Indicates whether the next dataset should be requested in advance
+    bool datasetLookAhead;
+    
+    /// Dataset to be processed after the current one
+    Dataset nextDataset;
+    
+    /// Indicates whether nextDataset is valid
+    bool hasNextDataset;
+    
+    /// Number of events for which processing has been started
+    unsigned long eventCounter;
+    
+    /**
+     * \brief Memory arena for the current event
+     * 
+     * Stored by pointer so that its address does not change when the processor is moved.
+     */
+    std::unique_ptr<EventArena> eventArena;
+    
+    /// Indicates whether throughput of the reading and analysis stages should be measured
+    bool measureStages;
+    
+    /// Time spent in reader plugins and in other plugins for the current dataset
+    std::chrono::steady_clock::duration readerTime, analysisTime;
+    
+    /// Number of events read in the current dataset
+    unsigned long numEventsRead;
+    
+    /// Number of events to observe before the path is reordered; zero disables the reordering
+    unsigned long adaptiveOrderingWindow;
+    
+    /// Indicates whether the path has been reordered
+    bool pathReordered;
+    
+    /// Value of eventCounter when the path was reordered
+    unsigned long eventCounterAtReorder;
+    
+    /// Names of plugins in the path before the reordering
+    std::vector<std::string> originalPath;
+    
+    /// Plugins that have been made dependent on filters when the path was reordered
+    std::vector<ReorderedPlugin> reorderedPlugins;
 };
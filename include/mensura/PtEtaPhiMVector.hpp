@@ -0,0 +1,141 @@
+#pragma once
+
+#include <TLorentzVector.h>
+
+
+/**
+ * \class PtEtaPhiMVector
+ * \brief A compact four-vector stored in terms of transverse momentum, pseudorapidity, azimuthal
+ * angle, and mass
+ * 
+ * This is the natural representation for objects read from input files, and it allows to access
+ * the components most often used in an analysis without any computation. Cartesian components
+ * are computed on request and are not stored. Unlike TLorentzVector, the class does not derive
+ * from TObject and thus has no virtual table.
+ * 
+ * The components are stored in double precision by default. If the macro
+ * MENSURA_P4_SINGLE_PRECISION is defined (which is done with the CMake option of the same name),
+ * single precision is used instead, halving the size of the object. The macro must be defined
+ * consistently for the library and all code that uses it.
+ * 
+ * Implicit conversions from and to TLorentzVector are provided for compatibility with code that
+ * relies on the latter. They involve evaluation of trigonometric functions and thus should be
+ * avoided in code executed for every object.
+ */
+class PtEtaPhiMVector
+{
+public:
+    /// Type used to store the components
+    #ifdef MENSURA_P4_SINGLE_PRECISION
+    typedef float value_t;
+    #else
+    typedef double value_t;
+    #endif
+    
+public:
+    /// Constructs a null vector
+    PtEtaPhiMVector() noexcept;
+    
+    /// Constructs a vector from the given components (see SetPtEtaPhiM)
+    PtEtaPhiMVector(double pt, double eta, double phi, double mass) noexcept;
+    
+    /// Constructs a vector from a TLorentzVector
+    PtEtaPhiMVector(TLorentzVector const &p4) noexcept;
+    
+public:
+    /// Returns energy
+    double E() const noexcept;
+    
+    /// Returns pseudorapidity
+    double Eta() const noexcept;
+    
+    /**
+     * \brief Returns mass
+     * 
+     * A negative value is returned for a space-like vector, as in TLorentzVector.
+     */
+    double M() const noexcept;
+    
+    /// Returns azimuthal angle, in the range [-pi, pi]
+    double Phi() const noexcept;
+    
+    /// Returns transverse momentum
+    double Pt() const noexcept;
+    
+    /// Returns x component of the momentum
+    double Px() const noexcept;
+    
+    /// Returns y component of the momentum
+    double Py() const noexcept;
+    
+    /// Returns z component of the momentum
+    double Pz() const noexcept;
+    
+    /**
+     * \brief Sets the vector from Cartesian components
+     * 
+     * Pseudorapidity of a vector with zero transverse momentum is set to +-1e11 as in
+     * TLorentzVector. The longitudinal momentum of such a vector is lost.
+     */
+    void SetPxPyPzE(double px, double py, double pz, double E) noexcept;
+    
+    /**
+     * \brief Sets the vector from transverse momentum, pseudorapidity, azimuthal angle, and mass
+     * 
+     * The transverse momentum is taken by its absolute value, and the azimuthal angle is brought
+     * into the range [-pi, pi]. A negative mass describes a space-like vector.
+     */
+    void SetPtEtaPhiM(double pt, double eta, double phi, double mass) noexcept;
+    
+    /// Converts to TLorentzVector
+    operator TLorentzVector() const;
+    
+    /**
+     * \brief Scales the vector by a non-negative factor
+     * 
+     * Only transverse momentum and mass are affected.
+     */
+    PtEtaPhiMVector &operator*=(double factor) noexcept;
+    
+    /// Returns a copy of the vector scaled by a non-negative factor
+    PtEtaPhiMVector operator*(double factor) const noexcept;
+    
+private:
+    /// Transverse momentum
+    value_t pt;
+    
+    /// Pseudorapidity
+    value_t eta;
+    
+    /// Azimuthal angle
+    value_t phi;
+    
+    /// Mass
+    value_t mass;
+};
+
+
+// Accessors to the stored components are defined inline since they are called for every object
+//in every event
+inline double PtEtaPhiMVector::Eta() const noexcept
+{
+    return eta;
+}
+
+
+inline double PtEtaPhiMVector::M() const noexcept
+{
+    return mass;
+}
+
+
+inline double PtEtaPhiMVector::Phi() const noexcept
+{
+    return phi;
+}
+
+
+inline double PtEtaPhiMVector::Pt() const noexcept
+{
+    return pt;
+}
@@ -39,6 +39,32 @@ public:
     /// Trivial destructor
     virtual ~ReaderPlugin();
     
+protected:
+    /**
+     * \brief Unpacks the current event if this has been postponed
+     * 
+     * Must be called by all methods that provide access to the content of the current event.
+     */
+    void LoadPendingEvent() const;
+    
+    /**
+     * \brief Postpones unpacking of the current event
+     * 
+     * Intended to be called from ProcessEvent. The event will be unpacked with method UnpackEvent
+     * when its content is requested for the first time. If the event is rejected before that, it
+     * is never unpacked.
+     */
+    void SetEventPending();
+    
+private:
+    /**
+     * \brief Reads and unpacks the current event
+     * 
+     * Called by LoadPendingEvent when the current event has been marked as pending. The default
+     * implementation is trivial.
+     */
+    virtual void UnpackEvent();
+    
 private:
     /**
      * \brief Reinterprets boolean decision issued by ProcessEvent
@@ -47,4 +73,8 @@ private:
      * the current input dataset.
      */
     virtual EventOutcome ReinterpretDecision(bool decision) const override final;
+    
+private:
+    /// Indicates that the current event has not been unpacked yet
+    mutable bool eventPending;
 };
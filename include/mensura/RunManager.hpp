@@ -5,19 +5,45 @@
 #include <mensura/Processor.hpp>
 #include <mensura/Service.hpp>
 
+#include <chrono>
+#include <deque>
+#include <filesystem>
 #include <initializer_list>
+#include <map>
 #include <queue>
 #include <mutex>
 #include <memory>
+#include <string>
+#include <vector>
 
 
 /**
  * \class RunManager
  * \brief Performs parallel processing of datasets
  * 
- * The class hosts a list of atomic (containing a single file each) datasets and manages a thread
- * pool that processes them. It only forwards parameters, and the actual processing is delegated to
- * instances of dedicated class Processor.
+ * The class hosts a list of atomic datasets and manages a thread pool that processes them. It only
+ * forwards parameters, and the actual processing is delegated to instances of dedicated class
+ * Processor. By default, an atomic dataset contains a single file. Several consecutive files of a
+ * dataset, or all of them, can be kept together instead (see SetMaxFilesPerDataset), which saves
+ * reinitialization of plugins and services for each file.
+ * 
+ * Optionally, large files can be split into ranges of entries, which are then processed
+ * independently, possibly in different threads. This is enabled with method SetMaxEventsPerRange.
+ * Alternatively, the size of the ranges can be chosen automatically from the number of threads
+ * (see SetEventBatching). Then the number of threads is not limited by the number of input files,
+ * and a single file can be processed by the whole thread pool. Each thread owns a clone of the
+ * Processor, and thus the plugins, while services may share read-only resources among their
+ * clones.
+ * 
+ * The number of Processor clones can be limited independently of the number of threads (see
+ * SetMaxClones). Threads that are not given to clones then form ROOT's pool for implicit
+ * multithreading, which the clones use to unpack their input in parallel.
+ * 
+ * Two strategies to distribute atomic datasets among threads are supported (see enumeration
+ * Scheduling). By default, datasets are taken from a shared queue in the order in which they
+ * were provided. Alternatively, each thread is given its own deque of datasets, seeded with the
+ * largest datasets first, and a thread that has run out of work steals from other threads. In both
+ * cases, time that each thread has spent idle is reported at the end of processing.
  * 
  * Some of data members are accessed directly by the friend class Processor.
  */
@@ -37,6 +63,54 @@ private:
         unsigned long numVisited, numPassed;
     };
     
+    /// Deque of atomic datasets assigned to a single thread when work stealing is used
+    struct WorkQueue
+    {
+        /// Constructor
+        WorkQueue();
+        
+        /// Mutex to protect the deque
+        std::mutex mutex;
+        
+        /**
+         * \brief Assigned atomic datasets together with their estimated costs
+         * 
+         * Ordered in the decreasing cost. The owning thread takes datasets from the front while
+         * other threads steal them from the back.
+         */
+        std::deque<std::pair<double, Dataset>> datasets;
+        
+        /// Total estimated cost of datasets in the deque
+        double totalCost;
+    };
+    
+    /// An auxiliary structure to record how a thread has been occupied
+    struct ThreadStat
+    {
+        /// Constructor
+        ThreadStat();
+        
+        /// Time spent waiting for a new atomic dataset
+        std::chrono::duration<double> waitTime;
+        
+        /// Moment when the thread found no datasets left
+        std::chrono::steady_clock::time_point finishTime;
+        
+        /// Number of processed atomic datasets and number of datasets stolen from other threads
+        unsigned long numDatasets, numStolen;
+    };
+    
+public:
+    /// Supported strategies to distribute atomic datasets among threads
+    enum class Scheduling
+    {
+        /// Shared queue processed in the order in which datasets were given
+        Queue,
+        
+        /// Per-thread deques seeded by estimated cost, with work stealing
+        WorkStealing
+    };
+    
 public:
     /// Constructor from a container of instances of Dataset
     template<typename InputIt>
@@ -56,8 +130,12 @@ public:
      */
     void PrintSummary() const;
     
-    /// Processes datasets with a pool of nThreads threads
-    void Process(int nThreads);
+    /**
+     * \brief Processes datasets with a pool of nThreads threads
+     * 
+     * The second argument specifies how atomic datasets are distributed among the threads.
+     */
+    void Process(int nThreads, Scheduling scheduling = Scheduling::Queue);
     
     /**
      * \brief Processes datasets with a pool of threads
@@ -65,7 +143,25 @@ public:
      * Number of threads is determined by multiplying total supported number of concurrent
      * threads by the given fraction.
      */
-    void Process(double loadFraction);
+    void Process(double loadFraction, Scheduling scheduling = Scheduling::Queue);
+    
+    /**
+     * \brief Processes datasets with a pool of nProcesses worker processes
+     * 
+     * Instead of threads, worker processes are forked, and each of them runs a single Processor.
+     * This avoids contention for the global ROOT lock, which serialises creation of ROOT objects
+     * among threads. Atomic datasets are distributed among the workers in advance according to
+     * their estimated costs (as with Scheduling::WorkStealing, but without stealing). All ranges
+     * of entries of the same input file are given to the same worker so that partial outputs can
+     * be merged. When the workers finish, they send statistics of plugins to this process via
+     * pipes, and the statistics are merged so that PrintSummary can be used as usual. An
+     * exception is thrown if some of the workers fail.
+     * 
+     * Services and plugins must not rely on sharing state between different Processors, which
+     * they are not allowed to do in the multithreaded mode either. Supported on POSIX systems
+     * only.
+     */
+    void ProcessForked(int nProcesses);
     
     /**
      * \brief Adds a new service
@@ -91,40 +187,264 @@ public:
      */
     void RegisterPlugin(Plugin *plugin);
     
+    /**
+     * \brief Requests that throughput of the reading and analysis stages be measured
+     * 
+     * Directly calls Processor::MeasureStageThroughput for the underlying template processor.
+     */
+    void MeasureStageThroughput(bool enable = true);
+    
+    /**
+     * \brief Enables adaptive ordering of the path
+     * 
+     * Directly calls Processor::SetAdaptiveOrdering for the underlying template processor. Each
+     * thread reorders its path independently, and the chosen orders are reported when processing
+     * is finished.
+     */
+    void SetAdaptiveOrdering(unsigned long numEventsObserve);
+    
+    /**
+     * \brief Enables or disables requesting the next dataset in advance
+     * 
+     * Directly calls Processor::SetDatasetLookAhead for the underlying template processor. Has no
+     * effect with Scheduling::WorkStealing.
+     */
+    void SetDatasetLookAhead(bool enable = true);
+    
+    /**
+     * \brief Sets the maximal number of input files in an atomic dataset
+     * 
+     * By default, each dataset is split into atomic datasets with a single file each. With a
+     * larger value, consecutive files of a dataset are grouped into atomic datasets of up to
+     * maxFiles files, and zero keeps every dataset whole. All files of an atomic dataset are
+     * processed by the same Processor with a single BeginRun/EndRun cycle, so readers that iterate
+     * over the files of a dataset, such as PECInputData, switch between them without
+     * reinitialization and can open the next file in advance. Output files of TFileService are
+     * then created for each atomic dataset and named after its first file. Note that fewer atomic
+     * datasets leave fewer units of work to distribute among threads. Grouping of files cannot be
+     * combined with splitting of files into ranges of entries (see SetMaxEventsPerRange and
+     * SetEventBatching); Process throws an exception in that case.
+     */
+    void SetMaxFilesPerDataset(unsigned maxFiles);
+    
+    /**
+     * \brief Limits the number of Processor clones used by method Process
+     * 
+     * By default, each of the threads requested in Process owns a clone of the Processor, with its
+     * own copies of all plugins and services. When a smaller number of clones is given here, only
+     * that many clones are created, each running in its own thread, and the remaining threads are
+     * given to ROOT's pool for implicit multithreading. The clones use the pool when reading
+     * their input: ROOT unpacks branches of a tree in parallel in TTree::GetEntry, and
+     * PECInputData uses the pool for parallel unpacking and read-ahead if they are enabled. This
+     * reduces the memory footprint of jobs with many threads. Automatic batching (see
+     * SetEventBatching) is based on the number of clones. The pool is not resized if implicit
+     * multithreading has already been enabled. Zero means one clone per thread, which is the
+     * default.
+     */
+    void SetMaxClones(unsigned maxClones);
+    
+    /**
+     * \brief Requests that input files be split into ranges of entries
+     * 
+     * Each file is split into ranges that contain at most maxEvents entries each, and the ranges
+     * are processed as independent atomic datasets (see Dataset::SetEntryRange). Entries are
+     * distributed among the ranges of a file evenly. Number of entries in a file is determined
+     * from the tree with the given name, which must be the tree that drives the event loop in the
+     * reader plugins. If automatic batching has been enabled with a different tree, an exception
+     * is thrown. Splitting is performed when method Process is called. A value of zero for
+     * maxEvents disables splitting, which is the default.
+     * 
+     * Output files created with TFileService for different ranges of the same file are merged
+     * automatically.
+     */
+    void SetMaxEventsPerRange(unsigned long maxEvents, std::string const &treeName);
+    
+    /**
+     * \brief Requests that input files be split into batches of entries according to the number
+     * of threads
+     * 
+     * When Process is called, the total number of entries in all input files is counted using
+     * the tree with the given name, and files are split into ranges of entries such that each
+     * thread is given on average batchesPerThread ranges. Several batches per thread are needed
+     * for an efficient load balancing. The batch size is not chosen below minBatchSize entries.
+     * It is an upper bound on the length of ranges: a file is divided into the smallest number
+     * of ranges that do not exceed the batch size, and entries are distributed among them evenly.
+     * Thus a file that is only slightly longer than the batch size gives two ranges of about half
+     * its length, and a file shorter than minBatchSize is not split. If SetMaxEventsPerRange has
+     * also been called, the smaller of the two range sizes is used, and both methods must be
+     * given the same tree, or an exception is thrown. Provide zero batchesPerThread to disable
+     * automatic batching.
+     */
+    void SetEventBatching(std::string const &treeName, unsigned batchesPerThread = 4,
+      unsigned long minBatchSize = 10000);
+    
 private:
+    /**
+     * \brief Splits datasets given to the constructor into atomic datasets
+     * 
+     * Follows the setting given with SetMaxFilesPerDataset.
+     */
+    void BuildAtomicDatasets();
+    
+    /**
+     * \brief Estimates cost of processing of an atomic dataset
+     * 
+     * The estimate is based on the total size of the input files, scaled according to the
+     * fraction of entries to be processed if this is known. If the size of some file cannot be
+     * determined (e.g. for a remote file), zero is returned.
+     */
+    double EstimateCost(Dataset const &dataset) const;
+    
+    /**
+     * \brief Provides the next atomic dataset for the processor in the given slot
+     * 
+     * Returns false if there are no datasets left. Called by Processor::operator().
+     */
+    bool PopDataset(unsigned slot, Dataset &dataset);
+    
+    /// Prints time that each thread has spent idle
+    void PrintThreadStat() const;
+    
+    /**
+     * \brief Prepares atomic datasets for processing with the given number of workers
+     * 
+     * Builds atomic datasets and splits input files into ranges of entries if requested. Returns
+     * the number of workers to be used, which does not exceed the number of atomic datasets.
+     */
+    int PrepareDatasets(int nWorkers);
+    
     /// Implementation for famility public methods Process
-    void ProcessImp(int nThreads);
+    void ProcessImp(int nThreads, Scheduling scheduling);
+    
+    /**
+     * \brief Runs a Processor in a forked worker process
+     * 
+     * Processes datasets from the deque with the given index and writes statistics of plugins
+     * into the given file descriptor. Returns the exit status for the process.
+     */
+    int RunWorker(unsigned slot, int outputFD);
+    
+    /**
+     * \brief Distributes atomic datasets among per-thread deques for work stealing
+     * 
+     * If keepFilesTogether is true, all atomic datasets with the same input file (i.e. different
+     * ranges of entries in it) are assigned to the same deque.
+     */
+    void SeedWorkQueues(unsigned nThreads, bool keepFilesTogether = false);
+    
+    /**
+     * \brief Chooses the size of ranges of entries for automatic batching
+     * 
+     * Implements the logic described in the documentation for SetEventBatching.
+     */
+    unsigned long ChooseBatchSize(int nThreads);
+    
+    /**
+     * \brief Returns the number of entries in the given file
+     * 
+     * The entries are counted in the tree specified with SetMaxEventsPerRange or
+     * SetEventBatching. Results are cached.
+     */
+    unsigned long CountEntries(std::filesystem::path const &filePath);
+    
+    /**
+     * \brief Splits atomic datasets into ranges of entries
+     * 
+     * Each range will contain at most maxEvents entries.
+     */
+    void SplitDatasets(unsigned long maxEvents);
     
 private:
-    /// Atomic (containing a single file each) datasets
+    /**
+     * \brief Datasets given to the constructor
+     * 
+     * They are split into atomic datasets when processing starts.
+     */
+    std::vector<Dataset> sourceDatasets;
+    
+    /**
+     * \brief Maximal number of input files in an atomic dataset
+     * 
+     * Zero means that datasets are not split.
+     */
+    unsigned maxFilesPerDataset;
+    
+    /// Atomic datasets
     std::queue<Dataset> datasets;
     
     /// A mutex to lock container with atomic datasets
     std::mutex mutexDatasets;
     
+    /// Selected strategy to distribute atomic datasets among threads
+    Scheduling scheduling;
+    
+    /// Per-thread deques of atomic datasets, used only when work stealing is requested
+    std::vector<std::unique_ptr<WorkQueue>> workQueues;
+    
+    /**
+     * \brief Statistics about occupation of threads
+     * 
+     * Each element is only modified by the corresponding thread.
+     */
+    std::vector<ThreadStat> threadStat;
+    
     /// A template processor to which services and plugins are registered
     Processor templateProcessor;
     
     /// Statistics about plugins in all processors
     std::vector<PluginStat> pathStat;
     
+    /**
+     * \brief Maximal number of entries in a range into which an input file is split
+     * 
+     * Zero means that files are not split.
+     */
+    unsigned long maxEventsPerRange;
+    
+    /// Name of the tree used to count entries in input files when splitting them
+    std::string rangeTreeName;
+    
+    /**
+     * \brief Target number of ranges of entries per thread for automatic batching
+     * 
+     * Zero means that the automatic batching is disabled.
+     */
+    unsigned batchesPerThread;
+    
+    /// Lower bound on the size of ranges of entries chosen by automatic batching
+    unsigned long minBatchSize;
+    
+    /**
+     * \brief Maximal number of Processor clones
+     * 
+     * Zero means that a clone is created for each thread.
+     */
+    unsigned maxClones;
+    
+    /**
+     * \brief Numbers of entries in input files
+     * 
+     * Only filled for files that have been counted when splitting them into ranges of entries.
+     */
+    std::map<std::filesystem::path, unsigned long> numEntries;
+    
 friend class Processor;
 };
 
 
 template<typename InputIt>
-RunManager::RunManager(InputIt const &datasetsBegin, InputIt const &datasetsEnd)
+RunManager::RunManager(InputIt const &datasetsBegin, InputIt const &datasetsEnd):
+    maxFilesPerDataset(1),
+    scheduling(Scheduling::Queue),
+    maxEventsPerRange(0),
+    batchesPerThread(0), minBatchSize(0),
+    maxClones(0)
 {
     templateProcessor.SetManager(this);
     
     
-    // Fill container with atomic datasets
+    // Save the datasets. They are split into atomic datasets when processing starts since the
+    //splitting can still be configured
     for (InputIt d = datasetsBegin; d != datasetsEnd; ++d)
-    {
-        for (auto const &file: d->GetFiles())
-        {
-            datasets.push(d->CopyParameters());
-            datasets.back().AddFile(file);
-        }
-    }
+        sourceDatasets.emplace_back(*d);
 }
@@ -85,6 +85,16 @@ public:
      */
     virtual void EndRun();
     
+    /**
+     * \brief Performs actions needed after all datasets have been processed
+     * 
+     * RunManager calls this method for all clones of the service once all of them have finished
+     * processing and before any of them is destroyed. This allows to finalize resources shared
+     * among the clones. Errors should be reported with exceptions. The method is trivial in the
+     * default implementation.
+     */
+    virtual void EndJob();
+    
     /**
      * \brief Returns a reference to the master
      * 
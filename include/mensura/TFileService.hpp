@@ -6,9 +6,13 @@
 
 #include <TFile.h>
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 
 /**
@@ -18,9 +22,46 @@
  * This service opens for writing a ROOT file for each processed dataset and allows creation of
  * ROOT objects, such as histograms and trees, to be stored in the file. The main motivation behind
  * this service is to allow aggregating output of multiple plugins in a single output file.
+ * 
+ * If a dataset is restricted to a range of entries (see Dataset::SetEntryRange), the output is
+ * first written into a partial file whose name includes the range. Partial files that correspond
+ * to the same output file are merged, and then removed, in EndJob, which RunManager calls once
+ * all datasets have been processed. If the service is used without RunManager, the merging is
+ * performed when the last clone of the service is destroyed.
  */
 class TFileService: public Service
 {
+private:
+    /**
+     * \brief Registry of partial output files
+     * 
+     * It is shared among all clones of the service.
+     */
+    struct PartialOutputs
+    {
+        /// Merges partial files that are still registered, reporting errors in the log
+        ~PartialOutputs() noexcept;
+        
+        /**
+         * \brief Merges registered partial files and removes them
+         * 
+         * Processed partial files are removed from the registry. If some of the output files
+         * cannot be produced, an exception is thrown after all of them have been attempted.
+         */
+        void Merge();
+        
+        /// Mutex to protect the map below
+        std::mutex mutex;
+        
+        /**
+         * \brief Registered partial files
+         * 
+         * The key of the map is the name of the output file, and the values are names of the
+         * corresponding partial files together with indices of first entries in their ranges.
+         */
+        std::map<std::string, std::vector<std::pair<unsigned long, std::string>>> parts;
+    };
+    
 public:
     /**
      * \brief Creates a service with the given name and given path for the output file
@@ -78,6 +119,15 @@ public:
     template <typename T, typename ... Args>
     T *Create(std::string const &inFileDirectory, Args const &... args) const;
     
+    /**
+     * \brief Returns the given directory in the output file
+     * 
+     * The directory path may include subdirectories. Directories are created if they do not exist.
+     * Use "" for the root directory. This method allows to place in the output file objects that
+     * cannot be created by Create, e.g. clones of trees. The caller must hold ROOTLock.
+     */
+    TDirectory *GetDirectory(std::string const &inFileDirectory) const;
+    
     /**
      * \brief Writes and closes the output file
      * 
@@ -85,6 +135,14 @@ public:
      */
     virtual void EndRun() override;
     
+    /**
+     * \brief Merges partial output files
+     * 
+     * The merging is performed by the first clone for which the method is called. Throws an
+     * exception if some of the partial files cannot be merged. Reimplemented from Service.
+     */
+    virtual void EndJob() override;
+    
 private:
     /// Validates provided output path and creates directories if needed
     void CheckOutputPath();
@@ -95,6 +153,19 @@ private:
     
     /// Output file for the current dataset
     std::unique_ptr<TFile> outFile;
+    
+    /**
+     * \brief Name of the output file to which the current partial file will be merged
+     * 
+     * Empty if the current dataset is not restricted to a range of entries.
+     */
+    std::string curMergedFileName;
+    
+    /// Index of the first entry in the range of the current dataset
+    unsigned long curFirstEntry;
+    
+    /// Registry of partial files shared among all clones
+    std::shared_ptr<PartialOutputs> partialOutputs;
 };
 
 
@@ -110,11 +181,7 @@ T *TFileService::Create(std::string const &inFileDirectory, Args const &... args
     ROOTLock::Lock();
     
     // Change to the given directory. Create it if needed
-    TDirectory *d = outFile->GetDirectory(inFileDirectory.c_str());
-    
-    if (not d)
-        d = outFile->mkdir(inFileDirectory.c_str());
-    
+    TDirectory *d = GetDirectory(inFileDirectory);
     d->cd();
     
     
@@ -67,6 +67,12 @@ public:
     [[deprecated("Use TriggerRange::GetDataTriggers instead")]]
     std::string const &GetDataTriggerPattern() const;
     
+    /// Returns the beginning of the data-taking period (included in the range)
+    EventID const &GetFirstEvent() const;
+    
+    /// Returns the end of the data-taking period (included in the range)
+    EventID const &GetLastEvent() const;
+    
     /// Returns effective integrated luminosity corresponding to the trigger set, 1/pb
     double GetLuminosity() const;
     
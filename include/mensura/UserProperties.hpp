@@ -0,0 +1,167 @@
+/**
+ * \file UserProperties.hpp
+ * 
+ * The module provides the infrastructure for user-defined properties of physics objects. Labels of
+ * properties are interned in a global registry, which maps them to small integer handles, and
+ * values are stored in a compact container indexed by these handles.
+ */
+
+#pragma once
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/// Handle that identifies a user-defined property, as assigned by UserPropertyRegistry
+enum class UserPropertyHandle: unsigned {};
+
+
+/**
+ * \class UserPropertyRegistry
+ * \brief Global registry of labels of user-defined properties
+ * 
+ * Each label is assigned a unique handle the first time it is registered, and the same handle is
+ * returned for all subsequent requests with this label. Handles remain valid for the lifetime of
+ * the process. Access to the registry is protected by a mutex, and thus handles should be looked
+ * up once, e.g. when a plugin is constructed or with a function-level static variable, rather than
+ * for every object.
+ */
+class UserPropertyRegistry
+{
+public:
+    /// Constructor is deleted
+    UserPropertyRegistry() = delete;
+    
+public:
+    /// Returns handle for the given label, registering it if needed
+    static UserPropertyHandle GetHandle(std::string const &label);
+    
+    /**
+     * \brief Returns label corresponding to the given handle
+     * 
+     * Throws an exception if the handle has not been assigned by the registry.
+     */
+    static std::string const &GetLabel(UserPropertyHandle handle);
+    
+private:
+    /// Mutex to protect the registry
+    static std::mutex registryMutex;
+    
+    /// Map from labels to handles
+    static std::unordered_map<std::string, UserPropertyHandle> handles;
+    
+    /**
+     * \brief Labels indexed by handles
+     * 
+     * A deque is used so that references to labels are not invalidated when new ones are added.
+     */
+    static std::deque<std::string> labels;
+};
+
+
+/**
+ * \class UserPropertyStore
+ * \brief Small container of values of user-defined properties indexed by their handles
+ * 
+ * The first N values are stored inline, so that a few properties can be attached to an object
+ * without allocation of memory. Further values are placed in a vector. Look-up is performed by
+ * linear search, which is efficient for the small number of properties typically used.
+ */
+template<typename T, unsigned N = 2>
+class UserPropertyStore
+{
+public:
+    /// Creates an empty container
+    UserPropertyStore() noexcept;
+    
+public:
+    /**
+     * \brief Finds value of the property with the given handle
+     * 
+     * Returns a null pointer if the property has not been set.
+     */
+    T const *Find(UserPropertyHandle handle) const noexcept;
+    
+    /// Sets or changes value of the property with the given handle
+    void Set(UserPropertyHandle handle, T const &value);
+    
+private:
+    /// Handle and value of a single property
+    struct Entry
+    {
+        UserPropertyHandle handle;
+        T value;
+    };
+    
+private:
+    /// Inline storage for the first N properties
+    std::array<Entry, N> inlineEntries;
+    
+    /// Number of properties stored inline
+    unsigned numInline;
+    
+    /// Storage for properties that do not fit in the inline one
+    std::vector<Entry> overflowEntries;
+};
+
+
+template<typename T, unsigned N>
+UserPropertyStore<T, N>::UserPropertyStore() noexcept:
+    inlineEntries{}, numInline(0)
+{}
+
+
+template<typename T, unsigned N>
+T const *UserPropertyStore<T, N>::Find(UserPropertyHandle handle) const noexcept
+{
+    for (unsigned i = 0; i < numInline; ++i)
+    {
+        if (inlineEntries[i].handle == handle)
+            return &inlineEntries[i].value;
+    }
+    
+    for (auto const &entry: overflowEntries)
+    {
+        if (entry.handle == handle)
+            return &entry.value;
+    }
+    
+    return nullptr;
+}
+
+
+template<typename T, unsigned N>
+void UserPropertyStore<T, N>::Set(UserPropertyHandle handle, T const &value)
+{
+    for (unsigned i = 0; i < numInline; ++i)
+    {
+        if (inlineEntries[i].handle == handle)
+        {
+            inlineEntries[i].value = value;
+            return;
+        }
+    }
+    
+    for (auto &entry: overflowEntries)
+    {
+        if (entry.handle == handle)
+        {
+            entry.value = value;
+            return;
+        }
+    }
+    
+    
+    // The property has not been set yet. Add it
+    if (numInline < N)
+    {
+        inlineEntries[numInline] = {handle, value};
+        ++numInline;
+    }
+    else
+        overflowEntries.push_back({handle, value});
+}
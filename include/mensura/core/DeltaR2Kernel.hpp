@@ -0,0 +1 @@
+../DeltaR2Kernel.hpp
\ No newline at end of file
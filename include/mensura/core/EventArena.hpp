@@ -0,0 +1 @@
+../EventArena.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../JetCollection.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../PtEtaPhiMVector.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../UserProperties.hpp
\ No newline at end of file
@@ -10,6 +10,12 @@ AnalysisPlugin::~AnalysisPlugin()
 {}
 
 
+std::string AnalysisPlugin::GetCacheKey() const
+{
+    return "";
+}
+
+
 Plugin::EventOutcome AnalysisPlugin::ReinterpretDecision(bool decision) const
 {
     if (decision)
@@ -10,14 +10,16 @@
 
 
 BTagEffService::BTagEffService(std::string const &name, std::string const &path):
-    Service(name)
+    Service(name),
+    histCache(std::make_shared<HistCache>())
 {
     OpenInputFile(path);
 }
 
 
 BTagEffService::BTagEffService(std::string const &path):
-    Service("BTagEff")
+    Service("BTagEff"),
+    histCache(std::make_shared<HistCache>())
 {
     OpenInputFile(path);
 }
@@ -26,6 +28,7 @@ BTagEffService::BTagEffService(std::string const &path):
 BTagEffService::BTagEffService(BTagEffService const &src) noexcept:
     Service(src),
     srcFile(src.srcFile),  // shared
+    histCache(src.histCache),  // shared
     inFileDirectory(src.inFileDirectory),
     effLabelRules(src.effLabelRules),
     defaultEffLabel(src.defaultEffLabel)
@@ -86,7 +89,7 @@ double BTagEffService::GetEfficiency(BTagger const &bTagger, double pt, double e
 {
     // Find the appropriate efficiency histogram. Load it if needed
     auto histGroupIt = effHists.find(bTagger);
-    TH2 *hist = nullptr;
+    TH2 const *hist = nullptr;
     
     if (histGroupIt == effHists.end())
     {
@@ -150,33 +153,45 @@ void BTagEffService::SetDefaultEffLabel(std::string const &label)
 }
 
 
-void BTagEffService::LoadEfficiencies(BTagger const &bTagger)
+std::shared_ptr<TH2 const> BTagEffService::GetHistogram(std::string const &path)
 {
-    using namespace std;
+    std::lock_guard<std::mutex> lock(histCache->mutex);
+    auto const res = histCache->hists.find(path);
     
-    string const bTaggerCode(bTagger.GetTextCode());
+    if (res != histCache->hists.end())
+        return res->second;
     
     
-    // Read histograms for all jet flavours. This is not a thread-safe operation
+    // Read the histogram from the file. This is not a thread-safe operation
     ROOTLock::Lock();
+    std::shared_ptr<TH2> hist(dynamic_cast<TH2 *>(srcFile->Get(path.c_str())));
     
-    shared_ptr<TH2> bHist(dynamic_cast<TH2 *>(srcFile->Get(
-      (inFileDirectory + bTaggerCode + "/" + curEffLabel + "_b").c_str())));
-    shared_ptr<TH2> cHist(dynamic_cast<TH2 *>(srcFile->Get(
-      (inFileDirectory + bTaggerCode + "/" + curEffLabel + "_c").c_str())));
-    shared_ptr<TH2> udsgHist(dynamic_cast<TH2 *>(srcFile->Get(
-      (inFileDirectory + bTaggerCode + "/" + curEffLabel + "_udsg").c_str())));
-    
-    // Make sure the histograms are not associated with a file
-    for (auto const &p: {bHist, cHist, udsgHist})
-    {
-        if (p)
-            p->SetDirectory(nullptr);
-    }
+    // Make sure the histogram is not associated with a file
+    if (hist)
+        hist->SetDirectory(nullptr);
     
     ROOTLock::Unlock();
     
     
+    histCache->hists[path] = hist;
+    return hist;
+}
+
+
+void BTagEffService::LoadEfficiencies(BTagger const &bTagger)
+{
+    using namespace std;
+    
+    string const bTaggerCode(bTagger.GetTextCode());
+    
+    
+    // Read histograms for all jet flavours
+    string const pathPrefix(inFileDirectory + bTaggerCode + "/" + curEffLabel);
+    auto const bHist = GetHistogram(pathPrefix + "_b");
+    auto const cHist = GetHistogram(pathPrefix + "_c");
+    auto const udsgHist = GetHistogram(pathPrefix + "_udsg");
+    
+    
     // Make sure at least some histograms with efficiencies have been read from the file
     if (not bHist and not cHist and not udsgHist)
     {
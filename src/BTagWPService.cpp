@@ -112,6 +112,15 @@ bool BTagWPService::IsTagged(BTagger const &tagger, Jet const &jet) const
 }
 
 
+bool BTagWPService::IsTagged(BTagger const &tagger, JetCollection::JetProxy const &jet) const
+{
+    if (fabs(jet.Eta()) > BTagger::GetMaxPseudorapidity())
+        return false;
+    
+    return (jet.BTag(tagger.GetAlgorithm()) > GetThreshold(tagger));
+}
+
+
 void BTagWPService::SetThreshold(BTagger const &tagger, double threshold)
 {
     thresholds[tagger] = threshold;
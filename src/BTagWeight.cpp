@@ -78,18 +78,21 @@ double BTagWeight::CalcWeight(Variation var /*=Variation::Nominal*/) const
     double weight = 1.;
     
     
-    // Loop over jets in the current event
+    // Loop over jets in the current event. Properties of jets are read from the collection
+    //directly and passed to the services as numbers
     for (auto const &jet: jetPlugin->GetJets())
     {
+        double const pt = jet.Pt(), eta = jet.Eta();
+        
         // Skip jets that fail the pt cut or fall outside of the tracker acceptance
-        if (jet.Pt() < minPt or std::fabs(jet.Eta()) > BTagger::GetMaxPseudorapidity())
+        if (pt < minPt or std::fabs(eta) > BTagger::GetMaxPseudorapidity())
             continue;
         
         
         // Precalculate b-tagging scale factor for the current jet
+        int const flavour = jet.Flavour(Jet::FlavourType::Hadron);
         double const sf =
-          bTagSFService->GetScaleFactor(jet,
-            TranslateVariation(var, jet.Flavour(Jet::FlavourType::Hadron)));
+          bTagSFService->GetScaleFactor(pt, eta, flavour, TranslateVariation(var, flavour));
         
         
         // Update the weight
@@ -98,7 +101,7 @@ double BTagWeight::CalcWeight(Variation var /*=Variation::Nominal*/) const
         else
         {
             // Only in this case the b-tagging efficiency is needed. Calculate it
-            double const eff = bTagEffService->GetEfficiency(bTagger, jet);
+            double const eff = bTagEffService->GetEfficiency(bTagger, pt, eta, flavour);
             
             if (eff < 1.)
                 weight *= (1. - sf * eff) / (1. - eff);
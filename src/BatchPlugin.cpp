@@ -0,0 +1,43 @@
+#include <mensura/BatchPlugin.hpp>
+
+#include <sstream>
+#include <stdexcept>
+
+
+BatchPlugin::BatchPlugin(std::string const &name):
+    AnalysisPlugin(name),
+    blockSize(1024)
+{}
+
+
+BatchPlugin::~BatchPlugin()
+{}
+
+
+void BatchPlugin::EvaluateBlock(std::vector<char> &mask)
+{
+    ProcessBlock(blockSize, mask);
+    
+    if (mask.empty() or mask.size() > blockSize)
+    {
+        std::ostringstream message;
+        message << "BatchPlugin[\"" << GetName() << "\"]::EvaluateBlock: Plugin has provided " <<
+          mask.size() << " decisions while between 1 and " << blockSize << " were expected.";
+        throw std::logic_error(message.str());
+    }
+}
+
+
+unsigned BatchPlugin::GetBlockSize() const
+{
+    return blockSize;
+}
+
+
+void BatchPlugin::SetBlockSize(unsigned blockSize_)
+{
+    if (blockSize_ == 0)
+        throw std::logic_error("BatchPlugin::SetBlockSize: Block size must be positive.");
+    
+    blockSize = blockSize_;
+}
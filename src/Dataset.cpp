@@ -1,5 +1,6 @@
 #include <mensura/Dataset.hpp>
 
+#include <limits>
 #include <regex>
 #include <sstream>
 #include <stdexcept>
@@ -12,14 +13,16 @@ using namespace std;
 Dataset::Dataset() noexcept:
     sourceDatasetID(""),
     isData(false),
-    crossSection(0.), numEvents(0), meanWeight(0.)
+    crossSection(0.), numEvents(0), meanWeight(0.),
+    firstEntry(0), lastEntry(std::numeric_limits<unsigned long>::max())
 {}
 
 
 Dataset::Dataset(Dataset::Type type, std::string sourceDatasetID_ /*= ""*/):
     sourceDatasetID(sourceDatasetID_),
     isData(type == Type::Data),
-    crossSection(0.), numEvents(0), meanWeight(0.)
+    crossSection(0.), numEvents(0), meanWeight(0.),
+    firstEntry(0), lastEntry(std::numeric_limits<unsigned long>::max())
 {}
 
 
@@ -42,6 +45,8 @@ Dataset Dataset::CopyParameters() const
     emptyDataset.numEvents = numEvents;
     emptyDataset.meanWeight = meanWeight;
     emptyDataset.flags = flags;
+    emptyDataset.firstEntry = firstEntry;
+    emptyDataset.lastEntry = lastEntry;
 
     return emptyDataset;
 }
@@ -59,18 +64,51 @@ std::string const &Dataset::GetSourceDatasetID() const
 }
 
 
+unsigned long Dataset::GetFirstEntry() const
+{
+    return firstEntry;
+}
+
+
+unsigned long Dataset::GetLastEntry() const
+{
+    return lastEntry;
+}
+
+
 double Dataset::GetWeight() const
 {
     return crossSection / (numEvents * meanWeight);
 }
 
 
+bool Dataset::HasEntryRange() const
+{
+    return (firstEntry != 0 or lastEntry != std::numeric_limits<unsigned long>::max());
+}
+
+
 bool Dataset::IsMC() const
 {
     return not isData;
 }
 
 
+void Dataset::SetEntryRange(unsigned long firstEntry_, unsigned long lastEntry_)
+{
+    if (lastEntry_ < firstEntry_)
+    {
+        std::ostringstream message;
+        message << "Dataset::SetEntryRange: Given range [" << firstEntry_ << ", " << lastEntry_ <<
+          "] is empty.";
+        throw std::logic_error(message.str());
+    }
+    
+    firstEntry = firstEntry_;
+    lastEntry = lastEntry_;
+}
+
+
 void Dataset::SetFlag(string const &flagName)
 {
     auto res = flags.insert(flagName);
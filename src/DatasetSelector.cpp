@@ -46,6 +46,12 @@ Plugin *DatasetSelector::Clone() const
 }
 
 
+std::string DatasetSelector::GetCacheKey() const
+{
+    return (processCurDataset) ? "DatasetSelector:1" : "DatasetSelector:0";
+}
+
+
 bool DatasetSelector::ProcessEvent()
 {
     return processCurDataset;
@@ -0,0 +1,163 @@
+#include <mensura/DeltaR2Kernel.hpp>
+
+#include <TMath.h>
+#include <TVector2.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define MENSURA_DELTAR2_AVX2
+#include <immintrin.h>
+#endif
+
+
+void DeltaR2Kernel::Compute(double eta, double phi, double const *etas, double const *phis,
+  std::size_t n, double *dR2)
+{
+    // Arrays shorter than a single vector register are processed by the scalar loop anyway, so
+    //skip the dispatch for them
+    if (n >= 4 and UsesAVX2())
+        ComputeAVX2(eta, phi, etas, phis, n, dR2);
+    else
+        ComputeScalar(eta, phi, etas, phis, n, dR2);
+}
+
+
+std::size_t DeltaR2Kernel::FindClosest(double eta, double phi, double pt, double const *etas,
+  double const *phis, double const *pts, std::size_t n, double maxDR2, double maxDPt)
+{
+    // Distances are computed in chunks of a fixed size, and the closest direction is then chosen
+    //with a scalar loop
+    constexpr std::size_t chunkSize = 16;
+    double buffer[chunkSize];
+    
+    std::size_t closest = n;
+    double minDR2 = maxDR2;
+    
+    for (std::size_t start = 0; start < n; start += chunkSize)
+    {
+        std::size_t const size = std::min(chunkSize, n - start);
+        Compute(eta, phi, etas + start, phis + start, size, buffer);
+        
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (buffer[i] < minDR2 and std::abs(pt - pts[start + i]) < maxDPt)
+            {
+                closest = start + i;
+                minDR2 = buffer[i];
+            }
+        }
+    }
+    
+    return closest;
+}
+
+
+std::size_t DeltaR2Kernel::FindFirstWithin(double eta, double phi, double const *etas,
+  double const *phis, std::size_t n, double maxDR2)
+{
+    // Distances are computed in groups of four, which matches the width of the vectorised
+    //implementation and allows to stop early when a close direction has been found
+    constexpr std::size_t groupSize = 4;
+    double buffer[groupSize];
+    std::size_t start = 0;
+    
+    for (; start + groupSize <= n; start += groupSize)
+    {
+        Compute(eta, phi, etas + start, phis + start, groupSize, buffer);
+        
+        for (std::size_t i = 0; i < groupSize; ++i)
+        {
+            if (buffer[i] < maxDR2)
+                return start + i;
+        }
+    }
+    
+    
+    // Remaining directions do not fill a group. This is also the only loop executed for typical
+    //events with fewer than four leptons.
+    for (std::size_t i = start; i < n; ++i)
+    {
+        if (Scalar(eta, phi, etas[i], phis[i]) < maxDR2)
+            return i;
+    }
+    
+    return n;
+}
+
+
+bool DeltaR2Kernel::UsesAVX2() noexcept
+{
+    #ifdef MENSURA_DELTAR2_AVX2
+    static bool const hasAVX2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    return hasAVX2;
+    #else
+    return false;
+    #endif
+}
+
+
+#ifdef MENSURA_DELTAR2_AVX2
+__attribute__((target("avx2")))
+#endif
+void DeltaR2Kernel::ComputeAVX2(double eta, double phi, double const *etas, double const *phis,
+  std::size_t n, double *dR2)
+{
+    std::size_t i = 0;
+    
+    #ifdef MENSURA_DELTAR2_AVX2
+    __m256d const refEta = _mm256_set1_pd(eta);
+    __m256d const refPhi = _mm256_set1_pd(phi);
+    __m256d const pi = _mm256_set1_pd(TMath::Pi());
+    __m256d const minusPi = _mm256_set1_pd(-TMath::Pi());
+    __m256d const twoPi = _mm256_set1_pd(TMath::TwoPi());
+    
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d const dEta = _mm256_sub_pd(refEta, _mm256_loadu_pd(etas + i));
+        __m256d dPhi = _mm256_sub_pd(refPhi, _mm256_loadu_pd(phis + i));
+        
+        // Bring the difference in phi into [-pi, pi) with a single step of the loops in
+        //TVector2::Phi_mpi_pi. Lanes that are not affected get zero added or subtracted.
+        dPhi = _mm256_sub_pd(dPhi, _mm256_and_pd(_mm256_cmp_pd(dPhi, pi, _CMP_GE_OQ), twoPi));
+        dPhi = _mm256_add_pd(dPhi,
+          _mm256_and_pd(_mm256_cmp_pd(dPhi, minusPi, _CMP_LT_OQ), twoPi));
+        
+        // A single step is enough if the input angles are within [-pi, pi]. Otherwise fall back
+        //to the scalar implementation for this group
+        __m256d const outOfRange = _mm256_or_pd(_mm256_cmp_pd(dPhi, pi, _CMP_GE_OQ),
+          _mm256_cmp_pd(dPhi, minusPi, _CMP_LT_OQ));
+        
+        if (_mm256_movemask_pd(outOfRange) != 0)
+        {
+            ComputeScalar(eta, phi, etas + i, phis + i, 4, dR2 + i);
+            continue;
+        }
+        
+        _mm256_storeu_pd(dR2 + i,
+          _mm256_add_pd(_mm256_mul_pd(dEta, dEta), _mm256_mul_pd(dPhi, dPhi)));
+    }
+    
+    // Clear upper halves of the vector registers to avoid penalties in the following code that
+    //does not use AVX instructions
+    _mm256_zeroupper();
+    #endif
+    
+    // Process the remaining elements
+    ComputeScalar(eta, phi, etas + i, phis + i, n - i, dR2 + i);
+}
+
+
+void DeltaR2Kernel::ComputeScalar(double eta, double phi, double const *etas,
+  double const *phis, std::size_t n, double *dR2)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        dR2[i] = Scalar(eta, phi, etas[i], phis[i]);
+}
+
+
+double DeltaR2Kernel::Scalar(double eta1, double phi1, double eta2, double phi2)
+{
+    return std::pow(eta1 - eta2, 2) + std::pow(TVector2::Phi_mpi_pi(phi1 - phi2), 2);
+}
@@ -0,0 +1,86 @@
+#include <mensura/EventArena.hpp>
+
+#include <algorithm>
+
+
+EventArena::EventArena(std::size_t initialSize_ /*= 65536*/):
+    initialSize(std::max<std::size_t>(initialSize_, 1)),
+    curBlock(0), offset(0)
+{}
+
+
+EventArena::~EventArena() noexcept
+{}
+
+
+std::size_t EventArena::GetCapacity() const noexcept
+{
+    std::size_t capacity = 0;
+    
+    for (auto const &block: blocks)
+        capacity += block.size;
+    
+    return capacity;
+}
+
+
+void EventArena::Reset()
+{
+    // If more than one block has been used, replace them with a single block large enough to
+    //serve the same amount of memory without jumping between blocks
+    if (blocks.size() > 1)
+    {
+        std::size_t const capacity = GetCapacity();
+        blocks.clear();
+        blocks.push_back({std::make_unique<std::byte[]>(capacity), capacity});
+    }
+    
+    curBlock = 0;
+    offset = 0;
+}
+
+
+void *EventArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    // Try the current block and, if it does not have enough space, the following ones
+    while (curBlock < blocks.size())
+    {
+        Block &block = blocks[curBlock];
+        void *p = block.data.get() + offset;
+        std::size_t space = block.size - offset;
+        
+        if (std::align(alignment, bytes, p, space))
+        {
+            offset = static_cast<std::byte *>(p) - block.data.get() + bytes;
+            return p;
+        }
+        
+        ++curBlock;
+        offset = 0;
+    }
+    
+    
+    // Allocate a new block. Its size grows geometrically, and it is always large enough for the
+    //requested chunk with any alignment
+    std::size_t const size = std::max((blocks.empty()) ? initialSize : 2 * blocks.back().size,
+      bytes + alignment);
+    blocks.push_back({std::make_unique<std::byte[]>(size), size});
+    curBlock = blocks.size() - 1;
+    
+    void *p = blocks.back().data.get();
+    std::size_t space = size;
+    std::align(alignment, bytes, p, space);
+    offset = static_cast<std::byte *>(p) - blocks.back().data.get() + bytes;
+    
+    return p;
+}
+
+
+void EventArena::do_deallocate(void *, std::size_t, std::size_t)
+{}
+
+
+bool EventArena::do_is_equal(std::pmr::memory_resource const &other) const noexcept
+{
+    return (this == &other);
+}
@@ -64,6 +64,21 @@ Plugin *EventIDFilter::Clone() const
 }
 
 
+std::string EventIDFilter::GetCacheKey() const
+{
+    std::ostringstream key;
+    key << "EventIDFilter:" << rejectKnownEvent;
+    
+    if (eventIDsCurFile)
+    {
+        for (auto const &id: *eventIDsCurFile)
+            key << ";" << id.Run() << ":" << id.LumiBlock() << ":" << id.Event();
+    }
+    
+    return key.str();
+}
+
+
 void EventIDFilter::SetEventIDPluginName(std::string const &name)
 {
     eventIDPluginName = name;
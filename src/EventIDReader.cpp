@@ -14,3 +14,9 @@ EventID const &EventIDReader::GetEventID() const
 {
     return eventID;
 }
+
+
+void EventIDReader::PeekEventIDs(unsigned, std::vector<EventID> &eventIDs) const
+{
+    eventIDs.assign(1, eventID);
+}
@@ -0,0 +1,202 @@
+#include <mensura/FlatReader/FlatInputData.hpp>
+
+#include <mensura/Logger.hpp>
+#include <mensura/ROOTLock.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+
+using namespace logging;
+using namespace std::string_literals;
+
+
+FlatInputData::FlatInputData(std::string const name):
+    EventIDReader(name),
+    nextFileIt(inputFiles.end()),
+    treeName("Events"),
+    treeReader(new TTreeReader), newTreeSet(false),
+    nextEvent(0), endEvent(0),
+    firstEntry(0), lastEntry(0)
+{}
+
+
+FlatInputData::~FlatInputData()
+{}
+
+
+void FlatInputData::BeginRun(Dataset const &dataset)
+{
+    // Copy information about files in the dataset and set up the iterator
+    auto const &srcFiles = dataset.GetFiles();
+    std::copy(srcFiles.begin(), srcFiles.end(), std::back_inserter(inputFiles));
+    nextFileIt = inputFiles.begin();
+    
+    firstEntry = dataset.GetFirstEntry();
+    lastEntry = dataset.GetLastEntry();
+    
+    nextEvent = endEvent = 0;
+    
+    
+    // Set up reading of the event ID. This is done before the first file is opened, as is the
+    //case for dependant plugins
+    runColumn.reset(new TTreeReaderValue<UInt_t>(*treeReader, "run"));
+    lumiColumn.reset(new TTreeReaderValue<UInt_t>(*treeReader, "luminosityBlock"));
+    eventColumn.reset(new TTreeReaderValue<ULong64_t>(*treeReader, "event"));
+    
+    
+    // Report an error is the dataset is empty. This does not pose a problem for FlatInputData,
+    //but dependant plugins will not be able to read any columns
+    if (srcFiles.size() == 0)
+    {
+        logger << "Error in FlatInputData: Empty dataset is given to plugin \"" << GetName() <<
+          "\"." << eom;
+        return;
+    }
+    
+    
+    // Open the first input file
+    NextInputFile();
+}
+
+
+Plugin *FlatInputData::Clone() const
+{
+    FlatInputData *clone = new FlatInputData(GetName());
+    clone->SetTreeName(treeName);
+    return clone;
+}
+
+
+void FlatInputData::EndRun()
+{
+    // Detach the reader from the tree before the tree is deleted. The reader is also restarted
+    //since otherwise it refuses to register columns that will be requested for the next dataset
+    //after entries have been read
+    ROOTLock::Lock();
+    treeReader->Restart();
+    treeReader->SetTree(nullptr);
+    tree.reset();
+    curInputFile.reset();
+    ROOTLock::Unlock();
+    
+    inputFiles.clear();
+}
+
+
+TTreeReader &FlatInputData::GetTreeReader() const
+{
+    return *treeReader;
+}
+
+
+void FlatInputData::SetTreeName(std::string const &name)
+{
+    treeName = name;
+}
+
+
+bool FlatInputData::NextInputFile()
+{
+    // Check if there are files left in the dataset
+    if (nextFileIt == inputFiles.end())
+        return false;
+    
+    
+    // Open the new file and read the tree from it
+    ROOTLock::Lock();
+    std::unique_ptr<TFile> newFile(TFile::Open(nextFileIt->c_str()));
+    ROOTLock::Unlock();
+    
+    if (not newFile or newFile->IsZombie())
+        throw std::runtime_error("FlatInputData::NextInputFile: File "s + nextFileIt->string() +
+         " does not exist or is not a valid ROOT file.");
+    
+    ROOTLock::Lock();
+    std::unique_ptr<TTree> newTree(dynamic_cast<TTree *>(newFile->Get(treeName.c_str())));
+    ROOTLock::Unlock();
+    
+    if (not newTree)
+        throw std::runtime_error("FlatInputData::NextInputFile: File "s + nextFileIt->string() +
+         " does not contain tree \"" + treeName + "\".");
+    
+    
+    // Give the new tree to the reader and only then delete the previous tree and file. Columns
+    //requested by dependant plugins will be set up when the first entry is read
+    ROOTLock::Lock();
+    treeReader->SetTree(newTree.get());
+    tree = std::move(newTree);
+    curInputFile = std::move(newFile);
+    ROOTLock::Unlock();
+    
+    newTreeSet = true;
+    ++nextFileIt;
+    
+    
+    // Restrict reading to the requested range of entries
+    unsigned long const nEvents = tree->GetEntries();
+    nextEvent = std::min(firstEntry, nEvents);
+    endEvent = (lastEntry < nEvents) ? lastEntry + 1 : nEvents;
+    
+    if (endEvent < nextEvent)
+        endEvent = nextEvent;
+    
+    
+    return true;
+}
+
+
+bool FlatInputData::ProcessEvent()
+{
+    // Make sure there are events left in the tree and open the next file if it is not the case.
+    //Repeat if the requested range of entries in the new file is empty
+    while (nextEvent == endEvent)
+    {
+        bool const fileOpened = NextInputFile();
+        
+        if (not fileOpened)
+            return false;
+    }
+    
+    
+    // Position the reader at the next event. When this is done for the first time after a new
+    //tree has been set, the reader sets up all branches, which is protected with the lock
+    if (newTreeSet)
+        ROOTLock::Lock();
+    
+    TTreeReader::EEntryStatus const status = treeReader->SetEntry(nextEvent);
+    
+    if (newTreeSet)
+    {
+        ROOTLock::Unlock();
+        newTreeSet = false;
+    }
+    
+    if (status != TTreeReader::kEntryValid)
+    {
+        std::ostringstream message;
+        message << "FlatInputData[\"" << GetName() << "\"]::ProcessEvent: Failed to read entry " <<
+          nextEvent << " from file " << curInputFile->GetName() << " (status " << int(status) <<
+          ").";
+        throw std::runtime_error(message.str());
+    }
+    
+    ++nextEvent;
+    
+    
+    // Read the event ID
+    eventID.Set(**runColumn, **lumiColumn, **eventColumn);
+    
+    
+    // Debug output
+    #ifdef DEBUG
+    std::cout << "FlatInputData[\"" << GetName() << "\"]: Read event " << eventID.Run() << ":" <<
+      eventID.LumiBlock() << ":" << eventID.Event() << std::endl;
+    #endif
+    
+    
+    return true;
+}
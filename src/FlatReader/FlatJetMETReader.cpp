@@ -0,0 +1,238 @@
+#include <mensura/FlatReader/FlatJetMETReader.hpp>
+
+#include <mensura/Processor.hpp>
+#include <mensura/PhysicsObjects.hpp>
+#include <mensura/FlatReader/FlatInputData.hpp>
+
+#include <TVector2.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+
+FlatJetMETReader::FlatJetMETReader(std::string name /*= "JetMET"*/):
+    JetMETReader(name),
+    inputDataPluginName("InputData"), inputDataPlugin(nullptr),
+    minPt(0.), maxAbsEta(std::numeric_limits<double>::infinity()),
+    readRawMET(false), applyJetID(true),
+    leptonPluginName("Leptons"), leptonPlugin(nullptr)
+{
+    leptonDR2 = std::pow(GetJetRadius(), 2);
+}
+
+
+FlatJetMETReader::FlatJetMETReader(FlatJetMETReader const &src) noexcept:
+    JetMETReader(src),
+    inputDataPluginName(src.inputDataPluginName), inputDataPlugin(src.inputDataPlugin),
+    minPt(src.minPt), maxAbsEta(src.maxAbsEta),
+    readRawMET(src.readRawMET), applyJetID(src.applyJetID),
+    leptonPluginName(src.leptonPluginName), leptonPlugin(src.leptonPlugin),
+    leptonDR2(src.leptonDR2)
+{}
+
+
+FlatJetMETReader::~FlatJetMETReader() noexcept
+{}
+
+
+void FlatJetMETReader::BeginRun(Dataset const &dataset)
+{
+    // Save pointers to required plugins
+    inputDataPlugin =
+      dynamic_cast<FlatInputData const *>(GetDependencyPlugin(inputDataPluginName));
+    
+    if (leptonPluginName != "")
+        leptonPlugin = dynamic_cast<LeptonReader const *>(GetDependencyPlugin(leptonPluginName));
+    
+    
+    // Set up reading of columns. Only the columns that are accessed will be read
+    TTreeReader &reader = inputDataPlugin->GetTreeReader();
+    
+    jetPt.reset(new TTreeReaderArray<Float_t>(reader, "Jet_pt"));
+    jetEta.reset(new TTreeReaderArray<Float_t>(reader, "Jet_eta"));
+    jetPhi.reset(new TTreeReaderArray<Float_t>(reader, "Jet_phi"));
+    jetMass.reset(new TTreeReaderArray<Float_t>(reader, "Jet_mass"));
+    jetRawFactor.reset(new TTreeReaderArray<Float_t>(reader, "Jet_rawFactor"));
+    jetArea.reset(new TTreeReaderArray<Float_t>(reader, "Jet_area"));
+    jetPileUpID.reset(new TTreeReaderArray<Float_t>(reader, "Jet_puIdDisc"));
+    jetBTagCSV.reset(new TTreeReaderArray<Float_t>(reader, "Jet_btagCSVV2"));
+    jetBTagCMVA.reset(new TTreeReaderArray<Float_t>(reader, "Jet_btagCMVA"));
+    jetBTagDeepCSV.reset(new TTreeReaderArray<Float_t>(reader, "Jet_btagDeepB"));
+    jetID.reset(new TTreeReaderArray<Int_t>(reader, "Jet_jetId"));
+    
+    if (dataset.IsMC())
+    {
+        jetHadronFlavour.reset(new TTreeReaderArray<Int_t>(reader, "Jet_hadronFlavour"));
+        jetPartonFlavour.reset(new TTreeReaderArray<Int_t>(reader, "Jet_partonFlavour"));
+    }
+    else
+    {
+        jetHadronFlavour.reset();
+        jetPartonFlavour.reset();
+    }
+    
+    metPt.reset(new TTreeReaderValue<Float_t>(reader, "MET_pt"));
+    metPhi.reset(new TTreeReaderValue<Float_t>(reader, "MET_phi"));
+    
+    if (readRawMET)
+    {
+        rawMETPt.reset(new TTreeReaderValue<Float_t>(reader, "RawMET_pt"));
+        rawMETPhi.reset(new TTreeReaderValue<Float_t>(reader, "RawMET_phi"));
+    }
+}
+
+
+Plugin *FlatJetMETReader::Clone() const
+{
+    return new FlatJetMETReader(*this);
+}
+
+
+void FlatJetMETReader::ConfigureLeptonCleaning(std::string const leptonPluginName_, double dR)
+{
+    leptonPluginName = leptonPluginName_;
+    leptonDR2 = dR * dR;
+}
+
+
+void FlatJetMETReader::ConfigureLeptonCleaning(std::string const leptonPluginName_
+  /*= "Leptons"*/)
+{
+    leptonPluginName = leptonPluginName_;
+    leptonDR2 = std::pow(GetJetRadius(), 2);
+}
+
+
+double FlatJetMETReader::GetJetRadius() const
+{
+    return 0.4;
+}
+
+
+void FlatJetMETReader::ReadRawMET(bool enable /*= true*/)
+{
+    readRawMET = enable;
+}
+
+
+void FlatJetMETReader::SetApplyJetID(bool applyJetID_)
+{
+    applyJetID = applyJetID_;
+}
+
+
+void FlatJetMETReader::SetSelection(double minPt_, double maxAbsEta_)
+{
+    minPt = minPt_;
+    maxAbsEta = maxAbsEta_;
+}
+
+
+bool FlatJetMETReader::ProcessEvent()
+{
+    // Postpone reading of the columns until jets and MET are requested by another plugin
+    SetEventPending();
+    
+    
+    // Since this reader does not have access to the input file, it does not know when there are
+    //no more events in the dataset and thus always returns true
+    return true;
+}
+
+
+void FlatJetMETReader::UnpackEvent()
+{
+    // Clear collection of jets from the previous event
+    jets.clear();
+    
+    static UserPropertyHandle const idHandle = UserPropertyRegistry::GetHandle("ID");
+    
+    
+    // Collection of leptons against which jets will be cleaned
+    auto const *leptonsForCleaning = (leptonPlugin) ? &leptonPlugin->GetLeptons() : nullptr;
+    
+    
+    // Process jets in the current event. Kinematic selection and ID are checked on the columns
+    //directly, before four-momenta are constructed
+    unsigned const nJets = jetPt->GetSize();
+    
+    for (unsigned i = 0; i < nJets; ++i)
+    {
+        double const pt = (*jetPt)[i], eta = (*jetEta)[i], phi = (*jetPhi)[i];
+        
+        if (pt < minPt or std::abs(eta) > maxAbsEta)
+            continue;
+        
+        bool const passID = ((*jetID)[i] & 1);
+        //^ The first bit corresponds to the loose ID
+        
+        if (applyJetID and not passID)
+            continue;
+        
+        
+        // Peform cleaning against leptons if enabled
+        if (leptonsForCleaning)
+        {
+            bool overlap = false;
+            
+            for (auto const &l: *leptonsForCleaning)
+            {
+                double const dR2 = std::pow(eta - l.Eta(), 2) +
+                  std::pow(TVector2::Phi_mpi_pi(phi - l.Phi()), 2);
+                
+                if (dR2 < leptonDR2)
+                {
+                    overlap = true;
+                    break;
+                }
+            }
+            
+            if (overlap)
+                continue;
+        }
+        
+        
+        // Add the jet to the collection
+        PtEtaPhiMVector p4(pt, eta, phi, (*jetMass)[i]);
+        
+        std::size_t const index = jets.Add(p4, 1. - (*jetRawFactor)[i]);
+        
+        jets.SetBTag(index, BTagger::Algorithm::CSV, (*jetBTagCSV)[i]);
+        jets.SetBTag(index, BTagger::Algorithm::CMVA, (*jetBTagCMVA)[i]);
+        jets.SetBTag(index, BTagger::Algorithm::DeepCSV, (*jetBTagDeepCSV)[i]);
+        
+        jets.SetArea(index, (*jetArea)[i]);
+        jets.SetPileUpID(index, (*jetPileUpID)[i]);
+        
+        if (jetHadronFlavour)
+        {
+            jets.SetFlavour(index, Jet::FlavourType::Hadron, (*jetHadronFlavour)[i]);
+            jets.SetFlavour(index, Jet::FlavourType::Parton, (*jetPartonFlavour)[i]);
+        }
+        
+        if (not applyJetID)
+            jets.SetUserInt(index, idHandle, int(passID));
+    }
+    
+    
+    // Make sure collection of jets is ordered in transverse momentum
+    jets.SortByPt();
+    
+    
+    // Read MET
+    met.SetPtEtaPhiM(**metPt, 0., **metPhi, 0.);
+    
+    if (readRawMET)
+    {
+        double const x = **rawMETPt * std::cos(**rawMETPhi);
+        double const y = **rawMETPt * std::sin(**rawMETPhi);
+        rawMET.SetPxPyPzE(x, y, 0., std::hypot(x, y));
+    }
+    
+    
+    #ifdef DEBUG
+    std::cout << "FlatJetMETReader[\"" << GetName() << "\"]: " << jets.size() << " jets " <<
+      "selected, MET (pt, phi): " << met.Pt() << ", " << met.Phi() << std::endl;
+    #endif
+}
@@ -0,0 +1,145 @@
+#include <mensura/FlatReader/FlatLeptonReader.hpp>
+
+#include <mensura/Processor.hpp>
+#include <mensura/FlatReader/FlatInputData.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+
+FlatLeptonReader::FlatLeptonReader(std::string const name /*= "Leptons"*/):
+    LeptonReader(name),
+    inputDataPluginName("InputData"), inputDataPlugin(nullptr)
+{}
+
+
+FlatLeptonReader::FlatLeptonReader(FlatLeptonReader const &src) noexcept:
+    LeptonReader(src),
+    inputDataPluginName(src.inputDataPluginName),
+    inputDataPlugin(src.inputDataPlugin)
+{}
+
+
+FlatLeptonReader::~FlatLeptonReader() noexcept
+{}
+
+
+void FlatLeptonReader::BeginRun(Dataset const &)
+{
+    // Save pointer to the plugin providing access to input data
+    inputDataPlugin =
+      dynamic_cast<FlatInputData const *>(GetDependencyPlugin(inputDataPluginName));
+    
+    
+    // Set up reading of columns
+    TTreeReader &reader = inputDataPlugin->GetTreeReader();
+    
+    electronPt.reset(new TTreeReaderArray<Float_t>(reader, "Electron_pt"));
+    electronEta.reset(new TTreeReaderArray<Float_t>(reader, "Electron_eta"));
+    electronPhi.reset(new TTreeReaderArray<Float_t>(reader, "Electron_phi"));
+    electronDEtaSC.reset(new TTreeReaderArray<Float_t>(reader, "Electron_deltaEtaSC"));
+    electronRelIso.reset(new TTreeReaderArray<Float_t>(reader, "Electron_pfRelIso03_all"));
+    electronCharge.reset(new TTreeReaderArray<Int_t>(reader, "Electron_charge"));
+    electronCutBasedID.reset(new TTreeReaderArray<Int_t>(reader, "Electron_cutBased"));
+    
+    muonPt.reset(new TTreeReaderArray<Float_t>(reader, "Muon_pt"));
+    muonEta.reset(new TTreeReaderArray<Float_t>(reader, "Muon_eta"));
+    muonPhi.reset(new TTreeReaderArray<Float_t>(reader, "Muon_phi"));
+    muonRelIso.reset(new TTreeReaderArray<Float_t>(reader, "Muon_pfRelIso04_all"));
+    muonCharge.reset(new TTreeReaderArray<Int_t>(reader, "Muon_charge"));
+    muonLooseID.reset(new TTreeReaderArray<Bool_t>(reader, "Muon_looseId"));
+    muonTightID.reset(new TTreeReaderArray<Bool_t>(reader, "Muon_tightId"));
+}
+
+
+Plugin *FlatLeptonReader::Clone() const
+{
+    return new FlatLeptonReader(*this);
+}
+
+
+bool FlatLeptonReader::ProcessEvent()
+{
+    // Postpone reading of the columns until leptons are requested by another plugin
+    SetEventPending();
+    
+    
+    // Since this reader does not have access to the input file, it does not know when there are
+    //no more events in the dataset and thus always returns true
+    return true;
+}
+
+
+void FlatLeptonReader::UnpackEvent()
+{
+    // Clear vectors with leptons from the previous event
+    leptons.clear();
+    looseLeptons.clear();
+    
+    
+    // Process electrons in the current event. The selection follows PECLeptonReader
+    static UserPropertyHandle const etaSCHandle = UserPropertyRegistry::GetHandle("etaSC");
+    unsigned const nElectrons = electronPt->GetSize();
+    
+    for (unsigned i = 0; i < nElectrons; ++i)
+    {
+        // Selection to define a loose electron
+        double const etaSC = (*electronEta)[i] + (*electronDEtaSC)[i];
+        double const absEtaSC = std::abs(etaSC);
+        int const cutBasedID = (*electronCutBasedID)[i];
+        
+        if ((*electronPt)[i] < 20. or absEtaSC > 2.5 or cutBasedID < 1 /* "veto" ID */)
+            continue;
+        
+        PtEtaPhiMVector p4((*electronPt)[i], (*electronEta)[i], (*electronPhi)[i], 0.511e-3);
+        
+        Lepton lepton(Lepton::Flavour::Electron, p4);
+        lepton.SetRelIso((*electronRelIso)[i]);
+        lepton.SetCharge((*electronCharge)[i]);
+        lepton.SetUserFloat(etaSCHandle, etaSC);
+        
+        looseLeptons.push_back(lepton);
+        
+        
+        // Further selection for a tight electron
+        if (cutBasedID < 4 /* "tight" ID */ or
+          (absEtaSC > 1.4442 and absEtaSC < 1.5660) /* EB-EE gap */)
+            continue;
+        
+        leptons.push_back(lepton);
+    }
+    
+    
+    // Process muons in the current event
+    unsigned const nMuons = muonPt->GetSize();
+    
+    for (unsigned i = 0; i < nMuons; ++i)
+    {
+        // Selection to define a loose muon
+        double const relIso = (*muonRelIso)[i];
+        
+        if ((*muonPt)[i] < 10. or std::abs((*muonEta)[i]) > 2.4 or relIso > 0.25 or
+          not (*muonLooseID)[i])
+            continue;
+        
+        PtEtaPhiMVector p4((*muonPt)[i], (*muonEta)[i], (*muonPhi)[i], 0.105);
+        
+        Lepton lepton(Lepton::Flavour::Muon, p4);
+        lepton.SetRelIso(relIso);
+        lepton.SetCharge((*muonCharge)[i]);
+        
+        looseLeptons.push_back(lepton);
+        
+        
+        // Further selection for a tight muon
+        if (relIso > 0.15 or not (*muonTightID)[i])
+            continue;
+        
+        leptons.push_back(lepton);
+    }
+    
+    
+    // Make sure both collections are ordered in transverse momentum
+    std::sort(leptons.rbegin(), leptons.rend());
+    std::sort(looseLeptons.rbegin(), looseLeptons.rend());
+}
@@ -0,0 +1,67 @@
+#include <mensura/FlatReader/FlatPileUpReader.hpp>
+
+#include <mensura/Processor.hpp>
+#include <mensura/FlatReader/FlatInputData.hpp>
+
+
+FlatPileUpReader::FlatPileUpReader(std::string const name /*= "PileUp"*/):
+    PileUpReader(name),
+    inputDataPluginName("InputData"),
+    inputDataPlugin(nullptr)
+{}
+
+
+FlatPileUpReader::FlatPileUpReader(FlatPileUpReader const &src) noexcept:
+    PileUpReader(src),
+    inputDataPluginName(src.inputDataPluginName),
+    inputDataPlugin(src.inputDataPlugin)
+{}
+
+
+FlatPileUpReader::~FlatPileUpReader() noexcept
+{}
+
+
+void FlatPileUpReader::BeginRun(Dataset const &dataset)
+{
+    // Save pointer to the plugin providing access to input data
+    inputDataPlugin =
+      dynamic_cast<FlatInputData const *>(GetDependencyPlugin(inputDataPluginName));
+    
+    
+    // Set up reading of columns
+    TTreeReader &reader = inputDataPlugin->GetTreeReader();
+    numVerticesColumn.reset(new TTreeReaderValue<Int_t>(reader, "PV_npvs"));
+    rhoColumn.reset(new TTreeReaderValue<Float_t>(reader, "fixedGridRhoFastjetAll"));
+    
+    if (dataset.IsMC())
+        expectedPileUpColumn.reset(new TTreeReaderValue<Float_t>(reader, "Pileup_nTrueInt"));
+    else
+        expectedPileUpColumn.reset();
+}
+
+
+Plugin *FlatPileUpReader::Clone() const
+{
+    return new FlatPileUpReader(*this);
+}
+
+
+bool FlatPileUpReader::ProcessEvent()
+{
+    // Postpone reading of the columns until pile-up information is requested by another plugin
+    SetEventPending();
+    
+    
+    // Since this reader does not have access to the input file, it does not know when there are
+    //no more events in the dataset and thus always returns true
+    return true;
+}
+
+
+void FlatPileUpReader::UnpackEvent()
+{
+    numVertices = **numVerticesColumn;
+    expectedPileUp = (expectedPileUpColumn) ? **expectedPileUpColumn : 0.;
+    rho = **rhoColumn;
+}
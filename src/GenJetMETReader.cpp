@@ -12,11 +12,13 @@ GenJetMETReader::~GenJetMETReader() noexcept
 
 std::vector<GenJet> const &GenJetMETReader::GetJets() const
 {
+    LoadPendingEvent();
     return jets;
 }
 
 
 MET const &GenJetMETReader::GetMET() const
 {
+    LoadPendingEvent();
     return met;
 }
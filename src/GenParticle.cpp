@@ -9,9 +9,11 @@ GenParticle::GenParticle() noexcept:
 {}
 
 
-GenParticle::GenParticle(TLorentzVector const &p4_, int pdgId_ /*= 0*/) noexcept:
+GenParticle::GenParticle(PtEtaPhiMVector const &p4_, int pdgId_ /*= 0*/,
+  std::pmr::memory_resource *resource /*= std::pmr::get_default_resource()*/) noexcept:
     Candidate(p4_),
-    pdgId(pdgId_)
+    pdgId(pdgId_),
+    mothers(resource), daughters(resource)
 {}
 
 
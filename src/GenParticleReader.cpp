@@ -12,5 +12,6 @@ GenParticleReader::~GenParticleReader()
 
 std::vector<GenParticle> const &GenParticleReader::GetParticles() const
 {
+    LoadPendingEvent();
     return particles;
 }
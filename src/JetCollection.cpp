@@ -0,0 +1,444 @@
+#include <mensura/JetCollection.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+
+using namespace std::string_literals;
+
+
+PtEtaPhiMVector JetCollection::JetProxy::CompactP4() const noexcept
+{
+    return PtEtaPhiMVector(Pt(), Eta(), Phi(), M());
+}
+
+
+TLorentzVector JetCollection::JetProxy::P4() const noexcept
+{
+    return CompactP4();
+}
+
+
+double JetCollection::JetProxy::E() const noexcept
+{
+    return CompactP4().E();
+}
+
+
+TLorentzVector JetCollection::JetProxy::RawP4() const noexcept
+{
+    return CompactP4() * RawMomentumSF();
+}
+
+
+double JetCollection::JetProxy::UserFloat(std::string const &label) const
+{
+    return UserFloat(UserPropertyRegistry::GetHandle(label));
+}
+
+
+double JetCollection::JetProxy::UserFloat(UserPropertyHandle handle) const
+{
+    auto const res = collection->userFloats.find(handle);
+    
+    if (res == collection->userFloats.end() or not res->second[index])
+    {
+        std::ostringstream message;
+        message << "JetCollection::JetProxy::UserFloat: Real-valued property with label \"" <<
+          UserPropertyRegistry::GetLabel(handle) << "\" is not defined.";
+        throw std::out_of_range(message.str());
+    }
+    
+    return *res->second[index];
+}
+
+
+long JetCollection::JetProxy::UserInt(std::string const &label) const
+{
+    return UserInt(UserPropertyRegistry::GetHandle(label));
+}
+
+
+long JetCollection::JetProxy::UserInt(UserPropertyHandle handle) const
+{
+    auto const res = collection->userInts.find(handle);
+    
+    if (res == collection->userInts.end() or not res->second[index])
+    {
+        std::ostringstream message;
+        message << "JetCollection::JetProxy::UserInt: Integer-valued property with label \"" <<
+          UserPropertyRegistry::GetLabel(handle) << "\" is not defined.";
+        throw std::out_of_range(message.str());
+    }
+    
+    return *res->second[index];
+}
+
+
+JetCollection::JetProxy::operator Jet() const
+{
+    Jet jet;
+    jet.SetCorrectedP4(CompactP4(), collection->rawMomentumSF[index]);
+    
+    for (unsigned slot = 0; slot < BTagger::numAlgorithms; ++slot)
+    {
+        if (collection->bTagMasks[index] & (1u << slot))
+            jet.SetBTag(BTagger::Algorithm(slot), collection->bTags[slot][index]);
+    }
+    
+    for (unsigned type = 0; type < collection->flavours.size(); ++type)
+        jet.SetFlavour(Jet::FlavourType(type), collection->flavours[type][index]);
+    
+    jet.SetCharge(Charge());
+    jet.SetPullAngle(GetPullAngle());
+    jet.SetArea(Area());
+    jet.SetPileUpID(PileUpID());
+    jet.SetMatchedGenJet(MatchedGenJet());
+    
+    for (auto const &column: collection->userFloats)
+    {
+        if (column.second[index])
+            jet.SetUserFloat(column.first, *column.second[index]);
+    }
+    
+    for (auto const &column: collection->userInts)
+    {
+        if (column.second[index])
+            jet.SetUserInt(column.first, *column.second[index]);
+    }
+    
+    return jet;
+}
+
+
+JetCollection::JetCollection() noexcept
+{}
+
+
+std::size_t JetCollection::Add(PtEtaPhiMVector const &correctedP4, double rawMomentumSF_)
+{
+    std::size_t const index = pt.size();
+    
+    pt.emplace_back(correctedP4.Pt());
+    eta.emplace_back(correctedP4.Eta());
+    phi.emplace_back(correctedP4.Phi());
+    mass.emplace_back(correctedP4.M());
+    rawMomentumSF.emplace_back(rawMomentumSF_);
+    
+    // Default values are the same as in the constructor of Jet
+    area.emplace_back(0.);
+    puDiscriminator.emplace_back(0.);
+    charge.emplace_back(-10.);
+    pullAngle.emplace_back(-10.);
+    
+    for (auto &column: bTags)
+        column.emplace_back(0.);
+    
+    bTagMasks.emplace_back(0);
+    
+    for (auto &column: flavours)
+        column.emplace_back(0);
+    
+    matchedGenJets.emplace_back(nullptr);
+    
+    for (auto &column: userFloats)
+        column.second.emplace_back();
+    
+    for (auto &column: userInts)
+        column.second.emplace_back();
+    
+    return index;
+}
+
+
+std::size_t JetCollection::Add(JetProxy const &jet)
+{
+    JetCollection const &src = *jet.collection;
+    std::size_t const srcIndex = jet.index;
+    
+    std::size_t const index = pt.size();
+    
+    pt.emplace_back(src.pt[srcIndex]);
+    eta.emplace_back(src.eta[srcIndex]);
+    phi.emplace_back(src.phi[srcIndex]);
+    mass.emplace_back(src.mass[srcIndex]);
+    rawMomentumSF.emplace_back(src.rawMomentumSF[srcIndex]);
+    area.emplace_back(src.area[srcIndex]);
+    puDiscriminator.emplace_back(src.puDiscriminator[srcIndex]);
+    charge.emplace_back(src.charge[srcIndex]);
+    pullAngle.emplace_back(src.pullAngle[srcIndex]);
+    
+    for (unsigned slot = 0; slot < BTagger::numAlgorithms; ++slot)
+        bTags[slot].emplace_back(src.bTags[slot][srcIndex]);
+    
+    bTagMasks.emplace_back(src.bTagMasks[srcIndex]);
+    
+    for (unsigned type = 0; type < flavours.size(); ++type)
+        flavours[type].emplace_back(src.flavours[type][srcIndex]);
+    
+    matchedGenJets.emplace_back(src.matchedGenJets[srcIndex]);
+    
+    
+    // Extend all existing arrays of user-defined properties and then copy the properties set for
+    //the source jet, creating new arrays if needed
+    for (auto &column: userFloats)
+        column.second.emplace_back();
+    
+    for (auto &column: userInts)
+        column.second.emplace_back();
+    
+    for (auto const &column: src.userFloats)
+    {
+        if (column.second[srcIndex])
+            SetUserFloat(index, column.first, *column.second[srcIndex]);
+    }
+    
+    for (auto const &column: src.userInts)
+    {
+        if (column.second[srcIndex])
+            SetUserInt(index, column.first, *column.second[srcIndex]);
+    }
+    
+    return index;
+}
+
+
+void JetCollection::clear() noexcept
+{
+    for (auto *column: {&pt, &eta, &phi, &mass, &rawMomentumSF, &area, &puDiscriminator, &charge,
+      &pullAngle})
+        column->clear();
+    
+    for (auto &column: bTags)
+        column.clear();
+    
+    bTagMasks.clear();
+    
+    for (auto &column: flavours)
+        column.clear();
+    
+    matchedGenJets.clear();
+    
+    
+    // Keep the arrays of user-defined properties so that they are reused in the next event
+    for (auto &column: userFloats)
+        column.second.clear();
+    
+    for (auto &column: userInts)
+        column.second.clear();
+}
+
+
+std::vector<double> const &JetCollection::EtaColumn() const noexcept
+{
+    return eta;
+}
+
+
+std::vector<double> const &JetCollection::PhiColumn() const noexcept
+{
+    return phi;
+}
+
+
+std::vector<double> const &JetCollection::PtColumn() const noexcept
+{
+    return pt;
+}
+
+
+void JetCollection::reserve(std::size_t capacity)
+{
+    for (auto *column: {&pt, &eta, &phi, &mass, &rawMomentumSF, &area, &puDiscriminator, &charge,
+      &pullAngle})
+        column->reserve(capacity);
+    
+    for (auto &column: bTags)
+        column.reserve(capacity);
+    
+    bTagMasks.reserve(capacity);
+    
+    for (auto &column: flavours)
+        column.reserve(capacity);
+    
+    matchedGenJets.reserve(capacity);
+}
+
+
+void JetCollection::SetArea(std::size_t index, double area_)
+{
+    area[index] = area_;
+}
+
+
+void JetCollection::SetBTag(std::size_t index, BTagger::Algorithm algo, double value)
+{
+    unsigned const slot = unsigned(algo);
+    
+    if (slot >= BTagger::numAlgorithms)
+        throw std::runtime_error("JetCollection::SetBTag: Unsupported b-tagging algorithm "s +
+          BTagger::AlgorithmToTextCode(algo) + ".");
+    
+    bTags[slot][index] = value;
+    bTagMasks[index] |= (1u << slot);
+}
+
+
+void JetCollection::SetCharge(std::size_t index, double charge_)
+{
+    charge[index] = charge_;
+}
+
+
+void JetCollection::SetCorrectedP4(std::size_t index, PtEtaPhiMVector const &correctedP4,
+  double rawMomentumSF_)
+{
+    pt[index] = correctedP4.Pt();
+    eta[index] = correctedP4.Eta();
+    phi[index] = correctedP4.Phi();
+    mass[index] = correctedP4.M();
+    rawMomentumSF[index] = rawMomentumSF_;
+}
+
+
+void JetCollection::SetFlavour(std::size_t index, Jet::FlavourType type, int flavour)
+{
+    unsigned const slot = unsigned(type);
+    
+    if (slot >= flavours.size())
+        ThrowUnknownFlavour(type);
+    
+    flavours[slot][index] = flavour;
+}
+
+
+void JetCollection::SetMatchedGenJet(std::size_t index, GenJet const *matchedJet)
+{
+    matchedGenJets[index] = matchedJet;
+}
+
+
+void JetCollection::SetPileUpID(std::size_t index, double puDiscriminator_)
+{
+    puDiscriminator[index] = puDiscriminator_;
+}
+
+
+void JetCollection::SetPullAngle(std::size_t index, double pullAngle_)
+{
+    pullAngle[index] = pullAngle_;
+}
+
+
+void JetCollection::SetUserFloat(std::size_t index, std::string const &label, double value)
+{
+    SetUserFloat(index, UserPropertyRegistry::GetHandle(label), value);
+}
+
+
+void JetCollection::SetUserFloat(std::size_t index, UserPropertyHandle handle, double value)
+{
+    auto &column = userFloats[handle];
+    column.resize(pt.size());
+    column[index] = value;
+}
+
+
+void JetCollection::SetUserInt(std::size_t index, std::string const &label, long value)
+{
+    SetUserInt(index, UserPropertyRegistry::GetHandle(label), value);
+}
+
+
+void JetCollection::SetUserInt(std::size_t index, UserPropertyHandle handle, long value)
+{
+    auto &column = userInts[handle];
+    column.resize(pt.size());
+    column[index] = value;
+}
+
+
+void JetCollection::SortByPt()
+{
+    if (std::is_sorted(pt.begin(), pt.end(), std::greater<double>()))
+        return;
+    
+    orderBuffer.resize(pt.size());
+    
+    for (std::size_t i = 0; i < orderBuffer.size(); ++i)
+        orderBuffer[i] = i;
+    
+    std::sort(orderBuffer.begin(), orderBuffer.end(),
+      [this](std::size_t lhs, std::size_t rhs){return (pt[lhs] > pt[rhs]);});
+    
+    Permute();
+}
+
+
+template<typename T>
+void JetCollection::ApplyPermutation(std::vector<T> &column)
+{
+    // Follow each cycle of the permutation, marking elements already placed in the buffer
+    permBuffer.assign(orderBuffer.begin(), orderBuffer.end());
+    
+    for (std::size_t start = 0; start < permBuffer.size(); ++start)
+    {
+        if (permBuffer[start] == start)
+            continue;
+        
+        T saved(std::move(column[start]));
+        std::size_t cur = start;
+        
+        while (permBuffer[cur] != start)
+        {
+            std::size_t const next = permBuffer[cur];
+            column[cur] = std::move(column[next]);
+            permBuffer[cur] = cur;
+            cur = next;
+        }
+        
+        column[cur] = std::move(saved);
+        permBuffer[cur] = cur;
+    }
+}
+
+
+void JetCollection::Permute()
+{
+    for (auto *column: {&pt, &eta, &phi, &mass, &rawMomentumSF, &area, &puDiscriminator, &charge,
+      &pullAngle})
+        ApplyPermutation(*column);
+    
+    for (auto &column: bTags)
+        ApplyPermutation(column);
+    
+    ApplyPermutation(bTagMasks);
+    
+    for (auto &column: flavours)
+        ApplyPermutation(column);
+    
+    ApplyPermutation(matchedGenJets);
+    
+    for (auto &column: userFloats)
+        ApplyPermutation(column.second);
+    
+    for (auto &column: userInts)
+        ApplyPermutation(column.second);
+}
+
+
+void JetCollection::ThrowMissingBTag(BTagger::Algorithm algo)
+{
+    throw std::runtime_error("JetCollection::JetProxy::BTag: No value of b-tagging "s +
+      "discriminator is available for algorithm " + BTagger::AlgorithmToTextCode(algo) + ".");
+}
+
+
+void JetCollection::ThrowUnknownFlavour(Jet::FlavourType type)
+{
+    std::ostringstream message;
+    message << "JetCollection: Unknown jet flavour (" << unsigned(type) << ") is given.";
+    throw std::runtime_error(message.str());
+}
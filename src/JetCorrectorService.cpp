@@ -10,10 +10,39 @@
 
 #include <cmath>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 
 
+struct JetCorrectorService::IOVData
+{
+    /// Parameters for all requested levels of jet energy corrections
+    std::vector<JetCorrectorParameters> jecParameters;
+    
+    /// Parameters for all requested sources of JEC uncertainty
+    std::vector<JetCorrectorParameters> jecUncParameters;
+    
+    /// Data/MC scale factors for JER. Null if not specified
+    std::shared_ptr<JME::JetResolutionScaleFactor const> jerSFProvider;
+};
+
+
+struct JetCorrectorService::SharedData
+{
+    /// Mutex to protect the cache
+    std::mutex mutex;
+    
+    /**
+     * \brief Parsed parameters for all IOVs
+     * 
+     * Indices are the same as in JetCorrectorService::iovParams. Null pointers correspond to IOVs
+     * whose parameters have not been read yet.
+     */
+    std::vector<std::shared_ptr<IOVData const>> iovData;
+};
+
+
 JetCorrectorService::IOVParams::IOVParams(EventID::RunNumber_t minRun_,
   EventID::RunNumber_t maxRun_):
     minRun(minRun_), maxRun(maxRun_)
@@ -22,14 +51,18 @@ JetCorrectorService::IOVParams::IOVParams(EventID::RunNumber_t minRun_,
 
 JetCorrectorService::JetCorrectorService(std::string const name /*= "JetCorrector"*/):
     Service(name),
-    matchAllMode(false), curIOV(-1), curRun(0)
+    matchAllMode(false),
+    sharedData(std::make_shared<SharedData>()),
+    curIOV(-1), curRun(0)
 {}
 
 
 JetCorrectorService::JetCorrectorService(JetCorrectorService const &src):
     Service(src),
     iovParams(src.iovParams), iovLabelMap(src.iovLabelMap),
-    matchAllMode(src.matchAllMode), curIOV(-1), curRun(0)
+    matchAllMode(src.matchAllMode),
+    sharedData(src.sharedData),  // shared
+    curIOV(-1), curRun(0)
 {
     // Create a random-number generator if needed. Cannot share the same generator between copies
     //because generation of random numbers is not thread-safe
@@ -50,6 +83,23 @@ Service *JetCorrectorService::Clone() const
 
 double JetCorrectorService::Eval(Jet const &jet, double rho, SystType syst /*= SystType::None*/,
   SystService::VarDirection direction /*= SystService::VarDirection::Undefined*/) const
+{
+    return EvalImpl(jet.RawP4().Pt(), jet.Pt(), jet.Eta(), jet.Area(), jet.MatchedGenJet(), rho,
+      syst, direction);
+}
+
+
+double JetCorrectorService::Eval(JetCollection::JetProxy const &jet, double rho,
+  SystType syst /*= SystType::None*/,
+  SystService::VarDirection direction /*= SystService::VarDirection::Undefined*/) const
+{
+    return EvalImpl(jet.RawP4().Pt(), jet.Pt(), jet.Eta(), jet.Area(), jet.MatchedGenJet(), rho,
+      syst, direction);
+}
+
+
+double JetCorrectorService::EvalImpl(double rawPt, double corrPt, double eta, double area,
+  GenJet const *genJet, double rho, SystType syst, SystService::VarDirection direction) const
 {
     if (iovParams.empty())
     {
@@ -69,11 +119,9 @@ double JetCorrectorService::Eval(Jet const &jet, double rho, SystType syst /*= S
     
     if (jetEnergyCorrector)
     {
-        double const rawPt = jet.RawP4().Pt();
-        
-        jetEnergyCorrector->setJetEta(jet.Eta());
+        jetEnergyCorrector->setJetEta(eta);
         jetEnergyCorrector->setJetPt(rawPt);
-        jetEnergyCorrector->setJetA(jet.Area());
+        jetEnergyCorrector->setJetA(area);
         jetEnergyCorrector->setRho(rho);
         
         double const jecFactor = jetEnergyCorrector->getCorrection();
@@ -84,7 +132,7 @@ double JetCorrectorService::Eval(Jet const &jet, double rho, SystType syst /*= S
     else
     {
         // Assume the jet has been created with momentum fully corrected for nominal JEC
-        jecCorrPt = jet.Pt();
+        jecCorrPt = corrPt;
     }
     
     
@@ -101,7 +149,7 @@ double JetCorrectorService::Eval(Jet const &jet, double rho, SystType syst /*= S
         }
         
         
-        double const jecUncertainty = EvalJECUnc(jecCorrPt, jet.Eta());
+        double const jecUncertainty = EvalJECUnc(jecCorrPt, eta);
         
         if (direction == SystService::VarDirection::Up)
             corrFactor *= (1. + jecUncertainty);
@@ -138,13 +186,11 @@ double JetCorrectorService::Eval(Jet const &jet, double rho, SystType syst /*= S
         }
         
         double const jerSF =
-          jerSFProvider->getScaleFactor({{JME::Binning::JetEta, jet.Eta()}}, jerVar);
+          jerSFProvider->getScaleFactor({{JME::Binning::JetEta, eta}}, jerVar);
         
         
         // Depending on the presence of a matched GEN-level jet, perform deterministic or
         //stochastic smearing
-        GenJet const *genJet = jet.MatchedGenJet();
-        
         if (genJet)
         {
             // Smearing is done as here [1]
@@ -163,7 +209,7 @@ double JetCorrectorService::Eval(Jet const &jet, double rho, SystType syst /*= S
             //[1] https://github.com/cms-sw/cmssw/blob/CMSSW_8_0_8/PhysicsTools/PatUtils/interface/SmearedJetProducerT.h#L244_L250
             double const ptResolution =
               jerProvider->getResolution({{JME::Binning::JetPt, jecCorrPt},
-              {JME::Binning::JetEta, jet.Eta()}, {JME::Binning::Rho, rho}});
+              {JME::Binning::JetEta, eta}, {JME::Binning::Rho, rho}});
             double const jerFactor = 1. + rGen->Gaus(0., ptResolution) *
               std::sqrt(std::max(std::pow(jerSF, 2) - 1., 0.));
             
@@ -299,6 +345,10 @@ void JetCorrectorService::RegisterIOV(std::string const &label, EventID::RunNumb
     // Add a new IOV
     iovParams.emplace_back(minRun, maxRun);
     iovLabelMap[label] = iovParams.size() - 1;
+    
+    // Parameters read previously (if any) are not shared with copies created after the change in
+    //the configuration
+    sharedData = std::make_shared<SharedData>();
 }
 
 
@@ -342,10 +392,11 @@ void JetCorrectorService::SelectIOV(EventID::RunNumber_t run) const
     // Update all JERC evaluators
     curIOV = iovIndex;
     
+    auto const iovData = GetIOVData();
     auto nonConstThis = const_cast<JetCorrectorService *>(this);
-    nonConstThis->UpdateJECEvaluator();
-    nonConstThis->UpdateJECUncEvaluator();
-    nonConstThis->UpdateJEREvaluator();
+    nonConstThis->UpdateJECEvaluator(*iovData);
+    nonConstThis->UpdateJECUncEvaluator(*iovData);
+    nonConstThis->UpdateJEREvaluator(*iovData);
 }
 
 
@@ -396,6 +447,11 @@ void JetCorrectorService::SetJER(std::string const &jerSFFile, std::string const
 
 JetCorrectorService::IOVParams &JetCorrectorService::GetIOVByLabel(std::string const &label)
 {
+    // The returned parameters are going to be modified. Make sure parameters read with the
+    //previous configuration (if any) are not shared with copies created after the change
+    sharedData = std::make_shared<SharedData>();
+    
+    
     if (label == "")
     {
         // Special case of a match-all IOV. Make sure that no explicit IOV have been defined.
@@ -442,74 +498,94 @@ JetCorrectorService::IOVParams &JetCorrectorService::GetIOVByLabel(std::string c
 }
 
 
-void JetCorrectorService::UpdateJECEvaluator()
+std::shared_ptr<JetCorrectorService::IOVData const> JetCorrectorService::GetIOVData() const
 {
-    auto const &jecFiles = iovParams[curIOV].jecFiles;
+    // The lock is kept while reading the files so that other copies of the service wait for the
+    //parameters instead of reading them again
+    std::lock_guard<std::mutex> lock(sharedData->mutex);
+    auto &iovDataCache = sharedData->iovData;
+    
+    if (iovDataCache.size() < iovParams.size())
+        iovDataCache.resize(iovParams.size());
+    
+    auto &iovData = iovDataCache[curIOV];
+    
+    if (iovData)
+        return iovData;
+    
     
-    if (jecFiles.size() > 0)
-    {
-        // Create an object that computes jet energy corrections. Code follows an example in [1].
-        //[1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/WorkBookJetEnergyCorrections?rev=136#JetEnCorFWLite
-        std::vector<JetCorrectorParameters> jecParameters;
-        
-        for (auto const &jecFile: jecFiles)
-            jecParameters.emplace_back(jecFile);
-        
-        jetEnergyCorrector.reset(new FactorizedJetCorrector(jecParameters));
-    }
-    else
-        jetEnergyCorrector.reset();
-}
-
-
-void JetCorrectorService::UpdateJECUncEvaluator()
-{
     auto const &iov = iovParams[curIOV];
+    auto newData = std::make_shared<IOVData>();
+    
+    // Read parameters for jet energy corrections. Code follows an example in [1].
+    //[1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/WorkBookJetEnergyCorrections?rev=136#JetEnCorFWLite
+    for (auto const &jecFile: iov.jecFiles)
+        newData->jecParameters.emplace_back(jecFile);
     
+    
+    // Read parameters for JEC uncertainties. Code follows an example in [1].
+    //[1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/WorkBookJetEnergyCorrections?rev=136#JetCorUncertainties
     if (iov.jecUncFile != "")
     {
-        // Create objects to compute JEC uncertainties. Code follows an example in [1].
-        //[1] https://twiki.cern.ch/twiki/bin/view/CMSPublic/WorkBookJetEnergyCorrections?rev=136#JetCorUncertainties
         if (iov.jecUncSources.size() == 0)
-            jecUncProviders.emplace_back(new JetCorrectionUncertainty(iov.jecUncFile));
+            newData->jecUncParameters.emplace_back(iov.jecUncFile);
         else
         {
             for (auto const &uncSource: iov.jecUncSources)
             {
-                std::unique_ptr<JetCorrectorParameters> jecUncParams;
-                
                 try
                 {
-                    jecUncParams.reset(new JetCorrectorParameters(iov.jecUncFile, uncSource));
+                    newData->jecUncParameters.emplace_back(iov.jecUncFile, uncSource);
                 }
                 catch (std::runtime_error const &)
                 {
                     std::ostringstream message;
                     message << "JetCorrectorService[\"" << GetName() <<
-                      "\"]::UpdateJECUncEvaluator: Error while constructing JEC uncertainty \"" <<
+                      "\"]::GetIOVData: Error while constructing JEC uncertainty \"" <<
                       uncSource << "\" from file \"" << iov.jecUncFile << "\". The file might not "
                       "contain definition for the requested uncertainty.";
                     throw std::runtime_error(message.str());
                 }
-                
-                jecUncProviders.emplace_back(new JetCorrectionUncertainty(*jecUncParams));
             }
         }
     }
+    
+    
+    // Read JER scale factors
+    if (iov.jerSFFile != "")
+        newData->jerSFProvider = std::make_shared<JME::JetResolutionScaleFactor>(iov.jerSFFile);
+    
+    
+    iovData = newData;
+    return iovData;
+}
+
+
+void JetCorrectorService::UpdateJECEvaluator(IOVData const &iovData)
+{
+    if (iovData.jecParameters.size() > 0)
+        jetEnergyCorrector.reset(new FactorizedJetCorrector(iovData.jecParameters));
     else
-        jecUncProviders.clear();
+        jetEnergyCorrector.reset();
 }
 
 
-void JetCorrectorService::UpdateJEREvaluator()
+void JetCorrectorService::UpdateJECUncEvaluator(IOVData const &iovData)
 {
-    auto const &iov = iovParams[curIOV];
+    jecUncProviders.clear();
     
-    if (iov.jerSFFile != "")
-        jerSFProvider.reset(
-          new JME::JetResolutionScaleFactor(iov.jerSFFile));
-    else
-        jerSFProvider.reset();
+    for (auto const &jecUncParams: iovData.jecUncParameters)
+        jecUncProviders.emplace_back(new JetCorrectionUncertainty(jecUncParams));
+}
+
+
+void JetCorrectorService::UpdateJEREvaluator(IOVData const &iovData)
+{
+    jerSFProvider = iovData.jerSFProvider;
+    
+    // The object that provides pt resolution is not shared because evaluation of the underlying
+    //formula is not thread-safe
+    auto const &iov = iovParams[curIOV];
     
     if (iov.jerMCFile != "")
         jerProvider.reset(new JME::JetResolution(iov.jerMCFile));
@@ -11,7 +11,7 @@ using namespace std;
 
 
 JetFunctorFilter::JetFunctorFilter(string const &name_,
-  function<bool(Jet const &)> const &selector_,
+  Selector const &selector_,
   unsigned minNumJets_, unsigned maxNumJets_ /*= -1*/) noexcept:
     AnalysisPlugin(name_),
     jetPluginName("JetMET"), jetPlugin(nullptr),
@@ -20,7 +20,7 @@ JetFunctorFilter::JetFunctorFilter(string const &name_,
 {}
 
 
-JetFunctorFilter::JetFunctorFilter(function<bool(Jet const &)> const &selector_,
+JetFunctorFilter::JetFunctorFilter(Selector const &selector_,
   unsigned minNumJets_, unsigned maxNumJets_ /*= -1*/) noexcept:
     AnalysisPlugin("JetFunctorFilter"),
     jetPluginName("JetMET"), jetPlugin(nullptr),
@@ -50,7 +50,7 @@ bool JetFunctorFilter::ProcessEvent()
     // Count the number of jets that pass the selection
     unsigned nPassed = 0;
     
-    for (Jet const &j: jets)
+    for (auto const &j: jets)
         if (selector(j))
             ++nPassed;
     
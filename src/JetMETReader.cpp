@@ -10,19 +10,22 @@ JetMETReader::~JetMETReader() noexcept
 {}
 
 
-std::vector<Jet> const &JetMETReader::GetJets() const
+JetCollection const &JetMETReader::GetJets() const
 {
+    LoadPendingEvent();
     return jets;
 }
 
 
 MET const &JetMETReader::GetMET() const
 {
+    LoadPendingEvent();
     return met;
 }
 
 
 MET const &JetMETReader::GetRawMET() const
 {
+    LoadPendingEvent();
     return rawMET;
 }
@@ -160,20 +160,24 @@ bool JetMETUpdate::ProcessEvent()
     double const rho = puPlugin->GetRho();
     
     
-    // A shift to be applied to MET to account for differences in T1 corrections
-    TLorentzVector metShift;
+    // A shift to be applied to MET to account for differences in T1 corrections. Only transverse
+    //components are needed.
+    double metShiftX = 0., metShiftY = 0.;
     
     
     // Loop over original collection of jets
     for (auto const &srcJet: jetmetPlugin->GetJets())
     {
-        // Copy current jet and recorrect its momentum
-        Jet jet(srcJet);
+        // Recorrect momentum of the current jet. The jet will only be copied into the new
+        //collection if it passes the kinematical selection
+        double const rawSF = srcJet.RawMomentumSF();
+        PtEtaPhiMVector p4(srcJet.CompactP4());
+        double corrFactor = 1.;
         
         if (jetCorrForJets)
         {
-            double const corrFactor = jetCorrForJets->Eval(srcJet, rho, systType, systDirection);
-            jet.SetCorrectedP4(srcJet.RawP4() * corrFactor, 1. / corrFactor);
+            corrFactor = jetCorrForJets->Eval(srcJet, rho, systType, systDirection);
+            p4 *= rawSF * corrFactor;
         }
         
         
@@ -205,7 +209,8 @@ bool JetMETUpdate::ProcessEvent()
         //correction; if it is not available (e.g. user tries to undo the T1 correction), then use
         //the full original correction. Note that at least one of the two full corrections must
         //have been provided.
-        double corrPtForT1 = srcJet.RawP4().Pt();
+        double const rawPt = srcJet.Pt() * rawSF;
+        double corrPtForT1 = rawPt;
         
         if (jetCorrForMETFull)
             corrPtForT1 *= corrFactorMETFull;
@@ -224,40 +229,53 @@ bool JetMETUpdate::ProcessEvent()
         //are ignored.
         if (corrPtForT1 > minPtForT1)
         {
+            // The shift is proportional to the raw transverse momentum of the jet. Accumulate the
+            //net scale factor first and convert it into Cartesian components once.
+            double shiftFactor = 0.;
+            
             // Undo applied T1 corrections
             if (jetCorrForMETOrigL1)
-                metShift -=
-                  srcJet.RawP4() * jetCorrForMETOrigL1->Eval(srcJet, rho);
+                shiftFactor -= jetCorrForMETOrigL1->Eval(srcJet, rho);
             
             if (jetCorrForMETOrigFull)
-                metShift += srcJet.RawP4() * corrFactorMETOrigFull;
+                shiftFactor += corrFactorMETOrigFull;
             
             
             // Apply new T1 corrections
             if (jetCorrForMETL1)
-                metShift +=
-                  srcJet.RawP4() * jetCorrForMETL1->Eval(srcJet, rho);
+                shiftFactor += jetCorrForMETL1->Eval(srcJet, rho);
             
             if (jetCorrForMETFull)
-                metShift -= srcJet.RawP4() * corrFactorMETFull;
+                shiftFactor -= corrFactorMETFull;
+            
+            double const phi = srcJet.Phi();
+            metShiftX += rawPt * shiftFactor * std::cos(phi);
+            metShiftY += rawPt * shiftFactor * std::sin(phi);
         }
         
         
         // Store the new jet if it passes the kinematical selection
-        if (jet.Pt() > minPt and std::abs(jet.Eta()) < maxAbsEta)
-            jets.emplace_back(jet);
+        if (p4.Pt() > minPt and std::abs(p4.Eta()) < maxAbsEta)
+        {
+            std::size_t const index = jets.Add(srcJet);
+            
+            if (jetCorrForJets)
+                jets.SetCorrectedP4(index, p4, 1. / corrFactor);
+        }
     }
     
     
     // Make sure the new collection of jets is ordered in transverse momentum
-    std::sort(jets.rbegin(), jets.rend());
+    jets.SortByPt();
     
     
     // Update MET
-    TLorentzVector const &startingMET = (useRawMET) ?
-      jetmetPlugin->GetRawMET().P4() : jetmetPlugin->GetMET().P4();
-    TLorentzVector updatedMET(startingMET + metShift);
-    met.SetPtEtaPhiM(updatedMET.Pt(), 0., updatedMET.Phi(), 0.);
+    MET const &startingMET = (useRawMET) ?
+      jetmetPlugin->GetRawMET() : jetmetPlugin->GetMET();
+    double const updatedMETX = startingMET.Pt() * std::cos(startingMET.Phi()) + metShiftX;
+    double const updatedMETY = startingMET.Pt() * std::sin(startingMET.Phi()) + metShiftY;
+    met.SetPtEtaPhiM(std::hypot(updatedMETX, updatedMETY), 0.,
+      std::atan2(updatedMETY, updatedMETX), 0.);
     
     
     // Debug information
@@ -24,7 +24,9 @@ bool LeptonFilter::SelectionBin::Fill(Lepton const &lepton)
     
     if (flavour == Lepton::Flavour::Electron)
     {
-        if (fabs(lepton.UserFloat("etaSC")) >= maxAbsEta)
+        static UserPropertyHandle const etaSCHandle = UserPropertyRegistry::GetHandle("etaSC");
+        
+        if (fabs(lepton.UserFloat(etaSCHandle)) >= maxAbsEta)
             return false;
     }
     else
@@ -12,11 +12,13 @@ LeptonReader::~LeptonReader()
 
 std::vector<Lepton> const &LeptonReader::GetLeptons() const
 {
+    LoadPendingEvent();
     return leptons;
 }
 
 
 std::vector<Lepton> const &LeptonReader::GetLooseLeptons() const
 {
+    LoadPendingEvent();
     return looseLeptons;
 }
@@ -19,16 +19,18 @@
 //names
 std::function<double (Lepton const &)> BuildParamExpression(std::string paramName)
 {
+    UserPropertyHandle const etaSCHandle = UserPropertyRegistry::GetHandle("etaSC");
+    
     if (paramName == "pt")
         return [](Lepton const &l){return l.Pt();};
     else if (paramName == "eta")
         return [](Lepton const &l){return l.Eta();};
     else if (paramName == "etaSC")
-        return [](Lepton const &l){return l.UserFloat("etaSC");};
+        return [etaSCHandle](Lepton const &l){return l.UserFloat(etaSCHandle);};
     else if (paramName == "absEta")
         return [](Lepton const &l){return std::abs(l.Eta());};
     else if (paramName == "absEtaSC")
-        return [](Lepton const &l){return std::abs(l.UserFloat("etaSC"));};
+        return [etaSCHandle](Lepton const &l){return std::abs(l.UserFloat(etaSCHandle));};
     else
         throw std::invalid_argument(paramName);
 }
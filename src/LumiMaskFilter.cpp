@@ -15,7 +15,7 @@ using namespace std::literals::string_literals;
 
 LumiMaskFilter::LumiMaskFilter(std::string const &name, std::string const &lumiMaskFileName,
   bool rejectKnownEvent_ /*= true*/):
-    AnalysisPlugin(name),
+    BatchPlugin(name),
     eventIDPluginName("EventID"), eventIDPlugin(nullptr),
     rejectKnownEvent(rejectKnownEvent_)
 {
@@ -25,7 +25,7 @@ LumiMaskFilter::LumiMaskFilter(std::string const &name, std::string const &lumiM
 
 LumiMaskFilter::LumiMaskFilter(std::string const &lumiMaskFileName,
   bool rejectKnownEvent_ /*= true*/):
-    AnalysisPlugin("LumiMaskFilter"),
+    BatchPlugin("LumiMaskFilter"),
     eventIDPluginName("EventID"), eventIDPlugin(nullptr),
     rejectKnownEvent(rejectKnownEvent_)
 {
@@ -50,6 +50,23 @@ Plugin *LumiMaskFilter::Clone() const
 }
 
 
+std::string LumiMaskFilter::GetCacheKey() const
+{
+    std::ostringstream key;
+    key << "LumiMaskFilter:" << rejectKnownEvent;
+    
+    for (auto const &run: *lumiMask)
+    {
+        key << ";" << run.first << ":";
+        
+        for (auto const &range: run.second)
+            key << range.first << "-" << range.second << ",";
+    }
+    
+    return key.str();
+}
+
+
 void LumiMaskFilter::SetEventIDPluginName(std::string const &name)
 {
     eventIDPluginName = name;
@@ -60,6 +77,10 @@ void LumiMaskFilter::LoadLumiMask(std::string const &lumiMaskFileName)
 {
     using namespace std;
     
+    // The mask is filled here and then shared among clones in read-only mode
+    auto newLumiMask = make_shared<map<unsigned long, vector<lumiRange_t>>>();
+    auto &lumiMask = *newLumiMask;
+    
     // Open the JSON file
     ifstream lumiMaskFile(lumiMaskFileName);
     
@@ -225,34 +246,65 @@ void LumiMaskFilter::LoadLumiMask(std::string const &lumiMaskFileName)
         cout << endl;
     }
     #endif
+    
+    
+    this->lumiMask = newLumiMask;
+}
+
+
+bool LumiMaskFilter::IsInMask(EventID const &id) const
+{
+    auto const runIt = lumiMask->find(id.Run());
+    
+    if (runIt == lumiMask->end())
+        return false;
+    
+    auto const &lumiRanges = runIt->second;
+    unsigned long const lumiNumber = id.LumiBlock();
+    
+    // Find first lumi range whose upper boundary is larger or equal lumi number of the current
+    //event. This is thus the only lumi range that could include the current event
+    auto const rangeIt = std::lower_bound(lumiRanges.begin(), lumiRanges.end(), lumiNumber,
+      [](lumiRange_t const &range, unsigned long lumi){return (range.second < lumi);});
+    
+    // Then compare lumi number to the lower boundary of the range
+    return (rangeIt != lumiRanges.end() and rangeIt->first <= lumiNumber);
 }
 
 
 bool LumiMaskFilter::ProcessEvent()
 {
-     // Search for ID of the current event in the vector
-    auto const &id = eventIDPlugin->GetEventID();
-    bool eventFound = false;
+    bool const eventFound = IsInMask(eventIDPlugin->GetEventID());
+    return (rejectKnownEvent) ? not eventFound : eventFound;
+}
+
+
+void LumiMaskFilter::ProcessBlock(unsigned maxEvents, std::vector<char> &mask)
+{
+    eventIDPlugin->PeekEventIDs(maxEvents, blockEventIDs);
+    mask.resize(blockEventIDs.size());
+    
     
-    auto const runIt = lumiMask.find(id.Run());
+    // Consecutive events usually belong to the same luminosity section. Exploit this to avoid
+    //repeating the look-up
+    unsigned long curRun = 0, curLumi = 0;
+    bool curDecision = false, lookedUp = false;
     
-    if (runIt != lumiMask.end())
+    for (unsigned i = 0; i < blockEventIDs.size(); ++i)
     {
-        auto const &lumiRanges = runIt->second;
-        unsigned long const lumiNumber = id.LumiBlock();
+        auto const &id = blockEventIDs[i];
         
-        // Find first lumi range whose upper boundary is larger or equal lumi number of the current
-        //event. This is thus the only lumi range that could include the current event
-        auto const rangeIt = std::lower_bound(lumiRanges.begin(), lumiRanges.end(), lumiNumber,
-          [](lumiRange_t const &range, unsigned long lumi){return (range.second < lumi);});
+        if (not lookedUp or id.Run() != curRun or id.LumiBlock() != curLumi)
+        {
+            curRun = id.Run();
+            curLumi = id.LumiBlock();
+            bool const eventFound = IsInMask(id);
+            curDecision = (rejectKnownEvent) ? not eventFound : eventFound;
+            lookedUp = true;
+        }
         
-        // Then compare lumi number to the lower boundary of the range
-        if (rangeIt != lumiRanges.end() and rangeIt->first <= lumiNumber)
-            eventFound = true;
+        mask[i] = curDecision;
     }
-    
-    
-    return (rejectKnownEvent) ? not eventFound : eventFound;
 }
 
 
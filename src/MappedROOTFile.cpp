@@ -0,0 +1,178 @@
+#include <mensura/MappedROOTFile.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+MappedROOTFile::MappedROOTFile(std::string const &path):
+    TFile(path.c_str(), "READ"),
+    mappedData(nullptr), mappedSize(0), position(0)
+{
+    // The header of the file has already been read by the constructor of TFile using the file
+    //descriptor, which is reused to set up the mapping
+    if (IsZombie() or fD < 0)
+        return;
+    
+    struct stat fileStat;
+    
+    if (fstat(fD, &fileStat) != 0 or fileStat.st_size <= 0)
+        return;
+    
+    void *data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fD, 0);
+    
+    if (data == MAP_FAILED)
+        return;
+    
+    mappedData = static_cast<char const *>(data);
+    mappedSize = fileStat.st_size;
+    
+    
+    // Keep the position consistent with the file descriptor in case ROOT relies on the last seek
+    //performed while the header was read
+    Long64_t const curPosition = TFile::SysSeek(fD, 0, SEEK_CUR);
+    position = (curPosition >= 0) ? curPosition : 0;
+}
+
+
+MappedROOTFile::~MappedROOTFile()
+{
+    // Close the file here since the destructor of TFile would not call the reimplemented SysClose
+    Close();
+    Unmap();
+}
+
+
+bool MappedROOTFile::IsLocalPath(std::string const &path)
+{
+    return (path.find("://") == std::string::npos or path.compare(0, 7, "file://") == 0);
+}
+
+
+bool MappedROOTFile::IsMapped() const
+{
+    return (mappedData != nullptr);
+}
+
+
+Bool_t MappedROOTFile::ReadBufferAsync(Long64_t offset, Int_t len)
+{
+    if (not mappedData)
+        return TFile::ReadBufferAsync(offset, len);
+    
+    // A request beyond the end of the file is not an error. Reporting it as such would make
+    //TTreeCache disable asynchronous reading
+    if (offset < 0 or offset >= mappedSize)
+        return kFALSE;
+    
+    return AdviseWillNeed(offset, offset + len);
+}
+
+
+Bool_t MappedROOTFile::ReadBuffers(char *buffer, Long64_t *positions, Int_t *lengths,
+  Int_t nBuffers)
+{
+    if (mappedData and nBuffers > 0)
+    {
+        // Segments requested by TTreeCache are sorted, but do not rely on this
+        Long64_t begin = positions[0], end = positions[0] + lengths[0];
+        
+        for (Int_t i = 1; i < nBuffers; ++i)
+        {
+            begin = std::min(begin, positions[i]);
+            end = std::max(end, positions[i] + lengths[i]);
+        }
+        
+        // The hint only affects performance, and thus its failure is ignored
+        AdviseWillNeed(begin, end);
+    }
+    
+    return TFile::ReadBuffers(buffer, positions, lengths, nBuffers);
+}
+
+
+Int_t MappedROOTFile::SysClose(Int_t fd)
+{
+    Unmap();
+    return TFile::SysClose(fd);
+}
+
+
+Int_t MappedROOTFile::SysRead(Int_t fd, void *buffer, Int_t len)
+{
+    if (not mappedData)
+        return TFile::SysRead(fd, buffer, len);
+    
+    if (len <= 0 or position >= mappedSize)
+        return 0;
+    
+    Int_t const nBytes = std::min<Long64_t>(len, mappedSize - position);
+    std::memcpy(buffer, mappedData + position, nBytes);
+    position += nBytes;
+    
+    return nBytes;
+}
+
+
+Long64_t MappedROOTFile::SysSeek(Int_t fd, Long64_t offset, Int_t whence)
+{
+    if (not mappedData)
+        return TFile::SysSeek(fd, offset, whence);
+    
+    Long64_t newPosition;
+    
+    switch (whence)
+    {
+        case SEEK_SET:
+            newPosition = offset;
+            break;
+        
+        case SEEK_CUR:
+            newPosition = position + offset;
+            break;
+        
+        case SEEK_END:
+            newPosition = mappedSize + offset;
+            break;
+        
+        default:
+            return -1;
+    }
+    
+    if (newPosition < 0)
+        return -1;
+    
+    position = newPosition;
+    return position;
+}
+
+
+bool MappedROOTFile::AdviseWillNeed(Long64_t begin, Long64_t end) const
+{
+    begin = std::max<Long64_t>(begin, 0);
+    end = std::min(end, mappedSize);
+    
+    if (begin >= end)
+        return false;
+    
+    // The start of the range given to madvise must be aligned with a page
+    static long const pageSize = sysconf(_SC_PAGESIZE);
+    Long64_t const alignedBegin = begin - begin % pageSize;
+    
+    return (madvise(const_cast<char *>(mappedData) + alignedBegin, end - alignedBegin,
+      MADV_WILLNEED) != 0);
+}
+
+
+void MappedROOTFile::Unmap()
+{
+    if (mappedData)
+    {
+        munmap(const_cast<char *>(mappedData), mappedSize);
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+}
@@ -0,0 +1,298 @@
+#include <mensura/PECReader/PECEventIndexCache.hpp>
+
+#include <mensura/Dataset.hpp>
+#include <mensura/Logger.hpp>
+#include <mensura/Processor.hpp>
+#include <mensura/ROOTLock.hpp>
+#include <mensura/PECReader/PECInputData.hpp>
+
+#include <TEntryList.h>
+#include <TFile.h>
+
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+
+namespace fs = std::filesystem;
+using namespace logging;
+
+
+PECEventIndexCache::PECEventIndexCache(std::string const &name,
+  std::initializer_list<std::string> const &filterNames_):
+    AnalysisPlugin(name),
+    inputDataPluginName("InputData"), inputDataPlugin(nullptr),
+    filterNames(filterNames_),
+    configHash(0),
+    firstEntry(0), lastEntry(0),
+    recording(false)
+{}
+
+
+PECEventIndexCache::PECEventIndexCache(std::initializer_list<std::string> const &filterNames_):
+    PECEventIndexCache("EventIndexCache", filterNames_)
+{}
+
+
+PECEventIndexCache::PECEventIndexCache(PECEventIndexCache const &src):
+    AnalysisPlugin(src),
+    inputDataPluginName(src.inputDataPluginName), inputDataPlugin(nullptr),
+    filterNames(src.filterNames),
+    directory(src.directory),
+    configHash(0),
+    firstEntry(0), lastEntry(0),
+    recording(false)
+{}
+
+
+PECEventIndexCache::~PECEventIndexCache() noexcept
+{}
+
+
+void PECEventIndexCache::BeginRun(Dataset const &dataset)
+{
+    // Save pointer to the plugin providing access to input data
+    inputDataPlugin = dynamic_cast<PECInputData const *>(GetDependencyPlugin(inputDataPluginName));
+    
+    firstEntry = dataset.GetFirstEntry();
+    lastEntry = dataset.GetLastEntry();
+    
+    
+    // Combine descriptions of all filters. They have already been set up for the new dataset
+    std::string config;
+    
+    for (auto const &filterName: filterNames)
+    {
+        auto const *filter = dynamic_cast<AnalysisPlugin const *>(GetDependencyPlugin(filterName));
+        std::string const filterKey((filter) ? filter->GetCacheKey() : "");
+        
+        if (filterKey.empty())
+        {
+            std::ostringstream message;
+            message << "PECEventIndexCache[\"" << GetName() << "\"]::BeginRun: Decisions of " <<
+              "plugin \"" << filterName << "\" cannot be cached.";
+            throw std::logic_error(message.str());
+        }
+        
+        config += filterName + "{" + filterKey + "}";
+    }
+    
+    configHash = Hash(config);
+}
+
+
+Plugin *PECEventIndexCache::Clone() const
+{
+    return new PECEventIndexCache(*this);
+}
+
+
+void PECEventIndexCache::EndRun()
+{
+    // The dataset has been processed completely, so the list for the last input file is final
+    if (recording)
+        WriteCache();
+    
+    curFilePath.clear();
+    recording = false;
+    acceptedEntries.clear();
+    cachedFiles.clear();
+}
+
+
+bool PECEventIndexCache::LookUp(fs::path const &inputFilePath,
+  std::vector<unsigned long> &entries) const
+{
+    entries.clear();
+    
+    std::string const key(BuildKey(inputFilePath));
+    
+    if (key.empty())
+        return false;
+    
+    fs::path const cachePath(GetCachePath(inputFilePath, key));
+    std::error_code errorCode;
+    
+    if (not fs::exists(cachePath, errorCode))
+        return false;
+    
+    
+    // Read the list and detach it from the file
+    ROOTLock::Lock();
+    std::unique_ptr<TFile> cacheFile(TFile::Open(cachePath.c_str()));
+    std::unique_ptr<TEntryList> list;
+    
+    if (cacheFile and not cacheFile->IsZombie())
+    {
+        list.reset(dynamic_cast<TEntryList *>(cacheFile->Get("EventIndex")));
+        
+        if (list)
+            list->SetDirectory(nullptr);
+    }
+    
+    cacheFile.reset();
+    ROOTLock::Unlock();
+    
+    
+    // The full key is stored in the title of the list, which protects against collisions of
+    //hashes in file names
+    if (not list or key != list->GetTitle())
+        return false;
+    
+    for (Long64_t i = 0; i < list->GetN(); ++i)
+        entries.emplace_back(list->GetEntry(i));
+    
+    cachedFiles.insert(inputFilePath);
+    return true;
+}
+
+
+void PECEventIndexCache::SetDirectory(std::string const &directory_)
+{
+    directory = directory_;
+    
+    if (not directory.empty())
+        fs::create_directories(directory);
+}
+
+
+std::string PECEventIndexCache::BuildKey(fs::path const &inputFilePath) const
+{
+    std::error_code errorCode;
+    fs::path const absPath(fs::absolute(inputFilePath, errorCode));
+    
+    if (errorCode)
+        return "";
+    
+    auto const fileSize = fs::file_size(absPath, errorCode);
+    
+    if (errorCode)
+        return "";
+    
+    auto const modificationTime = fs::last_write_time(absPath, errorCode);
+    
+    if (errorCode)
+        return "";
+    
+    std::ostringstream key;
+    key << absPath.string() << ";" << fileSize << ";" <<
+      modificationTime.time_since_epoch().count() << ";" << firstEntry << "-" << lastEntry <<
+      ";" << std::hex << configHash;
+    
+    return key.str();
+}
+
+
+fs::path PECEventIndexCache::GetCachePath(fs::path const &inputFilePath,
+  std::string const &key) const
+{
+    std::ostringstream fileName;
+    fileName << inputFilePath.stem().string() << "_" << std::hex << std::setw(16) <<
+      std::setfill('0') << Hash(key) << ".evtidx.root";
+    
+    fs::path const cacheDirectory((directory.empty()) ?
+      fs::absolute(inputFilePath).parent_path() : fs::path(directory));
+    return cacheDirectory / fileName.str();
+}
+
+
+std::uint64_t PECEventIndexCache::Hash(std::string const &text)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    
+    for (unsigned char const c: text)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    
+    return hash;
+}
+
+
+bool PECEventIndexCache::ProcessEvent()
+{
+    // Check if a new input file has been opened. If so, all events from the previous file have
+    //been seen, and its list can be saved
+    auto const &filePath = inputDataPlugin->GetCurrentFilePath();
+    
+    if (filePath != curFilePath)
+    {
+        if (recording)
+            WriteCache();
+        
+        curFilePath = filePath;
+        recording = (cachedFiles.count(curFilePath) == 0);
+        acceptedEntries.clear();
+    }
+    
+    
+    // Record the event if it has been accepted by all filters
+    if (recording)
+    {
+        auto const &master = GetMaster();
+        bool accepted = true;
+        
+        for (auto const &filterName: filterNames)
+        {
+            if (not master.HasPassed(filterName))
+            {
+                accepted = false;
+                break;
+            }
+        }
+        
+        if (accepted)
+            acceptedEntries.emplace_back(inputDataPlugin->GetCurrentEntry());
+    }
+    
+    
+    return true;
+}
+
+
+void PECEventIndexCache::WriteCache() const
+{
+    std::string const key(BuildKey(curFilePath));
+    
+    if (key.empty())
+        return;
+    
+    
+    // Write into a temporary file first and then rename it so that an incomplete cache file is
+    //never picked up
+    fs::path const cachePath(GetCachePath(curFilePath, key));
+    fs::path const tmpPath(cachePath.string() + ".part");
+    bool written = false;
+    
+    ROOTLock::Lock();
+    std::unique_ptr<TFile> cacheFile(TFile::Open(tmpPath.c_str(), "recreate"));
+    
+    if (cacheFile and not cacheFile->IsZombie())
+    {
+        std::unique_ptr<TEntryList> list(new TEntryList("EventIndex", key.c_str()));
+        list->SetDirectory(nullptr);
+        
+        for (auto const &entry: acceptedEntries)
+            list->Enter(entry);
+        
+        written = (cacheFile->WriteTObject(list.get()) > 0);
+    }
+    
+    cacheFile.reset();
+    ROOTLock::Unlock();
+    
+    std::error_code errorCode;
+    
+    if (written)
+        fs::rename(tmpPath, cachePath, errorCode);
+    
+    if (not written or errorCode)
+    {
+        fs::remove(tmpPath, errorCode);
+        logger << "Warning in PECEventIndexCache[\"" << GetName() << "\"]: Failed to write " <<
+          "cache file " << cachePath << "." << eom;
+    }
+}
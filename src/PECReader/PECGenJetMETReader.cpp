@@ -73,6 +73,18 @@ void PECGenJetMETReader::SetSelection(double minPt_, double maxAbsEta_)
 
 
 bool PECGenJetMETReader::ProcessEvent()
+{
+    // Postpone reading of the input tree until jets and MET are requested by another plugin
+    SetEventPending();
+    
+    
+    // Since this reader does not have access to the input file, it does not know when there are
+    //no more events in the dataset and thus always returns true
+    return true;
+}
+
+
+void PECGenJetMETReader::UnpackEvent()
 {
     // Clear vector with jets from the previous event
     jets.clear();
@@ -85,8 +97,7 @@ bool PECGenJetMETReader::ProcessEvent()
     // Process jets in the current event
     for (pec::GenJet const &j: bfJets)
     {
-        TLorentzVector p4;
-        p4.SetPtEtaPhiM(j.Pt(), j.Eta(), j.Phi(), j.M());
+        PtEtaPhiMVector p4(j.Pt(), j.Eta(), j.Phi(), j.M());
         
         
         // User-defined selection on momentum
@@ -110,11 +121,5 @@ bool PECGenJetMETReader::ProcessEvent()
     // Copy MET. There is only one element in the collection
     pec::Candidate const &srcMET = bfMETs.at(0);
     met.SetPtEtaPhiM(srcMET.Pt(), 0., srcMET.Phi(), 0.);
-    
-    
-    
-    // Since this reader does not have access to the input file, it does not know when there are
-    //no more events in the dataset and thus always returns true
-    return true;
 }
 
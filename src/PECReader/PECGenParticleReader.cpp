@@ -52,6 +52,18 @@ Plugin *PECGenParticleReader::Clone() const
 
 
 bool PECGenParticleReader::ProcessEvent()
+{
+    // Postpone reading of the input tree until particles are requested by another plugin
+    SetEventPending();
+    
+    
+    // Since this reader does not have access to the input file, it does not know when there are
+    //no more events in the dataset and thus always returns true
+    return true;
+}
+
+
+void PECGenParticleReader::UnpackEvent()
 {
     // Clear the vector with particles from the previous event
     particles.clear();
@@ -61,14 +73,15 @@ bool PECGenParticleReader::ProcessEvent()
     inputDataPlugin->ReadEventFromTree(treeName);
     
     
-    // Construct particles in the standard format of the framework
+    // Construct particles in the standard format of the framework. Their mother-daughter
+    //relations are allocated from the event arena, which has been reset at the start of the event
     particles.reserve(bfParticles.size());
+    auto *arena = GetMaster().GetEventArena();
     
     for (pec::GenParticle const &p: bfParticles)
     {
-        TLorentzVector p4;
-        p4.SetPtEtaPhiM(p.Pt(), p.Eta(), p.Phi(), p.M());
-        particles.emplace_back(p4, p.PdgId());
+        PtEtaPhiMVector p4(p.Pt(), p.Eta(), p.Phi(), p.M());
+        particles.emplace_back(p4, p.PdgId(), arena);
     }
     
     
@@ -92,9 +105,4 @@ bool PECGenParticleReader::ProcessEvent()
             particles.at(iMother2).AddDaughter(&particles.at(i));
         }
     }
-    
-    
-    // Since this reader does not have access to the input file, it does not know when there are
-    //no more events in the dataset and thus always returns true
-    return true;
 }
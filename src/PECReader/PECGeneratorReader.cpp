@@ -51,14 +51,16 @@ void PECGeneratorReader::BeginRun(Dataset const &dataset)
     
     // Set up the tree with generator information. Only some attributes of the PEC object are read
     inputDataPlugin->LoadTree(treeName);
+    std::vector<std::string> branchNames{"processId", "nominalWeight", "pdfX*", "pdfId",
+      "pdfQScale"};
+    
+    if (readAltWeights)
+        branchNames.emplace_back("altLheWeights");
+    
+    inputDataPlugin->RequestBranches(treeName, branchNames);
     TTree *tree = inputDataPlugin->ExposeTree(treeName);
     
     ROOTLock::Lock();
-    if (not readAltWeights)
-        tree->SetBranchStatus("altLheWeights", false);
-
-    tree->SetBranchStatus("altPsWeights", false);
-    
     tree->SetBranchAddress("generator", &bfGeneratorP);
     ROOTLock::Unlock();
 }
@@ -72,6 +74,8 @@ Plugin *PECGeneratorReader::Clone() const
 
 double PECGeneratorReader::GetAltWeight(unsigned index) const
 {
+    LoadPendingEvent();
+    
     if (not readAltWeights)
     {
         std::ostringstream message;
@@ -95,12 +99,15 @@ double PECGeneratorReader::GetAltWeight(unsigned index) const
 
 double PECGeneratorReader::GetNominalWeight() const
 {
+    LoadPendingEvent();
     return bfGeneratorP->NominalWeight();
 }
 
 
 unsigned PECGeneratorReader::GetNumAltWeights() const
 {
+    LoadPendingEvent();
+    
     if (not readAltWeights)
         return 0;
     else
@@ -110,24 +117,28 @@ unsigned PECGeneratorReader::GetNumAltWeights() const
 
 std::pair<int, int> PECGeneratorReader::GetPdfPart() const
 {
+    LoadPendingEvent();
     return {bfGeneratorP->PdfId(0), bfGeneratorP->PdfId(1)};
 }
 
 
 std::pair<double, double> PECGeneratorReader::GetPdfX() const
 {
+    LoadPendingEvent();
     return {bfGeneratorP->PdfX(0), bfGeneratorP->PdfX(1)};
 }
 
 
 int PECGeneratorReader::GetProcessID() const
 {
+    LoadPendingEvent();
     return bfGeneratorP->ProcessId();
 }
 
 
 double PECGeneratorReader::GetScale() const
 {
+    LoadPendingEvent();
     return bfGeneratorP->PdfQScale();
 }
 
@@ -140,11 +151,18 @@ void PECGeneratorReader::RequestAltWeights(bool on /*= true*/)
 
 bool PECGeneratorReader::ProcessEvent()
 {
-    // Read the tree
-    inputDataPlugin->ReadEventFromTree(treeName);
+    // Postpone reading of the input tree until generator information is requested by another plugin
+    SetEventPending();
     
     
     // Since this reader does not have access to the input file, it does not know when there are
     //no more events in the dataset and thus always returns true
     return true;
 }
+
+
+void PECGeneratorReader::UnpackEvent()
+{
+    // Read the tree
+    inputDataPlugin->ReadEventFromTree(treeName);
+}
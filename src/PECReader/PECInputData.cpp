@@ -1,13 +1,26 @@
 #include <mensura/PECReader/PECInputData.hpp>
 
 #include <mensura/Logger.hpp>
+#include <mensura/MappedROOTFile.hpp>
+#include <mensura/Processor.hpp>
 #include <mensura/ROOTLock.hpp>
+#include <mensura/PECReader/PECEventIndexCache.hpp>
 
 #include "EventID.hpp"
 
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <TBranch.h>
+#include <TROOT.h>
+#include <TTreeCache.h>
+#include <TTreeCacheUnzip.h>
+
 #include <algorithm>
+#include <atomic>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 
@@ -16,41 +29,125 @@ using namespace logging;
 using namespace std::string_literals;
 
 
+PECInputData::CacheStat::CacheStat():
+    bytesRead(0), numReadCalls(0),
+    weightedHitRate(0.)
+{}
+
+
+unsigned long PECInputData::EventIDBlock::Size() const
+{
+    return runs.size();
+}
+
+
 PECInputData::PECInputData(std::string const name):
     EventIDReader(name),
     nextFileIt(inputFiles.end()),
     eventIDTreeName("pecEventID/EventID"),
-    nEvents(0), nextEvent(0),
-    eventIDTree(nullptr), bfEventIDP(nullptr)
+    memoryMapping(false),
+    readAhead(false), unzipBufferRelSize(-1.f),
+    cacheSize(-1), cacheLearnEntries(100), printCacheStat(false),
+    branchRequestsPending(false), allBranchesRequested(false), printBranchUsage(false),
+    prefetchNextFile(false), parallelUnpacking(false),
+    parallelReadEntry(-1),
+    entryListName("SkimEntries"),
+    eventIndexCache(nullptr), entriesSelected(true), useSelectedEntries(false),
+    nextSelected(0),
+    nEvents(0), nextEvent(0), endEvent(0),
+    firstEntry(0), lastEntry(0),
+    eventIDTree(nullptr), bfEventIDP(nullptr),
+    posInBlock(0), curEntry(0),
+    prefetchingNextDataset(false)
 {}
 
 
 PECInputData::~PECInputData()
-{}
+{
+    // A file for the next dataset might still be being opened if this was the last dataset
+    DiscardPrefetchedFile();
+}
 
 
 void PECInputData::BeginRun(Dataset const &dataset)
 {
     // Copy information about files in the dataset and set up the iterator
     auto const &srcFiles = dataset.GetFiles();
-    // std::copy(srcFiles.begin(), srcFiles.end(), std::back_inserter(inputFiles));
-    inputFiles.emplace_back(srcFiles.front());
+    std::copy(srcFiles.begin(), srcFiles.end(), std::back_inserter(inputFiles));
     nextFileIt = inputFiles.begin();
     
-    // Currently the class only supports datasets with a single file (see documentation for the
-    //class). This is why only first file is copied to the list of input files. Print a warning
-    //about this
-    if (srcFiles.size() > 1)
-        logger << "Error in PECInputData: Currently the class only supports datasets " <<
-          "containing a single file, but the given dataset consists of " << srcFiles.size() <<
-          " files. Only first file (" << *nextFileIt << ") will be processed." << eom;
+    firstEntry = dataset.GetFirstEntry();
+    lastEntry = dataset.GetLastEntry();
     
     
     // Report an error is the dataset is empty. This does not pose a problem for PECInputData, but
     //will cause a crash if some plugin attempts to read a tree with LoadTree
     if (srcFiles.size() == 0)
+    {
         logger << "Error in PECInputData: Empty dataset is given to plugin \"" << GetName() <<
           "\"." << eom;
+        return;
+    }
+    
+    
+    // Read the entry list if requested
+    if (not entryListPath.empty())
+    {
+        std::string path(entryListPath);
+        auto const substitutionPos = path.find("%");
+        
+        if (substitutionPos != std::string::npos)
+            path.replace(substitutionPos, 1, srcFiles.front().stem());
+        
+        ROOTLock::Lock();
+        std::unique_ptr<TFile> entryListFile(TFile::Open(path.c_str()));
+        
+        if (entryListFile and not entryListFile->IsZombie())
+        {
+            entryList.reset(dynamic_cast<TEntryList *>(entryListFile->Get(entryListName.c_str())));
+            
+            // Detach the list from the file so that it survives when the file is closed
+            if (entryList)
+                entryList->SetDirectory(nullptr);
+        }
+        
+        entryListFile.reset();
+        ROOTLock::Unlock();
+        
+        if (not entryList)
+            throw std::runtime_error("PECInputData::BeginRun: Failed to read entry list \""s +
+              entryListName + "\" from file " + path + ".");
+    }
+    
+    if (entryList and not eventIndexCacheName.empty())
+        throw std::logic_error("PECInputData::BeginRun: An entry list and an event index cache "
+          "cannot be used at the same time.");
+    
+    
+    // The first file of the dataset might have been opened in advance, while the previous dataset
+    //was being processed. Discard it if the dataset is not the expected one
+    if (nextInputFile.valid() and prefetchedFilePath != srcFiles.front())
+        DiscardPrefetchedFile();
+    
+    prefetchingNextDataset = false;
+    
+    
+    // Parallel decompression in read caches and parallel reading of trees run in the thread pool
+    //of ROOT's implicit multithreading. Without it, TTreeCacheUnzip decompresses baskets
+    //synchronously. The pool is created under the lock since other threads might be trying to do
+    //the same
+    if ((readAhead and cacheSize != 0) or parallelUnpacking)
+    {
+        ROOTLock::Lock();
+        
+        if (not ROOT::IsImplicitMTEnabled())
+            ROOT::EnableImplicitMT();
+        
+        ROOTLock::Unlock();
+    }
+    
+    if (parallelUnpacking and not executor)
+        executor.reset(new ROOT::TThreadExecutor);
     
     
     // Open the first input file
@@ -60,16 +157,120 @@ void PECInputData::BeginRun(Dataset const &dataset)
 
 Plugin *PECInputData::Clone() const
 {
-    return new PECInputData(GetName());
+    PECInputData *clone = new PECInputData(GetName());
+    clone->SetMemoryMapping(memoryMapping);
+    clone->SetReadAhead(readAhead, unzipBufferRelSize);
+    clone->SetReadCache(cacheSize, cacheLearnEntries, printCacheStat);
+    clone->SetPrefetchNextFile(prefetchNextFile);
+    clone->SetParallelUnpacking(parallelUnpacking);
+    clone->SetPrintBranchUsage(printBranchUsage);
+    clone->SetEntryList(entryListPath, entryListName);
+    clone->SetEventIndexCache(eventIndexCacheName);
+    return clone;
 }
 
 
 void PECInputData::EndRun()
 {
-    // Clear collections of input files and loaded trees. Other attributes of the class will be
-    //initialized correctly when the next dataset is opened
+    // Discard the file that is being prefetched unless it belongs to the next dataset. Otherwise
+    //this can only happen if processing of the dataset has been interrupted
+    if (not prefetchingNextDataset)
+        DiscardPrefetchedFile();
+    
+    
+    // Print statistics of reading
+    RecordCacheStat();
+    
+    if (printCacheStat and not cacheStat.empty())
+    {
+        std::ostringstream message;
+        message << "Read caches in plugin \"" << GetName() << "\":\n" << std::setw(30) <<
+          std::left << "  Tree" << std::right << std::setw(14) << "MB read" << std::setw(14) <<
+          "Read calls" << std::setw(14) << "Hit rate" << std::fixed << std::setprecision(1);
+        
+        for (auto const &p: cacheStat)
+        {
+            auto const &stat = p.second;
+            message << "\n  " << std::setw(28) << std::left << p.first << std::right <<
+              std::setw(14) << stat.bytesRead / 1048576. << std::setw(14) << stat.numReadCalls <<
+              std::setw(13) <<
+              ((stat.bytesRead > 0) ? 100. * stat.weightedHitRate / stat.bytesRead : 0.) << "%";
+        }
+        
+        logger << message.str() << eom;
+    }
+    
+    cacheStat.clear();
+    
+    
+    // Print usage of branches. Sizes are taken from the last input file
+    if (printBranchUsage and not loadedTrees.empty())
+    {
+        std::ostringstream message;
+        message << "Branch usage in plugin \"" << GetName() << "\":" << std::fixed <<
+          std::setprecision(1);
+        
+        ROOTLock::Lock();
+        
+        for (auto const &p: loadedTrees)
+        {
+            std::vector<std::pair<std::string, double>> enabledLeaves;
+            double totalBytes = 0., enabledBytes = 0.;
+            
+            for (TBranch *branch: ListBranches(p.second.get()))
+            {
+                if (branch->GetListOfBranches()->GetEntriesFast() > 0)
+                    continue;
+                
+                double const bytes = branch->GetTotBytes();
+                totalBytes += bytes;
+                
+                if (not branch->TestBit(TBranch::kDoNotProcess))
+                {
+                    enabledBytes += bytes;
+                    enabledLeaves.emplace_back(branch->GetName(), bytes);
+                }
+            }
+            
+            auto share = [totalBytes](double bytes)
+              {return (totalBytes > 0.) ? 100. * bytes / totalBytes : 0.;};
+            
+            message << "\n  Tree \"" << p.first << "\": " << enabledLeaves.size() <<
+              " leaves read, " << share(enabledBytes) << "% of " << totalBytes / 1048576. <<
+              " MB uncompressed";
+            
+            for (auto const &leaf: enabledLeaves)
+                message << "\n    " << std::setw(40) << std::left << leaf.first << std::right <<
+                  std::setw(7) << share(leaf.second) << "%";
+        }
+        
+        ROOTLock::Unlock();
+        logger << message.str() << eom;
+    }
+    
+    requestedBranches.clear();
+    branchRequestsPending = false;
+    allBranchesRequested = false;
+    
+    
+    // Clear collections of input files and loaded trees and reset counters of events, which might
+    //not have been exhausted if processing of the dataset has been interrupted. Other attributes of
+    //the class will be initialized correctly when the next dataset is opened
     inputFiles.clear();
+    nextEvent = endEvent = 0;
+    entriesSelected = true;
+    useSelectedEntries = false;
+    selectedEntries.clear();
+    nextSelected = 0;
+    ClearEventIDBlock();
+    eventIndexCache = nullptr;
+    
+    ROOTLock::Lock();
+    prefetchedTrees.clear();
     loadedTrees.clear();
+    curInputFile.reset();
+    entryList.reset();
+    ROOTLock::Unlock();
 }
 
 
@@ -85,6 +286,47 @@ TTree *PECInputData::ExposeTree(std::string const &name) const
 }
 
 
+PECInputData::EventIDBlock const &PECInputData::GetEventIDBlock() const
+{
+    return eventIDBlock;
+}
+
+
+unsigned long PECInputData::GetPosInEventIDBlock() const
+{
+    return posInBlock;
+}
+
+
+std::string const &PECInputData::GetEventIDTreeName() const
+{
+    return eventIDTreeName;
+}
+
+
+unsigned long PECInputData::GetCurrentEntry() const
+{
+    return curEntry;
+}
+
+
+std::filesystem::path const &PECInputData::GetCurrentFilePath() const
+{
+    return *std::prev(nextFileIt);
+}
+
+
+std::vector<std::string> PECInputData::ListLoadedTrees() const
+{
+    std::vector<std::string> names;
+    
+    for (auto const &p: loadedTrees)
+        names.emplace_back(p.first);
+    
+    return names;
+}
+
+
 PECInputData::LoadTreeStatus PECInputData::LoadTree(std::string const &name) const
 {
     // Make sure the tree has not been loaded already
@@ -100,15 +342,43 @@ PECInputData::LoadTreeStatus PECInputData::LoadTree(std::string const &name) con
     }
     
     
-    // Read the tree from the input file
-    ROOTLock::Lock();
-    TTree *tree = dynamic_cast<TTree *>(curInputFile->Get(name.c_str()));
-    ROOTLock::Unlock();
+    // Take the tree if it has been read in advance. Its read cache has already been set up
+    auto const prefetchedIt = prefetchedTrees.find(name);
+    TTree *tree;
     
-    if (tree)
-        loadedTrees[name] = std::unique_ptr<TTree>(tree);
+    if (prefetchedIt != prefetchedTrees.end())
+    {
+        tree = prefetchedIt->second.get();
+        loadedTrees[name] = std::move(prefetchedIt->second);
+        prefetchedTrees.erase(prefetchedIt);
+    }
     else
-        return LoadTreeStatus::NotFound;
+    {
+        // Read the tree from the input file
+        ROOTLock::Lock();
+        tree = dynamic_cast<TTree *>(curInputFile->Get(name.c_str()));
+        ROOTLock::Unlock();
+        
+        if (tree)
+            loadedTrees[name] = std::unique_ptr<TTree>(tree);
+        else
+            return LoadTreeStatus::NotFound;
+        
+        
+        // Set up a read cache
+        ROOTLock::Lock();
+        SetUpReadCache(tree);
+        ROOTLock::Unlock();
+    }
+    
+    
+    // Keep the new tree complete if this has been requested. The request is applied before the
+    //next event is read
+    if (allBranchesRequested)
+    {
+        requestedBranches[name].insert("*");
+        branchRequestsPending = true;
+    }
     
     
     // Starting from the second loaded tree, make sure that the tree contains the same number of
@@ -127,63 +397,614 @@ PECInputData::LoadTreeStatus PECInputData::LoadTree(std::string const &name) con
 }
 
 
-void PECInputData::ReadEventFromTree(std::string const &name) const
+void PECInputData::PeekEventIDs(unsigned maxEvents, std::vector<EventID> &eventIDs) const
+{
+    eventIDs.assign(1, eventID);
+    
+    
+    // Take IDs of subsequent events from the current block
+    unsigned long const numRequested = std::max(maxEvents, 1u);
+    
+    for (unsigned long i = posInBlock + 1; i < eventIDBlock.Size() and
+      eventIDs.size() < numRequested; ++i)
+        eventIDs.emplace_back(eventIDBlock.runs[i], eventIDBlock.lumiBlocks[i],
+          eventIDBlock.events[i], eventIDBlock.bunchCrossings[i]);
+    
+    
+    // If the block has been exhausted, read IDs of the following entries directly from the tree,
+    //so that the window is not cut at the end of the cluster. This overwrites the buffer for the
+    //event ID branch, but it is only used in LoadEventIDBlock, which reads all entries anew
+    for (unsigned long i = 0; eventIDs.size() < numRequested; ++i)
+    {
+        unsigned long entry;
+        
+        if (useSelectedEntries)
+        {
+            if (nextSelected + i >= selectedEntries.size())
+                break;
+            
+            entry = selectedEntries[nextSelected + i];
+        }
+        else
+        {
+            if (nextEvent + i >= endEvent)
+                break;
+            
+            entry = nextEvent + i;
+        }
+        
+        eventIDTree->GetEntry(entry);
+        eventIDs.emplace_back(bfEventIDP->RunNumber(), bfEventIDP->LumiSectionNumber(),
+          bfEventIDP->EventNumber(), bfEventIDP->BunchCrossing());
+    }
+}
+
+
+void PECInputData::ReadEventFromTree(std::string const &name, bool force /*= false*/) const
 {
     auto const res = loadedTrees.find(name);
     
     if (res == loadedTrees.end())
         throw std::logic_error("PECInputData::ReadEventFromTree: Method is called for tree \""s +
           name + "\", which has not been loaded.");
-    else
-        res->second->GetEntry(nextEvent - 1);
+    
+    // The tree with event IDs is not read in parallel with the other ones. Its buffers might hold
+    //a different entry, which has been read when IDs were loaded in a block or looked up ahead
+    TTree *tree = res->second.get();
+    
+    if (force or parallelReadEntry != curEntry or tree == eventIDTree)
+        tree->GetEntry(curEntry);
 }
 
 
-bool PECInputData::NextInputFile()
+void PECInputData::RequestAllBranches() const
+{
+    allBranchesRequested = true;
+    
+    for (auto const &p: loadedTrees)
+        requestedBranches[p.first].insert("*");
+    
+    branchRequestsPending = true;
+}
+
+
+void PECInputData::RequestBranches(std::string const &treeName,
+  std::vector<std::string> const &branchNames) const
+{
+    if (loadedTrees.find(treeName) == loadedTrees.end())
+        throw std::logic_error("PECInputData::RequestBranches: Tree \""s + treeName +
+          "\" has not been loaded.");
+    
+    requestedBranches[treeName].insert(branchNames.begin(), branchNames.end());
+    branchRequestsPending = true;
+}
+
+
+void PECInputData::SetEntryList(std::string const &path,
+  std::string const &listName /*= "SkimEntries"*/)
+{
+    entryListPath = path;
+    entryListName = listName;
+    
+    if (not entryListPath.empty() and not boost::algorithm::ends_with(entryListPath, ".root"))
+        entryListPath += ".root";
+}
+
+
+void PECInputData::SetEventIndexCache(std::string const &pluginName /*= "EventIndexCache"*/)
 {
-    // Delete loaded trees and the current input file
+    eventIndexCacheName = pluginName;
+}
+
+
+void PECInputData::SetMemoryMapping(bool enable /*= true*/)
+{
+    memoryMapping = enable;
+}
+
+
+void PECInputData::SetReadAhead(bool enable /*= true*/, float unzipBufferRelSize_ /*= -1.f*/)
+{
+    readAhead = enable;
+    unzipBufferRelSize = unzipBufferRelSize_;
+}
+
+
+void PECInputData::SetReadCache(long size, unsigned learnEntries /*= 100*/,
+  bool printStat /*= false*/)
+{
+    cacheSize = size;
+    cacheLearnEntries = learnEntries;
+    printCacheStat = printStat;
+}
+
+
+void PECInputData::SetParallelUnpacking(bool enable /*= true*/)
+{
+    parallelUnpacking = enable;
+}
+
+
+void PECInputData::SetPrintBranchUsage(bool enable /*= true*/)
+{
+    printBranchUsage = enable;
+}
+
+
+void PECInputData::SetPrefetchNextFile(bool enable /*= true*/)
+{
+    prefetchNextFile = enable;
+}
+
+
+void PECInputData::DiscardPrefetchedFile()
+{
+    if (not nextInputFile.valid())
+        return;
+    
+    try
+    {
+        InputFile unusedFile(nextInputFile.get());
+        
+        ROOTLock::Lock();
+        unusedFile.trees.clear();
+        unusedFile.file.reset();
+        ROOTLock::Unlock();
+    }
+    catch (std::exception const &)
+    {}
+}
+
+
+void PECInputData::ApplyBranchRequests()
+{
+    for (auto const &p: requestedBranches)
+    {
+        TTree *tree = loadedTrees.at(p.first).get();
+        tree->SetBranchStatus("*", false);
+        
+        for (auto const &branchName: p.second)
+            tree->SetBranchStatus(branchName.c_str(), true);
+        
+        
+        // Enable branches that contain enabled subbranches. Subbranches are listed after their
+        //parents, so processing the list in the reversed order propagates the status upwards
+        auto const branches = ListBranches(tree);
+        
+        for (auto bIt = branches.rbegin(); bIt != branches.rend(); ++bIt)
+        {
+            TObjArray const *subBranches = (*bIt)->GetListOfBranches();
+            
+            for (int i = 0; i < subBranches->GetEntriesFast(); ++i)
+            {
+                if (not subBranches->At(i)->TestBit(TBranch::kDoNotProcess))
+                {
+                    (*bIt)->SetStatus(true);
+                    break;
+                }
+            }
+        }
+    }
+    
+    branchRequestsPending = false;
+}
+
+
+void PECInputData::CopyBranchSetup(TTree *source, TTree *target)
+{
+    // Copy statuses of all branches
+    for (auto const &branch: ListBranches(source))
+    {
+        TBranch *targetBranch = target->GetBranch(branch->GetName());
+        
+        if (targetBranch)
+            targetBranch->SetStatus(not branch->TestBit(TBranch::kDoNotProcess));
+    }
+    
+    
+    // Addresses of subbranches of split objects are derived from the address of the top-level
+    //branch. This is taken care of by ROOT
+    source->CopyAddresses(target);
+}
+
+
+std::map<std::string, std::vector<std::string>> PECInputData::ListEnabledBranches() const
+{
+    std::map<std::string, std::vector<std::string>> enabledBranches;
+    
+    for (auto const &p: loadedTrees)
+    {
+        auto &names = enabledBranches[p.first];
+        
+        for (auto const &branch: ListBranches(p.second.get()))
+        {
+            if (not branch->TestBit(TBranch::kDoNotProcess))
+                names.emplace_back(branch->GetName());
+        }
+    }
+    
+    return enabledBranches;
+}
+
+
+std::vector<TBranch *> PECInputData::ListBranches(TTree *tree)
+{
+    std::vector<TBranch *> branches;
+    TObjArray *topBranches = tree->GetListOfBranches();
+    
+    for (int i = 0; i < topBranches->GetEntriesFast(); ++i)
+        branches.emplace_back(static_cast<TBranch *>(topBranches->At(i)));
+    
+    
+    // Append subbranches of each branch in the list, including the newly added ones
+    for (unsigned i = 0; i < branches.size(); ++i)
+    {
+        TObjArray *subBranches = branches[i]->GetListOfBranches();
+        
+        for (int j = 0; j < subBranches->GetEntriesFast(); ++j)
+            branches.emplace_back(static_cast<TBranch *>(subBranches->At(j)));
+    }
+    
+    return branches;
+}
+
+
+PECInputData::InputFile PECInputData::OpenInputFile(std::filesystem::path const &path,
+  std::map<std::string, std::vector<std::string>> const &enabledBranches, bool prefetch,
+  unsigned long startEntry) const
+{
+    InputFile inputFile;
+    
     ROOTLock::Lock();
     
-    for (auto &p: loadedTrees)
-        p.second.reset();
+    if (memoryMapping and MappedROOTFile::IsLocalPath(path.string()))
+        inputFile.file.reset(new MappedROOTFile(path.string()));
+    else
+        inputFile.file.reset(TFile::Open(path.c_str()));
     
-    curInputFile.reset();
     ROOTLock::Unlock();
     
+    if (not inputFile.file or inputFile.file->IsZombie())
+        throw std::runtime_error("PECInputData::OpenInputFile: File "s + path.string() +
+         " does not exist or is not a valid ROOT file.");
+    
+    
+    // Read the requested trees
+    for (auto const &p: enabledBranches)
+    {
+        ROOTLock::Lock();
+        TTree *tree = dynamic_cast<TTree *>(inputFile.file->Get(p.first.c_str()));
+        ROOTLock::Unlock();
+        
+        if (not tree)
+            throw std::runtime_error("PECInputData::OpenInputFile: File "s + path.string() +
+              " does not contain tree \"" + p.first + "\", which has been loaded from a " +
+              "previous file in the same dataset.");
+        
+        inputFile.trees[p.first] = std::unique_ptr<TTree>(tree);
+        
+        ROOTLock::Lock();
+        SetUpReadCache(tree);
+        ROOTLock::Unlock();
+        
+        if (not prefetch)
+            continue;
+        
+        
+        // Only enabled branches are read into the cache. They are known already, so the learning
+        //phase is not needed
+        ROOTLock::Lock();
+        tree->SetBranchStatus("*", false);
+        
+        for (auto const &branchName: p.second)
+        {
+            TBranch *branch = tree->GetBranch(branchName.c_str());
+            
+            if (branch)
+                branch->SetStatus(true);
+        }
+        
+        TTreeCache *cache = tree->GetReadCache(inputFile.file.get());
+        
+        if (cache)
+        {
+            tree->AddBranchToCache("*", true);
+            tree->StopCacheLearningPhase();
+        }
+        
+        ROOTLock::Unlock();
+        
+        
+        // Read baskets of the cluster that contains the first entry to be processed. This is the
+        //expensive part, which is why it is performed without the lock
+        if (cache and startEntry < (unsigned long) tree->GetEntries())
+        {
+            tree->LoadTree(startEntry);
+            cache->FillBuffer();
+        }
+    }
+    
+    return inputFile;
+}
+
+
+void PECInputData::RecordCacheStat()
+{
+    for (auto const &p: loadedTrees)
+    {
+        TTreeCache const *cache = p.second->GetReadCache(curInputFile.get());
+        
+        if (not cache)
+            continue;
+        
+        auto &stat = cacheStat[p.first];
+        stat.bytesRead += cache->GetBytesRead();
+        stat.numReadCalls += cache->GetReadCalls();
+        stat.weightedHitRate += cache->GetEfficiencyRel() * cache->GetBytesRead();
+    }
+}
+
+
+void PECInputData::SetUpReadCache(TTree *tree) const
+{
+    if (cacheSize == 0)
+    {
+        tree->SetCacheSize(0);
+        return;
+    }
+    
+    
+    // In the pipelined mode, the cache must be created after parallel unzipping has been enabled
+    if (readAhead)
+        TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+    
+    tree->SetCacheSize(cacheSize);
+    
+    if (readAhead)
+        tree->SetParallelUnzip(true, unzipBufferRelSize);
+    
+    
+    // Either let the cache learn which branches are read or include all branches right away. In
+    //the latter case, branches that are disabled when the cache is filled are skipped
+    if (cacheLearnEntries > 0)
+        tree->SetCacheLearnEntries(cacheLearnEntries);
+    else
+    {
+        tree->AddBranchToCache("*", true);
+        tree->StopCacheLearningPhase();
+    }
+}
+
+
+void PECInputData::StartPrefetch(std::filesystem::path const &path, unsigned long startEntry)
+{
+    static std::once_flag threadSafetyFlag;
+    std::call_once(threadSafetyFlag, [](){ROOT::EnableThreadSafety();});
+    
+    prefetchedFilePath = path;
+    nextInputFile = std::async(std::launch::async, &PECInputData::OpenInputFile, this,
+      prefetchedFilePath, ListEnabledBranches(), true, startEntry);
+}
+
+
+void PECInputData::ClearEventIDBlock()
+{
+    eventIDBlock.entries.clear();
+    eventIDBlock.runs.clear();
+    eventIDBlock.lumiBlocks.clear();
+    eventIDBlock.events.clear();
+    eventIDBlock.bunchCrossings.clear();
+    posInBlock = 0;
+}
+
+
+bool PECInputData::LoadEventIDBlock()
+{
+    ClearEventIDBlock();
+    
+    if (not entriesSelected)
+        SelectEntries();
+    
+    
+    // Find the first entry to be read
+    unsigned long firstBlockEntry;
+    
+    if (useSelectedEntries)
+    {
+        if (nextSelected == selectedEntries.size())
+            return false;
+        
+        firstBlockEntry = selectedEntries[nextSelected];
+    }
+    else
+    {
+        if (nextEvent == endEvent)
+            return false;
+        
+        firstBlockEntry = nextEvent;
+    }
+    
     
+    // Find the end of the cluster that contains this entry
+    TTree::TClusterIterator clusterIt = eventIDTree->GetClusterIterator(firstBlockEntry);
+    clusterIt.Next();
+    unsigned long const blockEnd = std::max(firstBlockEntry + 1,
+      std::min<unsigned long>(clusterIt.GetNextEntry(), endEvent));
+    
+    
+    // Read entries in the block and split event IDs into columns. With the read cache, baskets of
+    //the cluster are fetched in a single read call
+    auto readEventID = [this](unsigned long entry)
+    {
+        if (eventIDTree->GetEntry(entry) <= 0)
+        {
+            std::ostringstream message;
+            message << "PECInputData[\"" << GetName() << "\"]::LoadEventIDBlock: Failed to " <<
+              "read entry " << entry << " of tree \"" << eventIDTreeName << "\" from file " <<
+              curInputFile->GetName() << ".";
+            throw std::runtime_error(message.str());
+        }
+        
+        eventIDBlock.entries.emplace_back(entry);
+        eventIDBlock.runs.emplace_back(bfEventIDP->RunNumber());
+        eventIDBlock.lumiBlocks.emplace_back(bfEventIDP->LumiSectionNumber());
+        eventIDBlock.events.emplace_back(bfEventIDP->EventNumber());
+        eventIDBlock.bunchCrossings.emplace_back(bfEventIDP->BunchCrossing());
+    };
+    
+    if (useSelectedEntries)
+    {
+        while (nextSelected < selectedEntries.size() and
+          selectedEntries[nextSelected] < blockEnd)
+        {
+            readEventID(selectedEntries[nextSelected]);
+            ++nextSelected;
+        }
+    }
+    else
+    {
+        for (unsigned long entry = firstBlockEntry; entry < blockEnd; ++entry)
+            readEventID(entry);
+        
+        nextEvent = blockEnd;
+    }
+    
+    return true;
+}
+
+
+bool PECInputData::NextInputFile()
+{
     // Check if there are files left in the dataset
     if (nextFileIt == inputFiles.end())
         return false;
     
     
-    // Open the new file and read the tree with event IDs
-    ROOTLock::Lock();
-    curInputFile.reset(TFile::Open(nextFileIt->c_str()));
-    ROOTLock::Unlock();
-        
-    if (not curInputFile or curInputFile->IsZombie())
-        throw std::runtime_error("PECInputData::NextInputFile: File "s + nextFileIt->string() +
-         " does not exist or is not a valid ROOT file.");
+    // Take the next file if it has been prefetched or open it now. If the first file of the
+    //dataset has been prefetched but this failed, e.g. because it does not contain some of the
+    //trees read from the previous dataset, open it again to report errors in the usual way
+    InputFile nextFile;
     
-    LoadTree(eventIDTreeName);
-    eventIDTree = ExposeTree(eventIDTreeName);
+    if (nextInputFile.valid())
+    {
+        if (loadedTrees.empty())
+        {
+            try
+            {
+                nextFile = nextInputFile.get();
+            }
+            catch (std::exception const &)
+            {}
+        }
+        else
+            nextFile = nextInputFile.get();
+    }
     
-    if (not eventIDTree)
-        throw std::runtime_error("PECInputData::NextInputFile: File "s + nextFileIt->string() +
-         " does not contain tree \"pecEventID/EventID\".");
+    if (not nextFile.file)
+        nextFile = OpenInputFile(*nextFileIt, ListEnabledBranches(), false, firstEntry);
+    
+    if (loadedTrees.empty())
+    {
+        // This is the first file in the dataset. Read the tree with event IDs from it. Other
+        //trees will be loaded by dependant plugins. If the file has been prefetched, trees read
+        //from it are kept for them
+        ROOTLock::Lock();
+        curInputFile = std::move(nextFile.file);
+        prefetchedTrees = std::move(nextFile.trees);
+        ROOTLock::Unlock();
+        
+        if (LoadTree(eventIDTreeName) != LoadTreeStatus::Success)
+            throw std::runtime_error("PECInputData::NextInputFile: File "s +
+              nextFileIt->string() + " does not contain tree \"" + eventIDTreeName + "\".");
+        
+        eventIDTree = ExposeTree(eventIDTreeName);
+        
+        ROOTLock::Lock();
+        eventIDTree->SetBranchAddress("eventId", &bfEventIDP);
+        ROOTLock::Unlock();
+    }
+    else
+    {
+        // Trees that have been loaded after the new file started to be prefetched have not been
+        //read from it yet. Read them now
+        for (auto const &p: loadedTrees)
+        {
+            if (nextFile.trees.find(p.first) != nextFile.trees.end())
+                continue;
+            
+            ROOTLock::Lock();
+            TTree *tree = dynamic_cast<TTree *>(nextFile.file->Get(p.first.c_str()));
+            
+            if (tree)
+                SetUpReadCache(tree);
+            
+            ROOTLock::Unlock();
+            
+            if (not tree)
+                throw std::runtime_error("PECInputData::NextInputFile: File "s +
+                  nextFileIt->string() + " does not contain tree \"" + p.first + "\", which has " +
+                  "been loaded from a previous file in the same dataset.");
+            
+            nextFile.trees[p.first] = std::unique_ptr<TTree>(tree);
+        }
+        
+        
+        // Trees with the same names have been read from the new file. Transfer the setup of
+        //branches to them so that dependant plugins do not need to be notified about the switch.
+        //Then delete the previous file and trees read from it
+        RecordCacheStat();
+        ROOTLock::Lock();
+        
+        for (auto &p: loadedTrees)
+            CopyBranchSetup(p.second.get(), nextFile.trees.at(p.first).get());
+        
+        prefetchedTrees.clear();
+        loadedTrees = std::move(nextFile.trees);
+        curInputFile = std::move(nextFile.file);
+        ROOTLock::Unlock();
+        
+        eventIDTree = ExposeTree(eventIDTreeName);
+    }
     
     
     // Update the file iterator for subsequent calls
     ++nextFileIt;
+    parallelReadEntry = -1;
     
     
-    // Set up the tree and update counters
-    ROOTLock::Lock();
-    eventIDTree->SetBranchAddress("eventId", &bfEventIDP);
-    ROOTLock::Unlock();
-    
+    // Update counters and make sure all trees contain the same number of events
     nEvents = eventIDTree->GetEntries();
-    nextEvent = 0;
+    
+    for (auto const &p: loadedTrees)
+    {
+        if ((unsigned long) p.second->GetEntries() != nEvents)
+        {
+            std::ostringstream message;
+            message << "PECInputData::NextInputFile: Tree \"" << p.first << "\" in file " <<
+              curInputFile->GetName() << " contains a different number of events than tree \"" <<
+              eventIDTreeName << "\" (" << p.second->GetEntries() << " vs " << nEvents << ").";
+            throw std::runtime_error(message.str());
+        }
+    }
+    
+    
+    // Restrict reading to the requested range of entries
+    nextEvent = std::min(firstEntry, nEvents);
+    endEvent = (lastEntry < nEvents) ? lastEntry + 1 : nEvents;
+    
+    if (endEvent < nextEvent)
+        endEvent = nextEvent;
+    
+    
+    // Entries to be read will be selected when the first block of event IDs is loaded
+    entriesSelected = false;
+    useSelectedEntries = false;
+    selectedEntries.clear();
+    nextSelected = 0;
+    
+    
+    // Invalidate the block of event IDs from the previous file
+    ClearEventIDBlock();
     
     
     return true;
@@ -192,24 +1013,91 @@ bool PECInputData::NextInputFile()
 
 bool PECInputData::ProcessEvent()
 {
-    // Make sure there are events left in the tree and open the next file if it is not the case
-    if (nextEvent == nEvents)
-    //^ This condition is also satisfied when the method is executed for the first time
+    // Apply new requests for branches before anything is read with them
+    if (branchRequestsPending)
     {
-        bool const fileOpened = NextInputFile();
-        
-        if (not fileOpened)
-            return false;
+        ROOTLock::Lock();
+        ApplyBranchRequests();
+        ROOTLock::Unlock();
+    }
+    
+    
+    // Move to the next event in the current block of event IDs. When the block is exhausted, load
+    //the next one, opening new input files as needed. Repeat if there are no events to read in
+    //the new file
+    if (posInBlock + 1 < eventIDBlock.Size())
+        ++posInBlock;
+    else
+    {
+        while (not LoadEventIDBlock())
+        //^ This condition is also satisfied when the method is executed for the first time
+        {
+            bool const fileOpened = NextInputFile();
+            
+            if (not fileOpened)
+                return false;
+        }
     }
     
+    curEntry = eventIDBlock.entries[posInBlock];
+    eventID.Set(eventIDBlock.runs[posInBlock], eventIDBlock.lumiBlocks[posInBlock],
+      eventIDBlock.events[posInBlock], eventIDBlock.bunchCrossings[posInBlock]);
     
-    // Read ID of the next event from the tree
-    eventIDTree->GetEntry(nextEvent);
-    ++nextEvent;
     
-    // Translate the ID from the storage format to the standard format of the framework
-    eventID.Set(bfEventIDP->RunNumber(), bfEventIDP->LumiSectionNumber(), bfEventIDP->EventNumber(),
-      bfEventIDP->BunchCrossing());
+    // Once the first event in the file has been read, all dependant plugins have set up the trees.
+    //Start opening the next file in the background, enabling the same branches. If this is the
+    //last file in the dataset, open the first file of the next dataset instead
+    if (prefetchNextFile and not nextInputFile.valid())
+    {
+        if (nextFileIt != inputFiles.end())
+            StartPrefetch(*nextFileIt, firstEntry);
+        else if (not prefetchingNextDataset)
+        {
+            Dataset const *nextDataset = GetMaster().GetNextDataset();
+            
+            if (nextDataset and not nextDataset->GetFiles().empty())
+            {
+                prefetchingNextDataset = true;
+                StartPrefetch(nextDataset->GetFiles().front(), nextDataset->GetFirstEntry());
+            }
+        }
+    }
+    
+    
+    // Read the event from all other trees in parallel if requested. The list of trees is rebuilt
+    //each time since trees are replaced when a new input file is opened
+    if (executor)
+    {
+        parallelTrees.clear();
+        
+        for (auto const &p: loadedTrees)
+        {
+            if (p.second.get() != eventIDTree)
+                parallelTrees.emplace_back(p.second.get());
+        }
+        
+        if (parallelTrees.size() > 1)
+        {
+            unsigned long const entry = curEntry;
+            std::atomic<bool> readError(false);
+            
+            executor->Foreach([entry, &readError](TTree *tree)
+              {
+                  if (tree->GetEntry(entry) < 0)
+                      readError = true;
+              }, parallelTrees);
+            
+            if (readError)
+            {
+                std::ostringstream message;
+                message << "PECInputData[\"" << GetName() << "\"]::ProcessEvent: Failed to read " <<
+                  "entry " << entry << " from file " << curInputFile->GetName() << ".";
+                throw std::runtime_error(message.str());
+            }
+            
+            parallelReadEntry = entry;
+        }
+    }
     
     
     // Debug output
@@ -221,3 +1109,49 @@ bool PECInputData::ProcessEvent()
     
     return true;
 }
+
+
+void PECInputData::SelectEntries()
+{
+    entriesSelected = true;
+    
+    if (entryList)
+    {
+        // Pick entries from the entry list. The sublist for the current file is identified by the
+        //absolute path to the file
+        useSelectedEntries = true;
+        
+        std::string const fileName(std::filesystem::absolute(GetCurrentFilePath()).string());
+        TEntryList *subList =
+          entryList->GetEntryList(eventIDTreeName.c_str(), fileName.c_str(), "ne");
+        
+        if (subList)
+        {
+            for (Long64_t i = 0; i < subList->GetN(); ++i)
+                selectedEntries.emplace_back(subList->GetEntry(i));
+        }
+    }
+    else if (not eventIndexCacheName.empty())
+    {
+        // Look up the cache. The plugin is found in the processor since it is located after this
+        //one in the path and thus cannot be accessed as a dependency
+        if (not eventIndexCache)
+        {
+            eventIndexCache = dynamic_cast<PECEventIndexCache const *>(
+              GetMaster().GetPlugin(eventIndexCacheName));
+            
+            if (not eventIndexCache)
+                throw std::runtime_error("PECInputData[\""s + GetName() + "\"]::SelectEntries: "
+                  "Plugin \"" + eventIndexCacheName + "\" is not a PECEventIndexCache.");
+        }
+        
+        useSelectedEntries = eventIndexCache->LookUp(GetCurrentFilePath(), selectedEntries);
+    }
+    
+    
+    // Restrict the selection to the requested range of entries
+    if (useSelectedEntries)
+        selectedEntries.erase(std::remove_if(selectedEntries.begin(), selectedEntries.end(),
+          [this](unsigned long entry){return (entry < nextEvent or entry >= endEvent);}),
+          selectedEntries.end());
+}
@@ -1,5 +1,6 @@
 #include <mensura/PECReader/PECJetMETReader.hpp>
 
+#include <mensura/DeltaR2Kernel.hpp>
 #include <mensura/FileInPath.hpp>
 #include <mensura/PileUpReader.hpp>
 #include <mensura/Processor.hpp>
@@ -10,8 +11,6 @@
 #include "Candidate.hpp"
 #include "Jet.hpp"
 
-#include <TVector2.h>
-
 #include <cmath>
 #include <iostream>
 #include <limits>
@@ -97,21 +96,25 @@ void PECJetMETReader::BeginRun(Dataset const &)
     }
     
     
-    // Set up the tree. Branches with properties that are not currently not used, are disabled
+    // Set up the tree. Only properties that are used are read
     inputDataPlugin->LoadTree(treeName);
-    TTree *tree = inputDataPlugin->ExposeTree(treeName);
+    std::vector<std::string> branchNames{"jets.pt", "jets.eta", "jets.phi", "jets.mass",
+      "jets.id", "jets.corrFactor", "jets.bTags*", "jets.pileUpMVA", "jets.area",
+      "jets.flavours", "METs*"};
     
-    ROOTLock::Lock();
+    if (systType == SystType::JEC)
+        branchNames.emplace_back("jets.jecUncertainty");
     
-    if (systType != SystType::JEC)
-        tree->SetBranchStatus("jets.jecUncertainty", false);
+    if (systType == SystType::JER)
+        branchNames.emplace_back("jets.jerUncertainty");
     
-    if (systType != SystType::JER)
-        tree->SetBranchStatus("jets.jerUncertainty", false);
+    if (readRawMET)
+        branchNames.emplace_back("uncorrMETs*");
     
-    tree->SetBranchStatus("jets.charge", false);
-    tree->SetBranchStatus("jets.pullAngle", false);
+    inputDataPlugin->RequestBranches(treeName, branchNames);
+    TTree *tree = inputDataPlugin->ExposeTree(treeName);
     
+    ROOTLock::Lock();
     tree->SetBranchAddress("jets", &bfJetPointer);
     tree->SetBranchAddress("METs", &bfMETPointer);
     
@@ -193,9 +196,23 @@ void PECJetMETReader::SetSelection(double minPt_, double maxAbsEta_)
 
 bool PECJetMETReader::ProcessEvent()
 {
-    // Clear vector with jets from the previous event
+    // Postpone reading of the input tree until jets and MET are requested by another plugin
+    SetEventPending();
+    
+    
+    // Since this reader does not have access to the input file, it does not know when there are
+    //no more events in the dataset and thus always returns true
+    return true;
+}
+
+
+void PECJetMETReader::UnpackEvent()
+{
+    // Clear collection of jets from the previous event
     jets.clear();
     
+    static UserPropertyHandle const idHandle = UserPropertyRegistry::GetHandle("ID");
+    
     
     // Read jets and MET
     inputDataPlugin->ReadEventFromTree(treeName);
@@ -204,6 +221,35 @@ bool PECJetMETReader::ProcessEvent()
     auto const *leptonsForCleaning = (leptonPlugin) ? &leptonPlugin->GetLeptons() : nullptr;
     
     
+    // Copy directions of leptons and generator-level jets into contiguous arrays, as needed for
+    //the vectorised computation of angular distances
+    leptonEtas.clear();
+    leptonPhis.clear();
+    
+    if (leptonsForCleaning)
+    {
+        for (auto const &l: *leptonsForCleaning)
+        {
+            leptonEtas.emplace_back(l.Eta());
+            leptonPhis.emplace_back(l.Phi());
+        }
+    }
+    
+    genJetEtas.clear();
+    genJetPhis.clear();
+    genJetPts.clear();
+    
+    if (genJetPlugin)
+    {
+        for (auto const &genJet: genJetPlugin->GetJets())
+        {
+            genJetEtas.emplace_back(genJet.Eta());
+            genJetPhis.emplace_back(genJet.Phi());
+            genJetPts.emplace_back(genJet.Pt());
+        }
+    }
+    
+    
     // Header for debug print out
     #ifdef DEBUG
     std::cout << "PECJetMETReader[\"" << GetName() << "\"]: Jets in the current event:\n";
@@ -217,8 +263,7 @@ bool PECJetMETReader::ProcessEvent()
         // Read raw jet momentum and apply corrections to it. The correction factor read from
         //pec::Jet is zero if only raw momentum is stored. In this case propagate the raw momentum
         //unchanged.
-        TLorentzVector p4;
-        p4.SetPtEtaPhiM(j.Pt(), j.Eta(), j.Phi(), j.M());
+        PtEtaPhiMVector p4(j.Pt(), j.Eta(), j.Phi(), j.M());
         
         double corrFactor = j.CorrFactor();
         
@@ -260,26 +305,9 @@ bool PECJetMETReader::ProcessEvent()
         
         
         // Peform cleaning against leptons if enabled
-        if (leptonsForCleaning)
-        {
-            bool overlap = false;
-            
-            for (auto const &l: *leptonsForCleaning)
-            {
-                double const dR2 = std::pow(p4.Eta() - l.Eta(), 2) +
-                  std::pow(TVector2::Phi_mpi_pi(p4.Phi() - l.Phi()), 2);
-                //^ Do not use TLorentzVector::DeltaR to avoid calculating sqrt
-                
-                if (dR2 < leptonDR2)
-                {
-                    overlap = true;
-                    break;
-                }
-            }
-            
-            if (overlap)
-                continue;
-        }
+        if (leptonsForCleaning and DeltaR2Kernel::FindFirstWithin(p4.Eta(), p4.Phi(),
+          leptonEtas.data(), leptonPhis.data(), leptonEtas.size(), leptonDR2) != leptonEtas.size())
+            continue;
         
         
         #ifdef DEBUG
@@ -288,30 +316,27 @@ bool PECJetMETReader::ProcessEvent()
         #endif
         
         
-        // Build the jet object. At this point jet momentum must be fully corrected
-        Jet jet;
-        
-        if (corrFactor != 0.)
-            jet.SetCorrectedP4(p4, 1. / corrFactor);
-        else
-            jet.SetCorrectedP4(p4, 1.);
+        // Add the jet to the collection. At this point jet momentum must be fully corrected
+        std::size_t const index = jets.Add(p4, (corrFactor != 0.) ? 1. / corrFactor : 1.);
         
-        jet.SetBTag(BTagger::Algorithm::CSV, j.BTag(pec::Jet::BTagAlgo::CSV));
-        jet.SetBTag(BTagger::Algorithm::CMVA, j.BTag(pec::Jet::BTagAlgo::CMVA));
-        jet.SetBTag(BTagger::Algorithm::DeepCSV,
+        jets.SetBTag(index, BTagger::Algorithm::CSV, j.BTag(pec::Jet::BTagAlgo::CSV));
+        jets.SetBTag(index, BTagger::Algorithm::CMVA, j.BTag(pec::Jet::BTagAlgo::CMVA));
+        jets.SetBTag(index, BTagger::Algorithm::DeepCSV,
           j.BTagDNN(pec::Jet::BTagDNNType::BB) + j.BTagDNN(pec::Jet::BTagDNNType::B));
         
-        jet.SetArea(j.Area());
-        // jet.SetCharge(j.Charge());
-        // jet.SetPullAngle(j.PullAngle());
-        jet.SetPileUpID(j.PileUpID());
+        jets.SetArea(index, j.Area());
+        // jets.SetCharge(index, j.Charge());
+        // jets.SetPullAngle(index, j.PullAngle());
+        jets.SetPileUpID(index, j.PileUpID());
         
-        jet.SetFlavour(Jet::FlavourType::Hadron, j.Flavour(pec::Jet::FlavourType::Hadron));
-        jet.SetFlavour(Jet::FlavourType::Parton, j.Flavour(pec::Jet::FlavourType::Parton));
-        jet.SetFlavour(Jet::FlavourType::ME, j.Flavour(pec::Jet::FlavourType::ME));
+        jets.SetFlavour(index, Jet::FlavourType::Hadron,
+          j.Flavour(pec::Jet::FlavourType::Hadron));
+        jets.SetFlavour(index, Jet::FlavourType::Parton,
+          j.Flavour(pec::Jet::FlavourType::Parton));
+        jets.SetFlavour(index, Jet::FlavourType::ME, j.Flavour(pec::Jet::FlavourType::ME));
         
         if (not applyJetID)
-            jet.SetUserInt("ID", int(j.TestBit(1)));
+            jets.SetUserInt(index, idHandle, int(j.TestBit(1)));
         
         
         // Perform matching to generator-level jets if the corresponding reader is available.
@@ -320,8 +345,7 @@ bool PECJetMETReader::ProcessEvent()
         //check this, that the difference in pt is compatible with the pt resolution in simulation.
         if (genJetPlugin)
         {
-            double minDR2 = std::pow(GetJetRadius() / 2., 2);
-            GenJet const *matchedGenJet = nullptr;
+            double const maxDR2 = std::pow(GetJetRadius() / 2., 2);
             double maxDPt = std::numeric_limits<double>::infinity();
             
             if (jerProvider)
@@ -331,20 +355,12 @@ bool PECJetMETReader::ProcessEvent()
             }
             
             
-            for (auto const &genJet: genJetPlugin->GetJets())
-            {
-                double const dR2 = std::pow(p4.Eta() - genJet.Eta(), 2) +
-                  std::pow(TVector2::Phi_mpi_pi(p4.Phi() - genJet.Phi()), 2);
-                //^ Do not use TLorentzVector::DeltaR to avoid calculating sqrt
-                
-                if (dR2 < minDR2 and std::abs(p4.Pt() - genJet.Pt()) < maxDPt)
-                {
-                    matchedGenJet = &genJet;
-                    minDR2 = dR2;
-                }
-            }
+            std::size_t const iMatched = DeltaR2Kernel::FindClosest(p4.Eta(), p4.Phi(), p4.Pt(),
+              genJetEtas.data(), genJetPhis.data(), genJetPts.data(), genJetEtas.size(), maxDR2,
+              maxDPt);
             
-            jet.SetMatchedGenJet(matchedGenJet);
+            jets.SetMatchedGenJet(index, (iMatched != genJetEtas.size()) ?
+              &genJetPlugin->GetJets()[iMatched] : nullptr);
         }
         
         #ifdef DEBUG
@@ -354,7 +370,7 @@ bool PECJetMETReader::ProcessEvent()
         
         if (genJetPlugin)
         {
-            if (jet.MatchedGenJet())
+            if (jets[index].MatchedGenJet())
                 std::cout << "yes";
             else
                 std::cout << "no";
@@ -364,14 +380,11 @@ bool PECJetMETReader::ProcessEvent()
         
         std::cout << '\n';
         #endif
-        
-        
-        jets.push_back(jet);
     }
     
     
     // Make sure collection of jets is ordered in transverse momentum
-    std::sort(jets.rbegin(), jets.rend());
+    jets.SortByPt();
     
     
     // Copy corrected MET corresponding to the requested systematic variation
@@ -427,11 +440,5 @@ bool PECJetMETReader::ProcessEvent()
     std::cout << " Corrected MET (pt, phi): " << bfMETs.at(0).Pt() << ", "
       << bfMETs.at(0).Phi() << std::endl;
     #endif
-    
-    
-    
-    // Since this reader does not have access to the input file, it does not know when there are
-    //no more events in the dataset and thus always returns true
-    return true;
 }
 
@@ -40,13 +40,19 @@ void PECLeptonReader::BeginRun(Dataset const &)
     inputDataPlugin = dynamic_cast<PECInputData const *>(GetDependencyPlugin(inputDataPluginName));
     
     
-    // Set up the trees. Branches with properties that are currently not utilized, are disabled
+    // Set up the trees. Only properties that are used are read. Masses of leptons are not needed
+    //since they are set to fixed values
     inputDataPlugin->LoadTree(electronTreeName);
     inputDataPlugin->LoadTree(muonTreeName);
     
+    inputDataPlugin->RequestBranches(electronTreeName, {"electrons.pt", "electrons.eta",
+      "electrons.phi", "electrons.id", "electrons.charge", "electrons.relIso",
+      "electrons.etaSC", "electrons.cutBasedId"});
+    inputDataPlugin->RequestBranches(muonTreeName, {"muons.pt", "muons.eta", "muons.phi",
+      "muons.id", "muons.charge", "muons.relIso"});
+    
     ROOTLock::Lock();
     TTree *t = inputDataPlugin->ExposeTree(electronTreeName);
-    t->SetBranchStatus("electrons.mvaId*", false);
     t->SetBranchAddress("electrons", &bfElectronPointer);
     
     t = inputDataPlugin->ExposeTree(muonTreeName);
@@ -62,19 +68,32 @@ Plugin *PECLeptonReader::Clone() const
 
 
 bool PECLeptonReader::ProcessEvent()
+{
+    // Postpone reading of the input trees until leptons are requested by another plugin
+    SetEventPending();
+    
+    
+    // Since this reader does not have access to the input file, it does not know when there are
+    //no more events in the dataset and thus always returns true
+    return true;
+}
+
+
+void PECLeptonReader::UnpackEvent()
 {
     // Clear vectors with leptons from the previous event
     leptons.clear();
     looseLeptons.clear();
     
     
-    // Read and process electrons in the current event
+    // Read and process electrons in the current event. The handle for the user-defined property
+    //is looked up only once
+    static UserPropertyHandle const etaSCHandle = UserPropertyRegistry::GetHandle("etaSC");
     inputDataPlugin->ReadEventFromTree(electronTreeName);
     
     for (pec::Electron const &l: bfElectrons)
     {
-        TLorentzVector p4;
-        p4.SetPtEtaPhiM(l.Pt(), l.Eta(), l.Phi(), 0.511e-3);
+        PtEtaPhiMVector p4(l.Pt(), l.Eta(), l.Phi(), 0.511e-3);
         
         
         // Selection to define a loose electron
@@ -87,7 +106,7 @@ bool PECLeptonReader::ProcessEvent()
         Lepton lepton(Lepton::Flavour::Electron, p4);
         lepton.SetRelIso(l.RelIso());
         lepton.SetCharge(l.Charge());
-        lepton.SetUserFloat("etaSC", l.EtaSC());
+        lepton.SetUserFloat(etaSCHandle, l.EtaSC());
         
         looseLeptons.push_back(lepton);
         
@@ -107,8 +126,7 @@ bool PECLeptonReader::ProcessEvent()
     
     for (pec::Muon const &l: bfMuons)
     {
-        TLorentzVector p4;
-        p4.SetPtEtaPhiM(l.Pt(), l.Eta(), l.Phi(), 0.105);
+        PtEtaPhiMVector p4(l.Pt(), l.Eta(), l.Phi(), 0.105);
         
         
         // Selection to define a loose muon
@@ -134,9 +152,4 @@ bool PECLeptonReader::ProcessEvent()
     // Make sure both collections are ordered in transverse momentum
     std::sort(leptons.rbegin(), leptons.rend());
     std::sort(looseLeptons.rbegin(), looseLeptons.rend());
-    
-    
-    // Since this reader does not have access to the input file, it does not know when there are
-    //no more events in the dataset and thus always returns true
-    return true;
 }
@@ -37,10 +37,10 @@ void PECPileUpReader::BeginRun(Dataset const &)
     // Set up the tree with pile-up information. Attributes of the PileUpInfo class that are not
     //used are not read
     inputDataPlugin->LoadTree(treeName);
+    inputDataPlugin->RequestBranches(treeName, {"numPV", "trueNumPU", "rho"});
+    
     TTree *tree = inputDataPlugin->ExposeTree(treeName);
     ROOTLock::Lock();
-    tree->SetBranchStatus("inTimeNumPU", false);
-    tree->SetBranchStatus("maxPtHat", false);
     tree->SetBranchAddress("puInfo", &bfPileUpInfoP);
     ROOTLock::Unlock();
 }
@@ -53,6 +53,18 @@ Plugin *PECPileUpReader::Clone() const
 
 
 bool PECPileUpReader::ProcessEvent()
+{
+    // Postpone reading of the input tree until pile-up information is requested by another plugin
+    SetEventPending();
+    
+    
+    // Since this reader does not have access to the input file, it does not know when there are
+    //no more events in the dataset and thus always returns true
+    return true;
+}
+
+
+void PECPileUpReader::UnpackEvent()
 {
     // Read the tree
     inputDataPlugin->ReadEventFromTree(treeName);
@@ -60,9 +72,4 @@ bool PECPileUpReader::ProcessEvent()
     numVertices = bfPileUpInfoP->NumPV();
     expectedPileUp = bfPileUpInfoP->TrueNumPU();
     rho = bfPileUpInfoP->Rho();
-    
-    
-    // Since this reader does not have access to the input file, it does not know when there are
-    //no more events in the dataset and thus always returns true
-    return true;
 }
@@ -0,0 +1,165 @@
+#include <mensura/PECReader/PECSkimWriter.hpp>
+
+#include <mensura/Processor.hpp>
+#include <mensura/ROOTLock.hpp>
+#include <mensura/TFileService.hpp>
+#include <mensura/PECReader/PECInputData.hpp>
+
+#include <TEntryList.h>
+#include <TTree.h>
+
+
+PECSkimWriter::PECSkimWriter(std::string const &name, Mode mode_ /*= Mode::EntryList*/):
+    AnalysisPlugin(name),
+    mode(mode_),
+    fileServiceName("TFileService"), fileService(nullptr),
+    inputDataPluginName("InputData"), inputDataPlugin(nullptr),
+    entryList(nullptr)
+{}
+
+
+PECSkimWriter::PECSkimWriter(Mode mode_ /*= Mode::EntryList*/):
+    PECSkimWriter("SkimWriter", mode_)
+{}
+
+
+PECSkimWriter::PECSkimWriter(PECSkimWriter const &src):
+    AnalysisPlugin(src),
+    mode(src.mode),
+    fileServiceName(src.fileServiceName), fileService(nullptr),
+    inputDataPluginName(src.inputDataPluginName), inputDataPlugin(nullptr),
+    entryList(nullptr)
+{}
+
+
+PECSkimWriter::~PECSkimWriter() noexcept
+{}
+
+
+void PECSkimWriter::BeginRun(Dataset const &)
+{
+    // Save pointers to the file service and the plugin providing access to input data
+    fileService = dynamic_cast<TFileService const *>(GetMaster().GetService(fileServiceName));
+    inputDataPlugin = dynamic_cast<PECInputData const *>(GetDependencyPlugin(inputDataPluginName));
+    
+    
+    // Create the entry list in the root directory of the output file. Input trees are cloned
+    //when the first event is recorded since other plugins might still change their setup
+    if (mode == Mode::EntryList)
+    {
+        std::string const title("Entries selected by plugin " + GetName());
+        entryList = fileService->Create<TEntryList>("", "SkimEntries", title.c_str());
+        
+        ROOTLock::Lock();
+        entryList->SetDirectory(fileService->GetDirectory(""));
+        ROOTLock::Unlock();
+    }
+    
+    
+    // Make sure that trees to be copied are read in full. Otherwise branches that are not needed
+    //by any reader would be disabled by PECInputData and then left out from the copies. This also
+    //covers trees that plugins following this one will load in their BeginRun, since they are
+    //cloned only when the first event reaches this plugin
+    if (mode == Mode::CopyTrees)
+        inputDataPlugin->RequestAllBranches();
+}
+
+
+Plugin *PECSkimWriter::Clone() const
+{
+    return new PECSkimWriter(*this);
+}
+
+
+void PECSkimWriter::EndRun()
+{
+    // The output objects are written by the file service
+    entryList = nullptr;
+    curFilePath.clear();
+    trees.clear();
+}
+
+
+void PECSkimWriter::SetFileServiceName(std::string const &name)
+{
+    fileServiceName = name;
+}
+
+
+void PECSkimWriter::CloneTrees()
+{
+    ROOTLock::Lock();
+    
+    for (auto const &name: inputDataPlugin->ListLoadedTrees())
+    {
+        // Put the clone into the same directory as the input tree
+        auto const slashPos = name.rfind('/');
+        TDirectory *d = fileService->GetDirectory(
+          (slashPos != std::string::npos) ? name.substr(0, slashPos) : "");
+        d->cd();
+        
+        // Only the structure of the tree is cloned. This also registers the clone with the input
+        //tree so that their branch addresses are kept in sync
+        TTree *source = inputDataPlugin->ExposeTree(name);
+        TTree *clone = source->CloneTree(0);
+        clone->SetDirectory(d);
+        
+        trees[name] = {source, clone};
+    }
+    
+    ROOTLock::Unlock();
+}
+
+
+bool PECSkimWriter::ProcessEvent()
+{
+    if (mode == Mode::EntryList)
+    {
+        // Switch to the sublist for the current input file if needed
+        auto const &filePath = inputDataPlugin->GetCurrentFilePath();
+        
+        if (filePath != curFilePath)
+        {
+            curFilePath = filePath;
+            
+            ROOTLock::Lock();
+            entryList->SetTree(inputDataPlugin->GetEventIDTreeName().c_str(),
+              std::filesystem::absolute(curFilePath).c_str());
+            ROOTLock::Unlock();
+        }
+        
+        entryList->Enter(inputDataPlugin->GetCurrentEntry());
+    }
+    else
+    {
+        if (trees.empty())
+            CloneTrees();
+        
+        for (auto &p: trees)
+        {
+            auto &treePair = p.second;
+            TTree *source = inputDataPlugin->ExposeTree(p.first);
+            
+            // If a new input file has been opened, redirect the clone to buffers of the new tree
+            if (source != treePair.source)
+            {
+                ROOTLock::Lock();
+                source->CopyAddresses(treePair.clone);
+                source->AddClone(treePair.clone);
+                ROOTLock::Unlock();
+                
+                treePair.source = source;
+            }
+            
+            // Make sure the current event has been read from the input tree. Lazy readers might
+            //not have done this yet
+            inputDataPlugin->ReadEventFromTree(p.first);
+        }
+        
+        for (auto &p: trees)
+            p.second.clone->Fill();
+    }
+    
+    
+    return true;
+}
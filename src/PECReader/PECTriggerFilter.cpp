@@ -5,6 +5,7 @@
 #include <mensura/PECReader/PECInputData.hpp>
 
 #include <algorithm>
+#include <sstream>
 
 
 using namespace std::literals::string_literals;
@@ -22,7 +23,7 @@ void PECTriggerFilter::BeginRun(Dataset const &)
     // Find the plugin that reads input files
     inputDataPlugin = dynamic_cast<PECInputData const *>(GetDependencyPlugin(inputDataPluginName));
     
-    // Register reading the tree with trigger information and by default disable all branches
+    // Register reading the tree with trigger information
     inputDataPlugin->LoadTree(triggerTreeName);
     triggerTree = inputDataPlugin->ExposeTree(triggerTreeName);
 }
@@ -57,6 +58,13 @@ void PECTriggerFilterData::BeginRun(Dataset const &dataset)
     // Reset the current range in case this is not the first dataset processed by this instance of
     //the plugin. Without this, the plugin would not set up reading of the appropriate branches
     currentRange = nullptr;
+    buffers.clear();
+    currentBuffers.clear();
+    
+    
+    // Branches of the trigger tree are requested when the corresponding trigger range is entered.
+    //Until then, none of them needs to be read
+    inputDataPlugin->RequestBranches(triggerTreeName, {});
 }
 
 
@@ -66,6 +74,26 @@ Plugin *PECTriggerFilterData::Clone() const
 }
 
 
+std::string PECTriggerFilterData::GetCacheKey() const
+{
+    std::ostringstream key;
+    key << "PECTriggerFilterData";
+    
+    for (auto const &range: ranges)
+    {
+        auto const &first = range->GetFirstEvent();
+        auto const &last = range->GetLastEvent();
+        key << ";" << first.Run() << ":" << first.LumiBlock() << ":" << first.Event() << "-" <<
+          last.Run() << ":" << last.LumiBlock() << ":" << last.Event() << ":";
+        
+        for (auto const &trigger: range->GetDataTriggers())
+            key << trigger << ",";
+    }
+    
+    return key.str();
+}
+
+
 // void PECTriggerFilterData::ConstructRanges(C const &ranges);
 // (Defined in the header)
 
@@ -74,6 +102,7 @@ bool PECTriggerFilterData::ProcessEvent()
 {
     // Check if the current trigger range includes the current event and update it if needed
     auto const &eventID = inputDataPlugin->GetEventID();
+    bool branchesUpdated = false;
     
     if (not currentRange or not currentRange->InRange(eventID))
     {
@@ -91,19 +120,22 @@ bool PECTriggerFilterData::ProcessEvent()
         
         
         // A valid trigger range has been found. Assign buffers to branches containing decisions of
-        //triggers included in this range. Note that the trigger list cannot contain duplicates,
-        //and thus there is no need to protect the buffer against them
+        //triggers included in this range. The branches are enabled right away since requests
+        //made to PECInputData only take effect from the next event. Branches of other triggers
+        //are not disabled here, so that trees copied by PECSkimWriter stay complete
         currentRange = *res;
+        currentBuffers.clear();
+        std::vector<std::string> branchNames;
         
-        buffers.assign(currentRange->GetDataTriggers().size(), false);
-        unsigned currentBufferIndex = 0;
+        triggerTree = inputDataPlugin->ExposeTree(triggerTreeName);
+        //^ The tree might have changed if a new input file has been opened
         
         ROOTLock::Lock();
-        triggerTree->SetBranchStatus("*", false);
         
         for (auto const &triggerPattern: currentRange->GetDataTriggers())
         {
-            TBranch *branch = triggerTree->GetBranch((triggerPattern + "__accept").c_str());
+            std::string const branchName(triggerPattern + "__accept");
+            TBranch *branch = triggerTree->GetBranch(branchName.c_str());
             
             if (not branch)
             {
@@ -112,21 +144,27 @@ bool PECTriggerFilterData::ProcessEvent()
                  "trigger \"HLT_" + triggerPattern + "_v*\" is not stored in the tree.");
             }
             
+            Bool_t &buffer = buffers[triggerPattern];
             branch->SetStatus(true);
-            branch->SetAddress(&buffers.at(currentBufferIndex));
-            ++currentBufferIndex;
+            branch->SetAddress(&buffer);
+            currentBuffers.emplace_back(&buffer);
+            branchNames.emplace_back(branchName);
         }
         
         ROOTLock::Unlock();
+        
+        inputDataPlugin->RequestBranches(triggerTreeName, branchNames);
+        branchesUpdated = true;
     }
     
     
     // Now that the tree has been set up propertly, read it and check if the event is accepted by
-    //at least one trigger
-    inputDataPlugin->ReadEventFromTree(triggerTreeName);
+    //at least one trigger. If the set of branches has just been changed, the tree must be read
+    //anew even if PECInputData has already done this for the current event
+    inputDataPlugin->ReadEventFromTree(triggerTreeName, branchesUpdated);
     
-    for (auto const &decision: buffers)
-        if (decision)
+    for (auto const &decision: currentBuffers)
+        if (*decision)
             return true;
     
     return false;
@@ -171,9 +209,10 @@ void PECTriggerFilterMC::BeginRun(Dataset const &dataset)
     }
     
     
-    // Set statuses and addresses of relevant branches of the trigger tree
+    // Set addresses of relevant branches of the trigger tree and request reading them. Other
+    //branches will be disabled by PECInputData unless some plugin needs them
+    std::vector<std::string> branchNames;
     ROOTLock::Lock();
-    triggerTree->SetBranchStatus("*", false);
     
     for (auto &b: buffers)
     {
@@ -196,14 +235,16 @@ void PECTriggerFilterMC::BeginRun(Dataset const &dataset)
             }
             
             
-            // Set the status and address of the branch
-            branch->SetStatus(true);
+            // Set the address of the branch
             branch->SetAddress(&b.second);
+            branchNames.emplace_back(b.first + "__accept");
         }
     }
     
     ROOTLock::Unlock();
     
+    inputDataPlugin->RequestBranches(triggerTreeName, branchNames);
+    
     
     // In each TriggerRange wrapper, save pointers to associated buffers. This is needed to be
     //able to evaluate whether at least one trigger in a given range has accepted an event
@@ -83,18 +83,23 @@ void PECTriggerObjectReader::BeginRun(Dataset const &)
     buffers.resize(triggerIndexMap.size());
     bufferPointers.resize(triggerIndexMap.size());
     
-    t->SetBranchStatus("*", false);
+    std::vector<std::string> branchNames;
     
     for (auto const &p: triggerIndexMap)
     {
         bufferPointers.at(p.second) = &buffers.at(p.second);
-        t->SetBranchStatus((p.first + ".*").c_str(), true);
+        branchNames.emplace_back(p.first + ".*");
         t->SetBranchAddress(p.first.c_str(), &bufferPointers.at(p.second));
     }
     
     ROOTLock::Unlock();
     
     
+    // Only the selected trigger filters are read. The request is applied by PECInputData before the
+    //first event is read
+    inputDataPlugin->RequestBranches(treeName, branchNames);
+    
+    
     triggerObjects.resize(triggerIndexMap.size());
 }
 
@@ -13,12 +13,12 @@ Candidate::Candidate() noexcept
 {}
 
 
-Candidate::Candidate(TLorentzVector const &p4_) noexcept:
+Candidate::Candidate(PtEtaPhiMVector const &p4_) noexcept:
     p4(p4_)
 {}
 
 
-void Candidate::SetP4(TLorentzVector const &p4_) noexcept
+void Candidate::SetP4(PtEtaPhiMVector const &p4_) noexcept
 {
     p4 = p4_;
 }
@@ -38,17 +38,35 @@ void Candidate::SetPxPyPzE(double px, double py, double pz, double E) noexcept
 
 void Candidate::SetUserFloat(std::string const &label, double value)
 {
-    userFloats[label] = value;
+    userFloats.Set(UserPropertyRegistry::GetHandle(label), value);
+}
+
+
+void Candidate::SetUserFloat(UserPropertyHandle handle, double value)
+{
+    userFloats.Set(handle, value);
 }
 
 
 void Candidate::SetUserInt(std::string const &label, long value)
 {
-    userInts[label] = value;
+    userInts.Set(UserPropertyRegistry::GetHandle(label), value);
+}
+
+
+void Candidate::SetUserInt(UserPropertyHandle handle, long value)
+{
+    userInts.Set(handle, value);
+}
+
+
+PtEtaPhiMVector const &Candidate::CompactP4() const noexcept
+{
+    return p4;
 }
 
 
-TLorentzVector const &Candidate::P4() const noexcept
+TLorentzVector Candidate::P4() const noexcept
 {
     return p4;
 }
@@ -86,33 +104,45 @@ double Candidate::E() const noexcept
 
 double Candidate::UserFloat(std::string const &label) const
 {
-    auto const res = userFloats.find(label);
+    return UserFloat(UserPropertyRegistry::GetHandle(label));
+}
+    
+
+double Candidate::UserFloat(UserPropertyHandle handle) const
+{
+    double const *value = userFloats.Find(handle);
     
-    if (res == userFloats.end())
+    if (not value)
     {
         std::ostringstream ost;
-        ost << "Candidate::UserFloat: Real-valued property with label \"" << label <<
-          "\" is not defined.";
+        ost << "Candidate::UserFloat: Real-valued property with label \"" <<
+          UserPropertyRegistry::GetLabel(handle) << "\" is not defined.";
         throw std::out_of_range(ost.str());
     }
     else
-        return res->second;
+        return *value;
 }
 
 
 long Candidate::UserInt(std::string const &label) const
 {
-    auto const res = userInts.find(label);
+    return UserInt(UserPropertyRegistry::GetHandle(label));
+}
     
-    if (res == userInts.end())
+
+long Candidate::UserInt(UserPropertyHandle handle) const
+{
+    long const *value = userInts.Find(handle);
+    
+    if (not value)
     {
         std::ostringstream ost;
-        ost << "Candidate::UserInt: Integer-valued property with label \"" << label <<
-          "\" is not defined.";
+        ost << "Candidate::UserInt: Integer-valued property with label \"" <<
+          UserPropertyRegistry::GetLabel(handle) << "\" is not defined.";
         throw std::out_of_range(ost.str());
     }
     else
-        return res->second;
+        return *value;
 }
 
 
@@ -130,7 +160,7 @@ Lepton::Lepton() noexcept:
 {}
 
 
-Lepton::Lepton(Lepton::Flavour flavour_, TLorentzVector const &p4) noexcept:
+Lepton::Lepton(Lepton::Flavour flavour_, PtEtaPhiMVector const &p4) noexcept:
     Candidate(p4),
     flavour(flavour_),
     relIso(-1.), charge(0)
@@ -171,6 +201,7 @@ int Lepton::Charge() const noexcept
 Jet::Jet() noexcept:
     Candidate(),
     rawMomentumSF(0.),
+    bTagValues{},
     flavours{0, 0, 0},
     charge(-10.), pullAngle(-10.),
     puDiscriminator(0.),
@@ -178,9 +209,10 @@ Jet::Jet() noexcept:
 {}
 
 
-Jet::Jet(TLorentzVector const &correctedP4) noexcept:
+Jet::Jet(PtEtaPhiMVector const &correctedP4) noexcept:
     Candidate(correctedP4),
     rawMomentumSF(0.),
+    bTagValues{},
     flavours{0, 0, 0},
     charge(-10.), pullAngle(-10.),
     puDiscriminator(0.),
@@ -188,9 +220,10 @@ Jet::Jet(TLorentzVector const &correctedP4) noexcept:
 {}
 
 
-Jet::Jet(TLorentzVector const &rawP4, double corrSF) noexcept:
+Jet::Jet(PtEtaPhiMVector const &rawP4, double corrSF) noexcept:
     Candidate(rawP4 * corrSF),
     rawMomentumSF(1. / corrSF),
+    bTagValues{},
     flavours{0, 0, 0},
     charge(-10.), pullAngle(-10.),
     puDiscriminator(0.),
@@ -198,7 +231,7 @@ Jet::Jet(TLorentzVector const &rawP4, double corrSF) noexcept:
 {}
 
 
-void Jet::SetCorrectedP4(TLorentzVector const &correctedP4, double rawMomentumSF_) noexcept
+void Jet::SetCorrectedP4(PtEtaPhiMVector const &correctedP4, double rawMomentumSF_) noexcept
 {
     SetP4(correctedP4);
     rawMomentumSF = rawMomentumSF_;
@@ -207,7 +240,8 @@ void Jet::SetCorrectedP4(TLorentzVector const &correctedP4, double rawMomentumSF
 
 void Jet::SetBTag(BTagger::Algorithm algo, double value) noexcept
 {
-    bTagValues[algo] = value;
+    bTagValues[unsigned(algo)] = value;
+    bTagSet.set(unsigned(algo));
 }
 
 
@@ -263,19 +297,17 @@ void Jet::SetPileUpID(double puDiscriminator_)
 
 TLorentzVector Jet::RawP4() const noexcept
 {
-    return P4() * rawMomentumSF;
+    return CompactP4() * rawMomentumSF;
 }
 
 
 double Jet::BTag(BTagger::Algorithm algo) const
 {
-    auto const res = bTagValues.find(algo);
-    
-    if (res == bTagValues.end())
+    if (not bTagSet.test(unsigned(algo)))
         throw std::runtime_error("Jet::BTag: No value of b-tagging discriminator is available "s +
           "for algorithm " + BTagger::AlgorithmToTextCode(algo) + ".");
     
-    return res->second;
+    return bTagValues[unsigned(algo)];
 }
 
 
@@ -349,7 +381,7 @@ GenJet::GenJet() noexcept:
 {}
 
 
-GenJet::GenJet(TLorentzVector const &p4) noexcept:
+GenJet::GenJet(PtEtaPhiMVector const &p4) noexcept:
     Candidate(p4),
     bMult(0), cMult(0)
 {}
@@ -381,7 +413,7 @@ ShowerParton::ShowerParton() noexcept:
 {}
 
 
-ShowerParton::ShowerParton(TLorentzVector const &p4_, int pdgId_,
+ShowerParton::ShowerParton(PtEtaPhiMVector const &p4_, int pdgId_,
  Origin origin_ /*= Origin::Unknown*/) noexcept:
     Candidate(p4_),
     pdgId(pdgId_), origin(origin_)
@@ -12,17 +12,20 @@ PileUpReader::~PileUpReader()
 
 unsigned PileUpReader::GetNumVertices() const
 {
+    LoadPendingEvent();
     return numVertices;
 }
 
 
 double PileUpReader::GetExpectedPileUp() const
 {
+    LoadPendingEvent();
     return expectedPileUp;
 }
 
 
 double PileUpReader::GetRho() const
 {
+    LoadPendingEvent();
     return rho;
 }
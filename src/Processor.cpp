@@ -1,9 +1,15 @@
 #include <mensura/Processor.hpp>
 
+#include <mensura/BatchPlugin.hpp>
+#include <mensura/EventIDReader.hpp>
+#include <mensura/EventWeightPlugin.hpp>
 #include <mensura/Logger.hpp>
+#include <mensura/ReaderPlugin.hpp>
 #include <mensura/ROOTLock.hpp>
 #include <mensura/RunManager.hpp>
 
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
 #include <mutex>
 #include <sstream>
@@ -17,8 +23,12 @@ using namespace logging;
 
 Processor::PluginInPath::PluginInPath(Plugin *plugin_):
     plugin(plugin_),
-    lastResult(true),
-    numVisited(0), numPassed(0)
+    skipTarget(0), passedEvent(0),
+    isReader(dynamic_cast<ReaderPlugin const *>(plugin_) != nullptr),
+    batchPlugin(dynamic_cast<BatchPlugin *>(plugin_)),
+    blockPos(0),
+    numVisited(0), numPassed(0),
+    time(0)
 {}
 
 
@@ -28,11 +38,30 @@ Plugin *Processor::PluginInPath::operator->() const
 }
 
 
+Processor::Processor():
+    manager(nullptr), slot(0),
+    datasetLookAhead(false), hasNextDataset(false),
+    eventCounter(0), eventArena(new EventArena),
+    measureStages(false),
+    readerTime(0), analysisTime(0), numEventsRead(0),
+    adaptiveOrderingWindow(0), pathReordered(false), eventCounterAtReorder(0)
+{}
+
+
 Processor::Processor(Processor &&src) noexcept:
-    manager(src.manager),
+    manager(src.manager), slot(src.slot),
     services(move(src.services)),
     path(move(src.path)),
-    pluginNameMap(move(src.pluginNameMap))
+    pluginNameMap(move(src.pluginNameMap)),
+    batchPluginIndices(move(src.batchPluginIndices)),
+    datasetLookAhead(src.datasetLookAhead), hasNextDataset(false),
+    eventCounter(0), eventArena(move(src.eventArena)),
+    measureStages(src.measureStages),
+    readerTime(0), analysisTime(0), numEventsRead(0),
+    adaptiveOrderingWindow(src.adaptiveOrderingWindow), pathReordered(src.pathReordered),
+    eventCounterAtReorder(src.eventCounterAtReorder),
+    originalPath(move(src.originalPath)),
+    reorderedPlugins(move(src.reorderedPlugins))
 {
     // Prevent the source object from deleting the plugins
     src.path.clear();
@@ -48,8 +77,14 @@ Processor::Processor(Processor &&src) noexcept:
 
 
 Processor::Processor(Processor const &src):
-    manager(src.manager),
-    pluginNameMap(src.pluginNameMap)
+    manager(src.manager), slot(src.slot),
+    pluginNameMap(src.pluginNameMap),
+    datasetLookAhead(src.datasetLookAhead), hasNextDataset(false),
+    eventCounter(0), eventArena(new EventArena),
+    measureStages(src.measureStages),
+    readerTime(0), analysisTime(0), numEventsRead(0),
+    adaptiveOrderingWindow(src.adaptiveOrderingWindow), pathReordered(false),
+    eventCounterAtReorder(0)
 {
     // Copy services and plugins
     for (auto const &s: src.services)
@@ -62,6 +97,8 @@ Processor::Processor(Processor const &src):
         path.back().dependencies = p.dependencies;
     }
     
+    BuildExecutionPlan();
+    
     
     // Update the master in services and plugins
     for (auto &s: services)
@@ -134,6 +171,7 @@ void Processor::RegisterPlugin(Plugin *plugin,
     // Insert the plugin into the path
     path.emplace_back(plugin);
     path.back().dependencies = depIndices;
+    BuildExecutionPlan();
     
     
     // Set this as its master
@@ -161,6 +199,8 @@ void Processor::RegisterPlugin(Plugin *plugin)
     if (curIndex > 0)
         path.back().dependencies.push_back(curIndex - 1);
     
+    BuildExecutionPlan();
+    
     
     // Introduce this to the plugin
     plugin->SetMaster(this);
@@ -175,25 +215,26 @@ void Processor::operator()()
           "RunManager has been specified.");
     
     
-    // Read datasets from the queue in the manager one by one
-    while (true)
+    // Request datasets from the manager one by one. If look-ahead is enabled, the next dataset is
+    //requested before the current one is processed so that plugins can prepare it. This is not
+    //done with work stealing since the reserved dataset could not be stolen by idle threads
+    bool const lookAhead = (datasetLookAhead and
+      manager->scheduling != RunManager::Scheduling::WorkStealing);
+    Dataset dataset;
+    bool datasetFound = manager->PopDataset(slot, dataset);
+    
+    while (datasetFound)
     {
-        // Safely pop a dataset from the queue
-        manager->mutexDatasets.lock();
+        hasNextDataset = (lookAhead and manager->PopDataset(slot, nextDataset));
+        ProcessDataset(dataset);
         
-        if (manager->datasets.empty())  // no more datasets to process
+        if (hasNextDataset)
         {
-            manager->mutexDatasets.unlock();
-            return;
+            dataset = nextDataset;
+            hasNextDataset = false;
         }
-        
-        Dataset dataset(manager->datasets.front());
-        manager->datasets.pop();
-        manager->mutexDatasets.unlock();
-        
-        
-        // Process the dataset
-        ProcessDataset(dataset);
+        else
+            datasetFound = manager->PopDataset(slot, dataset);
     }
 }
 
@@ -205,7 +246,13 @@ void Processor::OpenDataset(Dataset const &dataset)
         s.second->BeginRun(dataset);
      
     for (auto &p: path)
+    {
         p->BeginRun(dataset);
+        
+        // Blocks of events evaluated for the previous dataset are no longer valid
+        p.blockMask.clear();
+        p.blockPos = 0;
+    }
 }
 
 
@@ -216,41 +263,108 @@ Plugin::EventOutcome Processor::ProcessEvent()
     //^ This initialization allows to terminate processing of the dataset when there are no plugins
     //registered
     
+    // Decisions of plugins are tagged with the index of the current event
+    ++eventCounter;
     
-    // Process event with all plugins
-    for (auto &p: path)
+    // Memory allocated for the previous event is not needed any more
+    eventArena->Reset();
+    
+    // Check if statistics for adaptive ordering of the path are being collected
+    bool const observing = (adaptiveOrderingWindow > 0 and not pathReordered);
+    
+    
+    // Process event with all plugins. When a plugin rejects the event or cannot be executed, jump
+    //over all plugins that depend on it
+    unsigned i = 0;
+    
+    while (i < path.size())
     {
+        auto &p = path[i];
+        
         // Determine whether the current plugin should be executed for the current event
         bool runPlugin = true;
         
         for (auto const &depIndex: p.dependencies)
         {
-            if (not path[depIndex].lastResult)
+            if (path[depIndex].passedEvent != eventCounter)
             {
                 runPlugin = false;
                 break;
             }
         }
         
+        if (not runPlugin)
+        {
+            i = p.skipTarget;
+            continue;
+        }
+        
+        
+        // Execute the plugin
+        auto const start = (measureStages or observing) ?
+          std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
         
-        // Execute the plugin and save its result. If it is not executed, the result is set to
-        //false to prevent execution of other plugins that depend on it
-        if (runPlugin)
+        if (p.batchPlugin)
         {
-            result = p->ProcessEventToOutcome();
-            p.lastResult = (result == Plugin::EventOutcome::Ok);
-            ++p.numVisited;
+            // Evaluate a new block of events if the current one has been exhausted. Then look up
+            //the decision for the current event in the selection mask
+            if (p.blockPos == p.blockMask.size())
+            {
+                p.batchPlugin->EvaluateBlock(p.blockMask);
+                p.blockPos = 0;
+            }
             
-            if (p.lastResult)
-                ++p.numPassed;
+            result = (p.blockMask[p.blockPos]) ?
+              Plugin::EventOutcome::Ok : Plugin::EventOutcome::FilterFailed;
         }
         else
-            p.lastResult = false;
+            result = p->ProcessEventToOutcome();
+        
+        if (measureStages or observing)
+        {
+            auto const duration = std::chrono::steady_clock::now() - start;
+            
+            if (observing)
+                p.time += duration;
+            
+            if (measureStages)
+            {
+                if (p.isReader)
+                    readerTime += duration;
+                else
+                    analysisTime += duration;
+            }
+        }
         
+        ++p.numVisited;
         
-        // Stop executing the path if a reader has returned false
-        if (result == Plugin::EventOutcome::NoEvents)
+        
+        // Choose the next plugin to execute. Stop executing the path if a reader has returned
+        //false
+        if (result == Plugin::EventOutcome::Ok)
+        {
+            p.passedEvent = eventCounter;
+            ++p.numPassed;
+            ++i;
+        }
+        else if (result == Plugin::EventOutcome::NoEvents)
             break;
+        else
+            i = p.skipTarget;
+    }
+    
+    
+    // Move to the next event in the current blocks of batch plugins. This is done even for plugins
+    //that have not been executed since a block covers all events read consecutively
+    if (result != Plugin::EventOutcome::NoEvents)
+    {
+        for (unsigned const index: batchPluginIndices)
+        {
+            auto &p = path[index];
+            
+            if (p.blockPos < p.blockMask.size())
+                ++p.blockPos;
+        }
     }
     
     
@@ -264,7 +378,17 @@ Plugin::EventOutcome Processor::ProcessEvent()
         
         for (auto &s: services)
             s.second->EndRun();
+        
+        if (measureStages)
+            ReportStageThroughput();
     }
+    else
+        ++numEventsRead;
+    
+    
+    // Reorder the path when enough statistics has been collected
+    if (observing and eventCounter >= adaptiveOrderingWindow)
+        ReorderPath();
     
     
     // Return the outcome of this event
@@ -274,8 +398,17 @@ Plugin::EventOutcome Processor::ProcessEvent()
 
 void Processor::ProcessDataset(Dataset const &dataset)
 {
-    logger << timestamp << "Start processing source file " <<
-     dataset.GetFiles().front() << "." << eom;
+    std::ostringstream source;
+    source << "source file " << dataset.GetFiles().front();
+    
+    if (dataset.GetFiles().size() > 1)
+        source << " and " << dataset.GetFiles().size() - 1 << " subsequent file(s)";
+    
+    if (dataset.HasEntryRange())
+        logger << timestamp << "Start processing entries from " << dataset.GetFirstEntry() <<
+          " to " << dataset.GetLastEntry() << " in " << source.str() << "." << eom;
+    else
+        logger << timestamp << "Start processing " << source.str() << "." << eom;
     
     OpenDataset(dataset);
     
@@ -284,6 +417,64 @@ void Processor::ProcessDataset(Dataset const &dataset)
 }
 
 
+void Processor::EndJob()
+{
+    for (auto &s: services)
+        s.second->EndJob();
+}
+
+
+void Processor::MeasureStageThroughput(bool enable /*= true*/)
+{
+    measureStages = enable;
+}
+
+
+void Processor::SetAdaptiveOrdering(unsigned long numEventsObserve)
+{
+    adaptiveOrderingWindow = numEventsObserve;
+}
+
+
+void Processor::ReportAdaptiveOrdering() const
+{
+    if (not pathReordered)
+        return;
+    
+    
+    // Estimate time saved from the reduction in the number of visits of plugins that have been
+    //made dependent on filters
+    unsigned long const numEvents = eventCounter - eventCounterAtReorder;
+    double timeSaved = 0.;
+    
+    for (auto const &r: reorderedPlugins)
+    {
+        double const numVisitedExpected = r.visitRate * numEvents;
+        double const numVisited = path[GetPluginIndex(r.name)].numVisited - r.numVisitedAtReorder;
+        
+        if (numVisitedExpected > numVisited)
+            timeSaved += (numVisitedExpected - numVisited) * r.meanTime;
+    }
+    
+    
+    std::ostringstream message;
+    message << "Path has been reordered adaptively after " << eventCounterAtReorder <<
+      " events. Original path:";
+    
+    for (auto const &name: originalPath)
+        message << " " << name;
+    
+    message << ". New path:";
+    
+    for (auto const &p: path)
+        message << " " << p->GetName();
+    
+    message << ". Estimated time saved in " << numEvents << " subsequent events: " <<
+      std::fixed << std::setprecision(2) << timeSaved << " s.";
+    logger << timestamp << message.str() << eom;
+}
+
+
 Service const *Processor::GetService(string const &name) const
 {
     auto res = services.find(name);
@@ -346,6 +537,13 @@ Plugin const *Processor::GetPluginBefore(string const &name, string const &depen
         throw logic_error("Processor::GetPluginBefore: Requested plugin is executed after the "
          "dependent plugin.");
     
+    // Remember the access in order to respect it when the path is reordered
+    auto &accessedPlugins = path[indexDependent].accessedPlugins;
+    
+    if (std::find(accessedPlugins.begin(), accessedPlugins.end(), indexInterest) ==
+      accessedPlugins.end())
+        accessedPlugins.push_back(indexInterest);
+    
     return path.at(indexInterest).plugin.get();
 }
 
@@ -371,9 +569,90 @@ std::pair<unsigned long, unsigned long> Processor::GetStat(std::string const &pl
 }
 
 
-void Processor::SetManager(RunManager *manager_)
+std::pmr::memory_resource *Processor::GetEventArena() const
+{
+    return eventArena.get();
+}
+
+
+Dataset const *Processor::GetNextDataset() const
+{
+    return (hasNextDataset) ? &nextDataset : nullptr;
+}
+
+
+bool Processor::HasPassed(std::string const &pluginName) const
+{
+    return (path[GetPluginIndex(pluginName)].passedEvent == eventCounter);
+}
+
+
+void Processor::SetDatasetLookAhead(bool enable /*= true*/)
+{
+    datasetLookAhead = enable;
+}
+
+
+void Processor::SetManager(RunManager *manager_, unsigned slot_ /*= 0*/)
 {
     manager = manager_;
+    slot = slot_;
+}
+
+
+void Processor::BuildExecutionPlan()
+{
+    // Find all plugins on which each plugin depends, directly or indirectly
+    auto const ancestors = FindAncestors(false);
+    
+    
+    // For each plugin find the first subsequent plugin that does not depend on it. All plugins
+    //in between can be skipped when the plugin rejects an event
+    batchPluginIndices.clear();
+    
+    for (unsigned i = 0; i < path.size(); ++i)
+    {
+        unsigned target = i + 1;
+        
+        while (target < path.size() and ancestors[target][i])
+            ++target;
+        
+        path[i].skipTarget = target;
+        
+        if (path[i].batchPlugin)
+            batchPluginIndices.push_back(i);
+    }
+}
+
+
+std::vector<std::vector<bool>> Processor::FindAncestors(bool includeAccessed) const
+{
+    // Since dependencies always precede the dependent plugin in the path, a single pass is
+    //sufficient
+    std::vector<std::vector<bool>> ancestors(path.size());
+    
+    for (unsigned i = 0; i < path.size(); ++i)
+    {
+        ancestors[i].resize(i, false);
+        std::vector<unsigned> parents(path[i].dependencies);
+        
+        if (includeAccessed)
+            parents.insert(parents.end(), path[i].accessedPlugins.begin(),
+              path[i].accessedPlugins.end());
+        
+        for (unsigned const parentIndex: parents)
+        {
+            ancestors[i][parentIndex] = true;
+            
+            for (unsigned j = 0; j < parentIndex; ++j)
+            {
+                if (ancestors[parentIndex][j])
+                    ancestors[i][j] = true;
+            }
+        }
+    }
+    
+    return ancestors;
 }
 
 
@@ -394,3 +673,132 @@ unsigned Processor::GetPluginIndex(string const &name) const
     
     return index;
 }
+
+
+void Processor::ReorderPath()
+{
+    using seconds = std::chrono::duration<double>;
+    
+    pathReordered = true;
+    eventCounterAtReorder = eventCounter;
+    originalPath = GetPath();
+    
+    
+    // Select filters that have rejected some events and order them according to the fraction of
+    //rejected events per unit time
+    std::vector<std::pair<double, Plugin const *>> filters;
+    
+    for (auto const &p: path)
+    {
+        if (p.isReader or p.numVisited == 0 or p.numPassed == p.numVisited)
+            continue;
+        
+        double const rejectedFraction = 1. - double(p.numPassed) / p.numVisited;
+        double const meanTime =
+          std::chrono::duration_cast<seconds>(p.time).count() / p.numVisited;
+        filters.emplace_back(rejectedFraction / std::max(meanTime, 1e-9), p.plugin.get());
+    }
+    
+    std::sort(filters.begin(), filters.end(),
+      [](auto const &lhs, auto const &rhs){return (lhs.first > rhs.first);});
+    
+    
+    // Move each filter towards the beginning of the path as far as dependencies allow
+    for (auto const &filter: filters)
+    {
+        unsigned filterIndex = GetPluginIndex(filter.second->GetName());
+        
+        while (filterIndex > 0)
+        {
+            unsigned const prevIndex = filterIndex - 1;
+            auto const ancestors = FindAncestors(true);
+            
+            if (ancestors[filterIndex][prevIndex])
+                break;
+            
+            
+            // Check if the preceding plugin can be made dependent on the filter. It must be a
+            //producer whose output is only used by plugins that depend on the filter anyway
+            auto &prev = path[prevIndex];
+            bool makeDependent = ((prev.isReader and
+              not dynamic_cast<EventIDReader const *>(prev.plugin.get())) or
+              dynamic_cast<EventWeightPlugin const *>(prev.plugin.get()));
+            bool hasDependants = false;
+            
+            for (unsigned i = filterIndex + 1; i < path.size() and makeDependent; ++i)
+            {
+                if (ancestors[i][prevIndex])
+                {
+                    hasDependants = true;
+                    
+                    if (not ancestors[i][filterIndex])
+                        makeDependent = false;
+                }
+            }
+            
+            makeDependent = (makeDependent and hasDependants);
+            
+            
+            // Swap the two plugins and update all indices that refer to them
+            std::swap(path[prevIndex], path[filterIndex]);
+            
+            for (auto &p: path)
+            {
+                for (auto *indices: {&p.dependencies, &p.accessedPlugins})
+                {
+                    for (auto &index: *indices)
+                    {
+                        if (index == prevIndex)
+                            index = filterIndex;
+                        else if (index == filterIndex)
+                            index = prevIndex;
+                    }
+                }
+            }
+            
+            pluginNameMap[path[prevIndex]->GetName()] = prevIndex;
+            pluginNameMap[path[filterIndex]->GetName()] = filterIndex;
+            
+            
+            // The plugin that has been moved down now follows the filter
+            if (makeDependent)
+            {
+                auto &moved = path[filterIndex];
+                moved.dependencies.push_back(prevIndex);
+                
+                bool const known = std::any_of(reorderedPlugins.begin(), reorderedPlugins.end(),
+                  [&moved](auto const &r){return (r.name == moved->GetName());});
+                
+                if (not known and moved.numVisited > 0)
+                    reorderedPlugins.push_back({moved->GetName(),
+                      double(moved.numVisited) / eventCounter,
+                      std::chrono::duration_cast<seconds>(moved.time).count() / moved.numVisited,
+                      moved.numVisited});
+            }
+            
+            filterIndex = prevIndex;
+        }
+    }
+    
+    BuildExecutionPlan();
+}
+
+
+void Processor::ReportStageThroughput()
+{
+    using seconds = std::chrono::duration<double>;
+    double const readerSeconds = std::chrono::duration_cast<seconds>(readerTime).count();
+    double const analysisSeconds = std::chrono::duration_cast<seconds>(analysisTime).count();
+    
+    std::ostringstream message;
+    message << std::fixed << std::setprecision(1) << "Throughput of processing stages for " <<
+      numEventsRead << " events: reading " <<
+      ((readerSeconds > 0.) ? numEventsRead / readerSeconds : 0.) << " events/s (" <<
+      readerSeconds << " s), analysis " <<
+      ((analysisSeconds > 0.) ? numEventsRead / analysisSeconds : 0.) << " events/s (" <<
+      analysisSeconds << " s).";
+    logger << timestamp << message.str() << eom;
+    
+    readerTime = analysisTime = std::chrono::steady_clock::duration(0);
+    numEventsRead = 0;
+}
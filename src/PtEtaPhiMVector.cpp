@@ -0,0 +1,120 @@
+#include <mensura/PtEtaPhiMVector.hpp>
+
+#include <TMath.h>
+
+#include <algorithm>
+#include <cmath>
+
+
+PtEtaPhiMVector::PtEtaPhiMVector() noexcept:
+    pt(0.), eta(0.), phi(0.), mass(0.)
+{}
+
+
+PtEtaPhiMVector::PtEtaPhiMVector(double pt_, double eta_, double phi_, double mass_) noexcept
+{
+    SetPtEtaPhiM(pt_, eta_, phi_, mass_);
+}
+
+
+PtEtaPhiMVector::PtEtaPhiMVector(TLorentzVector const &p4) noexcept
+{
+    SetPxPyPzE(p4.Px(), p4.Py(), p4.Pz(), p4.E());
+}
+
+
+double PtEtaPhiMVector::E() const noexcept
+{
+    double const pz = Pz();
+    double const p2 = double(pt) * pt + pz * pz;
+    
+    // Follow TLorentzVector::SetXYZM in the treatment of negative mass
+    if (mass >= 0.)
+        return std::sqrt(p2 + mass * mass);
+    else
+        return std::sqrt(std::max(p2 - mass * mass, 0.));
+}
+
+
+double PtEtaPhiMVector::Px() const noexcept
+{
+    return pt * std::cos(phi);
+}
+
+
+double PtEtaPhiMVector::Py() const noexcept
+{
+    return pt * std::sin(phi);
+}
+
+
+double PtEtaPhiMVector::Pz() const noexcept
+{
+    // The longitudinal momentum of a vector with zero pt is not stored
+    if (pt == 0.)
+        return 0.;
+    
+    return pt * std::sinh(eta);
+}
+
+
+void PtEtaPhiMVector::SetPxPyPzE(double px, double py, double pz, double E) noexcept
+{
+    double const pt2 = px * px + py * py;
+    pt = std::sqrt(pt2);
+    phi = (px == 0. and py == 0.) ? 0. : std::atan2(py, px);
+    
+    
+    // Pseudorapidity is computed in the same way as in TVector3::PseudoRapidity
+    double const p = std::sqrt(pt2 + pz * pz);
+    double const cosTheta = (p == 0.) ? 1. : pz / p;
+    
+    if (cosTheta * cosTheta < 1.)
+        eta = -0.5 * std::log((1. - cosTheta) / (1. + cosTheta));
+    else if (pz == 0.)
+        eta = 0.;
+    else
+        eta = (pz > 0.) ? 10e10 : -10e10;
+    
+    
+    double const m2 = E * E - p * p;
+    mass = (m2 < 0.) ? -std::sqrt(-m2) : std::sqrt(m2);
+}
+
+
+void PtEtaPhiMVector::SetPtEtaPhiM(double pt_, double eta_, double phi_, double mass_) noexcept
+{
+    pt = std::abs(pt_);
+    eta = eta_;
+    
+    // Usually the angle is already in the correct range, so avoid the computation in this case
+    if (phi_ < -TMath::Pi() or phi_ > TMath::Pi())
+        phi_ = std::remainder(phi_, TMath::TwoPi());
+    
+    phi = phi_;
+    mass = mass_;
+}
+
+
+PtEtaPhiMVector::operator TLorentzVector() const
+{
+    TLorentzVector p4;
+    p4.SetPtEtaPhiM(pt, eta, phi, mass);
+    return p4;
+}
+
+
+PtEtaPhiMVector &PtEtaPhiMVector::operator*=(double factor) noexcept
+{
+    pt *= factor;
+    mass *= factor;
+    return *this;
+}
+
+
+PtEtaPhiMVector PtEtaPhiMVector::operator*(double factor) const noexcept
+{
+    PtEtaPhiMVector res(*this);
+    res *= factor;
+    return res;
+}
@@ -2,7 +2,8 @@
 
 
 ReaderPlugin::ReaderPlugin(std::string const &name):
-    Plugin(name)
+    Plugin(name),
+    eventPending(false)
 {}
 
 
@@ -10,6 +11,28 @@ ReaderPlugin::~ReaderPlugin()
 {}
 
 
+void ReaderPlugin::LoadPendingEvent() const
+{
+    if (eventPending)
+    {
+        // Reset the flag first so that the event is not unpacked again if UnpackEvent accesses
+        //the content of the current event
+        eventPending = false;
+        const_cast<ReaderPlugin *>(this)->UnpackEvent();
+    }
+}
+
+
+void ReaderPlugin::SetEventPending()
+{
+    eventPending = true;
+}
+
+
+void ReaderPlugin::UnpackEvent()
+{}
+
+
 Plugin::EventOutcome ReaderPlugin::ReinterpretDecision(bool decision) const
 {
     if (decision)
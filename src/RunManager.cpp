@@ -2,11 +2,23 @@
 
 #include <mensura/Logger.hpp>
 
+#include <TFile.h>
 #include <TROOT.h>
+#include <TTree.h>
 
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <functional>
+#include <sstream>
 #include <stdexcept>
 #include <thread>
 #include <vector>
@@ -22,6 +34,17 @@ RunManager::PluginStat::PluginStat(std::string const &pluginName_):
 {}
 
 
+RunManager::WorkQueue::WorkQueue():
+    totalCost(0.)
+{}
+
+
+RunManager::ThreadStat::ThreadStat():
+    waitTime(0.),
+    numDatasets(0), numStolen(0)
+{}
+
+
 //RunManager::RunManager(InputIt const &begin, const &InputIt end);
 //^ Described in the header file
 
@@ -49,20 +72,186 @@ void RunManager::PrintSummary() const
 }
 
 
-void RunManager::Process(int nThreads)
+void RunManager::Process(int nThreads, Scheduling scheduling_ /*= Scheduling::Queue*/)
 {
     // Simply forward to the implementation
-    ProcessImp(nThreads);
+    ProcessImp(nThreads, scheduling_);
 }
 
 
-void RunManager::Process(double loadFraction)
+void RunManager::Process(double loadFraction, Scheduling scheduling_ /*= Scheduling::Queue*/)
 {
     // Number of supported concurrent threads (note that it is only a hint)
     unsigned const nMaxThreads = thread::hardware_concurrency();
     
     // Call the implementation
-    ProcessImp(loadFraction * nMaxThreads);
+    ProcessImp(loadFraction * nMaxThreads, scheduling_);
+}
+
+
+void RunManager::ProcessForked(int nProcesses)
+{
+    if (nProcesses < 1)
+        throw runtime_error("RunManager::ProcessForked: Requested number of processes is less "
+          "than one.");
+    
+    nProcesses = PrepareDatasets(nProcesses);
+    
+    
+    // Distribute datasets among the workers in advance since they will not share memory
+    scheduling = Scheduling::WorkStealing;
+    threadStat.assign(nProcesses, ThreadStat());
+    SeedWorkQueues(nProcesses, true);
+    
+    
+    // Start the workers. The output buffer is flushed so that its content is not duplicated in
+    //the children
+    std::cout.flush();
+    std::vector<std::pair<pid_t, int>> workers;
+    
+    
+    // If not all workers can be started, the ones that are already running are killed and reaped
+    //before an exception is thrown
+    auto terminateWorkers = [&workers]()
+    {
+        for (auto const &w: workers)
+        {
+            kill(w.first, SIGKILL);
+            close(w.second);
+            
+            while (waitpid(w.first, nullptr, 0) < 0 and errno == EINTR);
+        }
+        
+        workers.clear();
+    };
+    
+    for (int slot = 0; slot < nProcesses; ++slot)
+    {
+        int fd[2];
+        
+        if (pipe(fd) != 0)
+        {
+            std::string const error(strerror(errno));
+            terminateWorkers();
+            throw runtime_error("RunManager::ProcessForked: Failed to create a pipe. "s + error);
+        }
+        
+        pid_t const pid = fork();
+        
+        if (pid < 0)
+        {
+            std::string const error(strerror(errno));
+            close(fd[0]);
+            close(fd[1]);
+            terminateWorkers();
+            throw runtime_error("RunManager::ProcessForked: Failed to fork a worker process. "s +
+              error);
+        }
+        
+        if (pid == 0)
+        {
+            // This is the worker process. Terminate it without returning to the caller and without
+            //running destructors of objects inherited from the parent
+            close(fd[0]);
+            int const status = RunWorker(slot, fd[1]);
+            std::cout.flush();
+            _exit(status);
+        }
+        
+        close(fd[1]);
+        workers.emplace_back(pid, fd[0]);
+    }
+    
+    
+    // Collect statistics from the workers. Counts are summed up for plugins with the same names
+    std::map<std::string, std::pair<unsigned long, unsigned long>> counts;
+    unsigned numFailed = 0;
+    
+    for (unsigned slot = 0; slot < workers.size(); ++slot)
+    {
+        std::string report;
+        char buffer[4096];
+        
+        while (true)
+        {
+            ssize_t const n = read(workers[slot].second, buffer, sizeof(buffer));
+            
+            if (n > 0)
+                report.append(buffer, n);
+            else if (n == 0 or errno != EINTR)
+                break;
+        }
+        
+        close(workers[slot].second);
+        
+        int status = 0;
+        pid_t waitResult;
+        
+        while ((waitResult = waitpid(workers[slot].first, &status, 0)) < 0 and errno == EINTR);
+        
+        if (waitResult < 0)
+        {
+            logger << "Error in RunManager::ProcessForked: Failed to wait for worker process " <<
+              slot << ". " << strerror(errno) << eom;
+            ++numFailed;
+            continue;
+        }
+        
+        if (not WIFEXITED(status) or WEXITSTATUS(status) != 0 or report.empty())
+        {
+            ++numFailed;
+            continue;
+        }
+        
+        
+        // Parse the report. It starts with the number of processed datasets, which is followed by
+        //names of plugins and their counts, on separate lines
+        std::istringstream input(report);
+        input >> threadStat[slot].numDatasets;
+        input.ignore();
+        std::string pluginName;
+        
+        while (std::getline(input, pluginName))
+        {
+            unsigned long numVisited, numPassed;
+            input >> numVisited >> numPassed;
+            input.ignore();
+            
+            auto &c = counts[pluginName];
+            c.first += numVisited;
+            c.second += numPassed;
+        }
+    }
+    
+    if (numFailed > 0)
+    {
+        std::ostringstream message;
+        message << "RunManager::ProcessForked: " << numFailed << " out of " << workers.size() <<
+          " worker processes have failed.";
+        throw runtime_error(message.str());
+    }
+    
+    logger << timestamp << "All files have been processed." << eom;
+    logger << "Numbers of atomic datasets processed by worker processes:";
+    
+    for (auto const &stat: threadStat)
+        logger << " " << stat.numDatasets;
+    
+    logger << eom;
+    
+    
+    // Save plugin statistics. The template processor has not been used in this process, but it
+    //provides the original order of plugins
+    std::vector<std::string> const pluginNames = templateProcessor.GetPath();
+    pathStat.reserve(pluginNames.size());
+    
+    for (auto const &pluginName: pluginNames)
+    {
+        PluginStat stat(pluginName);
+        stat.numVisited = counts[pluginName].first;
+        stat.numPassed = counts[pluginName].second;
+        pathStat.emplace_back(std::move(stat));
+    }
 }
 
 
@@ -85,21 +274,300 @@ void RunManager::RegisterPlugin(Plugin *plugin)
 }
 
 
-void RunManager::ProcessImp(int nThreads)
+void RunManager::MeasureStageThroughput(bool enable /*= true*/)
+{
+    templateProcessor.MeasureStageThroughput(enable);
+}
+
+
+void RunManager::SetAdaptiveOrdering(unsigned long numEventsObserve)
+{
+    templateProcessor.SetAdaptiveOrdering(numEventsObserve);
+}
+
+
+void RunManager::SetDatasetLookAhead(bool enable /*= true*/)
+{
+    templateProcessor.SetDatasetLookAhead(enable);
+}
+
+
+void RunManager::SetEventBatching(std::string const &treeName,
+  unsigned batchesPerThread_ /*= 4*/, unsigned long minBatchSize_ /*= 10000*/)
+{
+    if (batchesPerThread_ > 0 and maxEventsPerRange > 0 and treeName != rangeTreeName)
+        throw logic_error("RunManager::SetEventBatching: Entries are to be counted in tree \""s +
+          treeName + "\" while tree \"" + rangeTreeName + "\" has been given to "
+          "SetMaxEventsPerRange.");
+    
+    rangeTreeName = treeName;
+    batchesPerThread = batchesPerThread_;
+    minBatchSize = minBatchSize_;
+}
+
+
+void RunManager::SetMaxClones(unsigned maxClones_)
+{
+    maxClones = maxClones_;
+}
+
+
+void RunManager::SetMaxFilesPerDataset(unsigned maxFiles)
+{
+    maxFilesPerDataset = maxFiles;
+}
+
+
+void RunManager::SetMaxEventsPerRange(unsigned long maxEvents, std::string const &treeName)
+{
+    if (maxEvents > 0 and batchesPerThread > 0 and treeName != rangeTreeName)
+        throw logic_error("RunManager::SetMaxEventsPerRange: Entries are to be counted in tree "
+          "\""s + treeName + "\" while tree \"" + rangeTreeName + "\" has been given to "
+          "SetEventBatching.");
+    
+    maxEventsPerRange = maxEvents;
+    rangeTreeName = treeName;
+}
+
+
+void RunManager::BuildAtomicDatasets()
+{
+    for (auto const &d: sourceDatasets)
+    {
+        auto const &files = d.GetFiles();
+        auto fileIt = files.begin();
+        
+        while (fileIt != files.end())
+        {
+            datasets.push(d.CopyParameters());
+            
+            for (unsigned n = 0; fileIt != files.end() and
+              (maxFilesPerDataset == 0 or n < maxFilesPerDataset); ++n, ++fileIt)
+                datasets.back().AddFile(*fileIt);
+        }
+    }
+    
+    sourceDatasets.clear();
+}
+
+
+double RunManager::EstimateCost(Dataset const &dataset) const
+{
+    double cost = 0.;
+    
+    for (auto const &filePath: dataset.GetFiles())
+    {
+        std::error_code error;
+        auto const fileSize = std::filesystem::file_size(filePath, error);
+        
+        if (error)
+            return 0.;
+        
+        cost += fileSize;
+    }
+    
+    
+    // If only a range of entries is processed, take the fraction of the file it covers. Ranges
+    //are only created for atomic datasets with a single file
+    auto const &filePath = dataset.GetFiles().front();
+    auto const entriesIt = numEntries.find(filePath);
+    
+    if (dataset.HasEntryRange() and entriesIt != numEntries.end() and entriesIt->second > 0)
+    {
+        unsigned long const lastEntry = std::min(dataset.GetLastEntry(), entriesIt->second - 1);
+        
+        if (lastEntry >= dataset.GetFirstEntry())
+            cost *= double(lastEntry - dataset.GetFirstEntry() + 1) / entriesIt->second;
+    }
+    
+    return cost;
+}
+
+
+bool RunManager::PopDataset(unsigned slot, Dataset &dataset)
+{
+    auto const start = chrono::steady_clock::now();
+    auto &stat = threadStat.at(slot);
+    bool found = false;
+    
+    if (scheduling == Scheduling::Queue)
+    {
+        lock_guard<mutex> lock(mutexDatasets);
+        
+        if (not datasets.empty())
+        {
+            dataset = std::move(datasets.front());
+            datasets.pop();
+            found = true;
+        }
+    }
+    else
+    {
+        // First try the own deque, taking the most expensive dataset
+        {
+            auto &ownQueue = *workQueues.at(slot);
+            lock_guard<mutex> lock(ownQueue.mutex);
+            
+            if (not ownQueue.datasets.empty())
+            {
+                ownQueue.totalCost -= ownQueue.datasets.front().first;
+                dataset = std::move(ownQueue.datasets.front().second);
+                ownQueue.datasets.pop_front();
+                found = true;
+            }
+        }
+        
+        
+        // If the own deque is empty, steal the cheapest dataset from the thread that has the
+        //largest amount of work left. Repeat since the victim can run out of work concurrently
+        while (not found)
+        {
+            WorkQueue *victim = nullptr;
+            double maxCost = -1.;
+            
+            for (auto &q: workQueues)
+            {
+                lock_guard<mutex> lock(q->mutex);
+                
+                if (not q->datasets.empty() and q->totalCost > maxCost)
+                {
+                    victim = q.get();
+                    maxCost = q->totalCost;
+                }
+            }
+            
+            if (not victim)  // no work left anywhere
+                break;
+            
+            lock_guard<mutex> lock(victim->mutex);
+            
+            if (not victim->datasets.empty())
+            {
+                victim->totalCost -= victim->datasets.back().first;
+                dataset = std::move(victim->datasets.back().second);
+                victim->datasets.pop_back();
+                found = true;
+                ++stat.numStolen;
+            }
+        }
+    }
+    
+    
+    // Update statistics for the thread
+    auto const end = chrono::steady_clock::now();
+    stat.waitTime += end - start;
+    
+    if (found)
+        ++stat.numDatasets;
+    else
+        stat.finishTime = end;
+    
+    return found;
+}
+
+
+void RunManager::PrintThreadStat() const
+{
+    if (threadStat.empty())
+        return;
+    
+    
+    // Threads that have finished earlier than others have been idle until the last one finished
+    auto lastFinishTime = threadStat.front().finishTime;
+    
+    for (auto const &stat: threadStat)
+        lastFinishTime = max(lastFinishTime, stat.finishTime);
+    
+    
+    logger << "Occupation of threads:\n";
+    logger << "  Thread    Datasets      Stolen    Idle time, s\n";
+    
+    for (unsigned slot = 0; slot < threadStat.size(); ++slot)
+    {
+        auto const &stat = threadStat[slot];
+        chrono::duration<double> const idleTime = stat.waitTime +
+          (lastFinishTime - stat.finishTime);
+        
+        ostringstream line;
+        line << "  " << setw(6) << slot << "  " << setw(10) << stat.numDatasets << "  " <<
+          setw(10) << stat.numStolen << "  " << setw(14) << fixed << setprecision(2) <<
+          idleTime.count() << '\n';
+        logger << line.str();
+    }
+    
+    logger << eom;
+}
+
+
+int RunManager::PrepareDatasets(int nWorkers)
+{
+    if (maxFilesPerDataset != 1 and (maxEventsPerRange > 0 or batchesPerThread > 0))
+        throw logic_error("RunManager::PrepareDatasets: Grouping of input files into atomic "
+          "datasets cannot be combined with splitting of files into ranges of entries.");
+    
+    BuildAtomicDatasets();
+    
+    
+    // Split input files into ranges of entries if requested. When automatic batching is enabled,
+    //the size of ranges is chosen based on the number of workers, but it is not allowed to exceed
+    //the size set explicitly by the user
+    unsigned long maxEvents = maxEventsPerRange;
+    
+    if (batchesPerThread > 0)
+    {
+        unsigned long const batchSize = ChooseBatchSize(nWorkers);
+        
+        if (maxEvents == 0 or batchSize < maxEvents)
+            maxEvents = batchSize;
+    }
+    
+    if (maxEvents > 0)
+        SplitDatasets(maxEvents);
+    
+    if (nWorkers > int(datasets.size()))
+        nWorkers = max<int>(datasets.size(), 1);
+    
+    return nWorkers;
+}
+
+
+void RunManager::ProcessImp(int nThreads, Scheduling scheduling_)
 {
     // Check number of threads for adequacy
     if (nThreads < 1)
         throw runtime_error("RunManager::ProcessImp: Requested number of threads is less than "
          "one.");
     
-    if (nThreads > int(datasets.size()))
-        nThreads = datasets.size();
+    // Choose the number of Processor clones. Threads that are not given to them are put in the
+    //pool for ROOT's implicit multithreading
+    int nClones = (maxClones > 0 and int(maxClones) < nThreads) ? maxClones : nThreads;
+    nClones = PrepareDatasets(nClones);
+    int const nPoolThreads = (maxClones > 0) ? nThreads - nClones : 0;
+    nThreads = nClones;
     
     
     // Enable built-in thread awareness in ROOT
     if (nThreads > 1)
         ROOT::EnableThreadSafety();
     
+    if (nPoolThreads > 0)
+    {
+        if (not ROOT::IsImplicitMTEnabled())
+            ROOT::EnableImplicitMT(nPoolThreads);
+        
+        logger << timestamp << "Processing with " << nClones << " Processor clones. " <<
+          ROOT::GetThreadPoolSize() << " threads are available to ROOT's implicit " <<
+          "multithreading." << eom;
+    }
+    
+    
+    // Set up distribution of datasets among threads
+    scheduling = scheduling_;
+    threadStat.assign(nThreads, ThreadStat());
+    
+    if (scheduling == Scheduling::WorkStealing)
+        SeedWorkQueues(nThreads);
+    
     
     // Create processing objects. The template processor is used as the first one, others are copy-
     //constructed from it
@@ -112,6 +580,9 @@ void RunManager::ProcessImp(int nThreads)
     for (int i = 1; i < nThreads; ++i)
         processors.emplace_back(processors.front());
     
+    for (int i = 0; i < nThreads; ++i)
+        processors[i].SetManager(this, i);
+    
     
     // Put the processors into separate threads
     vector<thread> threads;
@@ -125,6 +596,10 @@ void RunManager::ProcessImp(int nThreads)
         t.join();
     
     logger << timestamp << "All files have been processed." << eom;
+    PrintThreadStat();
+    
+    for (auto const &p: processors)
+        p.ReportAdaptiveOrdering();
     
     
     // Save plugin statistics
@@ -144,4 +619,255 @@ void RunManager::ProcessImp(int nThreads)
         
         pathStat.emplace_back(std::move(stat));
     }
+    
+    
+    // Let services finalize resources shared among their clones, such as partial output files
+    for (auto &p: processors)
+        p.EndJob();
+}
+
+
+void RunManager::SeedWorkQueues(unsigned nThreads, bool keepFilesTogether /*= false*/)
+{
+    // Estimate costs of all datasets and combine them into groups that must be assigned to the
+    //same thread. Unless requested otherwise, each group contains a single dataset
+    struct Group
+    {
+        double cost = 0.;
+        std::vector<std::pair<double, Dataset>> datasets;
+    };
+    
+    std::vector<Group> groups;
+    std::map<std::filesystem::path, unsigned> groupIndices;
+    
+    while (not datasets.empty())
+    {
+        double const cost = EstimateCost(datasets.front());
+        unsigned groupIndex = groups.size();
+        
+        if (keepFilesTogether)
+        {
+            auto const res = groupIndices.emplace(datasets.front().GetFiles().front(),
+              groupIndex);
+            groupIndex = res.first->second;
+        }
+        
+        if (groupIndex == groups.size())
+            groups.emplace_back();
+        
+        groups[groupIndex].cost += cost;
+        groups[groupIndex].datasets.emplace_back(cost, std::move(datasets.front()));
+        datasets.pop();
+    }
+    
+    std::stable_sort(groups.begin(), groups.end(),
+      [](auto const &a, auto const &b){return (a.cost > b.cost);});
+    
+    
+    // Assign each group to the thread with the smallest total cost so far. This is the
+    //longest-processing-time-first rule. Since groups are added in the decreasing cost, each
+    //deque is ordered in the decreasing cost too, apart from datasets within a group
+    workQueues.clear();
+    
+    for (unsigned i = 0; i < nThreads; ++i)
+        workQueues.emplace_back(new WorkQueue);
+    
+    for (auto &g: groups)
+    {
+        auto &q = *std::min_element(workQueues.begin(), workQueues.end(),
+          [](auto const &a, auto const &b){return (a->totalCost < b->totalCost or
+          (a->totalCost == b->totalCost and a->datasets.size() < b->datasets.size()));});
+        //^ The second condition distributes datasets of unknown (zero) cost evenly
+        
+        q->totalCost += g.cost;
+        
+        for (auto &d: g.datasets)
+            q->datasets.emplace_back(std::move(d));
+    }
+}
+
+
+int RunManager::RunWorker(unsigned slot, int outputFD)
+{
+    try
+    {
+        // Forget datasets assigned to other workers so that they are not stolen
+        for (unsigned i = 0; i < workQueues.size(); ++i)
+        {
+            if (i != slot)
+                workQueues[i]->datasets.clear();
+        }
+        
+        
+        // Process datasets. The processor is destroyed before the report is sent so that all
+        //outputs are finalized by the time the parent process learns about the success
+        std::ostringstream report;
+        
+        {
+            Processor processor(std::move(templateProcessor));
+            processor.SetManager(this, slot);
+            processor();
+            processor.ReportAdaptiveOrdering();
+            processor.EndJob();
+            
+            report << threadStat[slot].numDatasets << '\n';
+            
+            for (auto const &pluginName: processor.GetPath())
+            {
+                auto const c = processor.GetStat(pluginName);
+                report << pluginName << '\n' << c.first << ' ' << c.second << '\n';
+            }
+        }
+        
+        
+        // Send the report to the parent process
+        std::string const message(report.str());
+        std::size_t numWritten = 0;
+        
+        while (numWritten < message.size())
+        {
+            ssize_t const n = write(outputFD, message.data() + numWritten,
+              message.size() - numWritten);
+            
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                
+                throw runtime_error("RunManager::RunWorker: Failed to send report to the parent "
+                  "process.");
+            }
+            
+            numWritten += n;
+        }
+        
+        close(outputFD);
+        return 0;
+    }
+    catch (std::exception const &e)
+    {
+        logger << "Worker process " << slot << " has failed with an exception: " << e.what() <<
+          eom;
+        return 1;
+    }
+}
+
+
+unsigned long RunManager::CountEntries(std::filesystem::path const &filePath)
+{
+    auto const res = numEntries.find(filePath);
+    
+    if (res != numEntries.end())
+        return res->second;
+    
+    
+    // This is done before any processing threads are started, so there is no need to lock ROOT
+    std::unique_ptr<TFile> file(TFile::Open(filePath.c_str()));
+    
+    if (not file or file->IsZombie())
+    {
+        std::ostringstream message;
+        message << "RunManager::CountEntries: File " << filePath << " does not exist or " <<
+          "is not a valid ROOT file.";
+        throw std::runtime_error(message.str());
+    }
+    
+    TTree *tree = dynamic_cast<TTree *>(file->Get(rangeTreeName.c_str()));
+    
+    if (not tree)
+    {
+        std::ostringstream message;
+        message << "RunManager::CountEntries: File " << filePath << " does not contain " <<
+          "tree \"" << rangeTreeName << "\".";
+        throw std::runtime_error(message.str());
+    }
+    
+    unsigned long const nEntries = tree->GetEntries();
+    numEntries[filePath] = nEntries;
+    
+    return nEntries;
+}
+
+
+unsigned long RunManager::ChooseBatchSize(int nThreads)
+{
+    // Count all entries to be processed
+    unsigned long nTotal = 0;
+    std::queue<Dataset> datasetsCopy(datasets);
+    
+    while (not datasetsCopy.empty())
+    {
+        auto const &dataset = datasetsCopy.front();
+        unsigned long const nEntries = CountEntries(dataset.GetFiles().front());
+        
+        if (nEntries > dataset.GetFirstEntry())
+            nTotal += std::min(dataset.GetLastEntry(), nEntries - 1) - dataset.GetFirstEntry() + 1;
+        
+        datasetsCopy.pop();
+    }
+    
+    
+    // Aim at the requested number of batches per thread, but do not go below the minimal size
+    unsigned long const nBatches = std::max<unsigned long>(nThreads * batchesPerThread, 1);
+    return std::max((nTotal + nBatches - 1) / nBatches, minBatchSize);
+}
+
+
+void RunManager::SplitDatasets(unsigned long maxEvents)
+{
+    std::queue<Dataset> splitDatasets;
+    unsigned long const nDatasets = datasets.size();
+    
+    while (not datasets.empty())
+    {
+        Dataset dataset(std::move(datasets.front()));
+        datasets.pop();
+        
+        
+        // Number of entries in the (single) file of the atomic dataset
+        unsigned long const nEntries = CountEntries(dataset.GetFiles().front());
+        
+        
+        // Range of entries to be split. It can already be restricted by the user
+        unsigned long const firstEntry = dataset.GetFirstEntry();
+        
+        if (nEntries == 0 or firstEntry >= nEntries)
+        {
+            // Nothing to split. Keep the dataset as is so that plugins and services are still
+            //notified about it
+            splitDatasets.emplace(std::move(dataset));
+            continue;
+        }
+        
+        unsigned long const lastEntry = std::min(dataset.GetLastEntry(), nEntries - 1);
+        unsigned long const nSelected = lastEntry - firstEntry + 1;
+        
+        
+        // Choose the number of ranges and distribute entries among them evenly, so that their
+        //lengths differ by at most one. Do not touch the dataset if it does not need to be split
+        unsigned long const nRanges = (nSelected + maxEvents - 1) / maxEvents;
+        
+        if (nRanges == 1)
+        {
+            splitDatasets.emplace(std::move(dataset));
+            continue;
+        }
+        
+        unsigned long start = firstEntry;
+        
+        for (unsigned long i = 0; i < nRanges; ++i)
+        {
+            unsigned long const rangeSize = nSelected / nRanges +
+              ((i < nSelected % nRanges) ? 1 : 0);
+            Dataset part(dataset);
+            part.SetEntryRange(start, start + rangeSize - 1);
+            splitDatasets.emplace(std::move(part));
+            start += rangeSize;
+        }
+    }
+    
+    std::swap(datasets, splitDatasets);
+    
+    logger << timestamp << nDatasets << " atomic datasets have been split into " <<
+      datasets.size() << " ranges of entries." << eom;
 }
@@ -16,6 +16,10 @@ void Service::EndRun()
 {}
 
 
+void Service::EndJob()
+{}
+
+
 std::string const &Service::GetName() const
 {
     return name;
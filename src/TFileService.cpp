@@ -1,20 +1,104 @@
 #include <mensura/TFileService.hpp>
 
 #include <mensura/Dataset.hpp>
+#include <mensura/Logger.hpp>
+
+#include <TFileMerger.h>
 
 #include <boost/algorithm/string/predicate.hpp>
 
 #include <algorithm>
 #include <filesystem>
+#include <sstream>
 
 
 namespace fs = std::filesystem;
+using namespace logging;
 using namespace std::literals::string_literals;
 
 
+TFileService::PartialOutputs::~PartialOutputs() noexcept
+{
+    try
+    {
+        Merge();
+    }
+    catch (std::exception const &e)
+    {
+        logger << "Error in TFileService: " << e.what() << eom;
+    }
+}
+
+
+void TFileService::PartialOutputs::Merge()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> failedFiles;
+    
+    for (auto &p: parts)
+    {
+        auto const &mergedFileName = p.first;
+        auto &partFiles = p.second;
+        
+        // Order partial files according to their ranges of entries so that the order of events in
+        //merged trees is preserved
+        std::sort(partFiles.begin(), partFiles.end());
+        
+        try
+        {
+            if (partFiles.size() == 1)
+                fs::rename(partFiles.front().second, mergedFileName);
+            else
+            {
+                TFileMerger merger(false, false);
+                merger.SetPrintLevel(0);
+                merger.OutputFile(mergedFileName.c_str(), "recreate");
+                
+                for (auto const &part: partFiles)
+                    merger.AddFile(part.second.c_str(), false);
+                
+                if (not merger.Merge())
+                {
+                    logger << "Error in TFileService: Failed to merge partial files into " <<
+                      "file \"" << mergedFileName << "\". Partial files are kept." << eom;
+                    failedFiles.emplace_back(mergedFileName);
+                    continue;
+                }
+                
+                for (auto const &part: partFiles)
+                    fs::remove(part.second);
+            }
+        }
+        catch (std::exception const &e)
+        {
+            logger << "Error in TFileService: Failed to produce file \"" << mergedFileName <<
+              "\" from partial files. " << e.what() << eom;
+            failedFiles.emplace_back(mergedFileName);
+        }
+    }
+    
+    parts.clear();
+    
+    if (not failedFiles.empty())
+    {
+        std::ostringstream message;
+        message << "TFileService::PartialOutputs::Merge: Failed to produce " <<
+          failedFiles.size() << " output file(s) from partial files:";
+        
+        for (auto const &name: failedFiles)
+            message << " \"" << name << "\"";
+        
+        message << ".";
+        throw std::runtime_error(message.str());
+    }
+}
+
+
 TFileService::TFileService(std::string const &name, std::string const &outFileName_):
     Service(name),
-    outFileName(outFileName_)
+    outFileName(outFileName_),
+    curFirstEntry(0),
+    partialOutputs(std::make_shared<PartialOutputs>())
 {
     CheckOutputPath();
 }
@@ -22,7 +106,9 @@ TFileService::TFileService(std::string const &name, std::string const &outFileNa
 
 TFileService::TFileService(std::string const &outFileName_):
     Service("TFileService"),
-    outFileName(outFileName_)
+    outFileName(outFileName_),
+    curFirstEntry(0),
+    partialOutputs(std::make_shared<PartialOutputs>())
 {
     CheckOutputPath();
 }
@@ -30,7 +116,9 @@ TFileService::TFileService(std::string const &outFileName_):
 
 TFileService::TFileService(TFileService const &src) noexcept:
     Service(src),
-    outFileName(src.outFileName)
+    outFileName(src.outFileName),
+    curFirstEntry(0),
+    partialOutputs(src.partialOutputs)  // shared
 {}
 
 
@@ -52,6 +140,23 @@ void TFileService::BeginRun(Dataset const &dataset)
     }
     
     
+    // If only a range of entries is processed, write a partial file, which will be merged later
+    curMergedFileName.clear();
+    
+    if (dataset.HasEntryRange())
+    {
+        curMergedFileName = curOutFileName;
+        curFirstEntry = dataset.GetFirstEntry();
+        
+        fs::path partPath(curOutFileName);
+        std::ostringstream partName;
+        partName << partPath.stem().string() << "_entries" << dataset.GetFirstEntry() << "-" <<
+          dataset.GetLastEntry() << partPath.extension().string();
+        partPath.replace_filename(partName.str());
+        curOutFileName = partPath.string();
+    }
+    
+    
     // Create the output file
     ROOTLock::Lock();
     outFile.reset(new TFile(curOutFileName.c_str(), "recreate"));
@@ -65,13 +170,44 @@ Service *TFileService::Clone() const
 }
 
 
+TDirectory *TFileService::GetDirectory(std::string const &inFileDirectory) const
+{
+    // Make sure the output file exists
+    if (not outFile)
+        throw std::runtime_error("TFileService::GetDirectory: This method is called before the "
+          "output file is created.");
+    
+    TDirectory *d = outFile->GetDirectory(inFileDirectory.c_str());
+    
+    if (not d)
+        d = outFile->mkdir(inFileDirectory.c_str());
+    
+    return d;
+}
+
+
 void TFileService::EndRun()
 {
     // Write all objects associated with the current file and close it
     ROOTLock::Lock();
+    std::string const curOutFileName(outFile->GetName());
     outFile->Write();
     outFile.reset();
     ROOTLock::Unlock();
+    
+    
+    // Register the partial file for subsequent merging
+    if (not curMergedFileName.empty())
+    {
+        std::lock_guard<std::mutex> lock(partialOutputs->mutex);
+        partialOutputs->parts[curMergedFileName].emplace_back(curFirstEntry, curOutFileName);
+    }
+}
+
+
+void TFileService::EndJob()
+{
+    partialOutputs->Merge();
 }
 
 
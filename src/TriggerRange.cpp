@@ -38,6 +38,18 @@ std::string const &TriggerRange::GetDataTriggerPattern() const
 }
 
 
+EventID const &TriggerRange::GetFirstEvent() const
+{
+    return firstEvent;
+}
+
+
+EventID const &TriggerRange::GetLastEvent() const
+{
+    return lastEvent;
+}
+
+
 double TriggerRange::GetLuminosity() const
 {
     return intLumi;
@@ -0,0 +1,42 @@
+#include <mensura/UserProperties.hpp>
+
+#include <sstream>
+#include <stdexcept>
+
+
+std::mutex UserPropertyRegistry::registryMutex;
+std::unordered_map<std::string, UserPropertyHandle> UserPropertyRegistry::handles;
+std::deque<std::string> UserPropertyRegistry::labels;
+
+
+UserPropertyHandle UserPropertyRegistry::GetHandle(std::string const &label)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto const res = handles.find(label);
+    
+    if (res != handles.end())
+        return res->second;
+    
+    UserPropertyHandle const handle = UserPropertyHandle(labels.size());
+    labels.emplace_back(label);
+    handles.emplace(label, handle);
+    
+    return handle;
+}
+
+
+std::string const &UserPropertyRegistry::GetLabel(UserPropertyHandle handle)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    unsigned const index = unsigned(handle);
+    
+    if (index >= labels.size())
+    {
+        std::ostringstream message;
+        message << "UserPropertyRegistry::GetLabel: Handle " << index << " has not been " <<
+          "registered.";
+        throw std::runtime_error(message.str());
+    }
+    
+    return labels[index];
+}
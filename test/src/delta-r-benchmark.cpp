@@ -0,0 +1,217 @@
+/**
+ * Compares the vectorised computation of angular distances in DeltaR2Kernel with the scalar loops
+ * previously used in PECJetMETReader for cleaning of jets against leptons and for matching to
+ * generator-level jets. Random configurations of jets, leptons, and generator-level jets are
+ * generated, and the results of both implementations are required to coincide bit for bit. The
+ * time spent in each implementation is reported. The optional command line argument gives the
+ * number of generated events (100000 by default).
+ */
+
+#include <mensura/DeltaR2Kernel.hpp>
+
+#include <TMath.h>
+#include <TVector2.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+/// Directions and transverse momenta of a collection of objects, in the layout used by the kernel
+struct Objects
+{
+    vector<double> etas, phis, pts;
+};
+
+
+/// Event with jets, leptons, and generator-level jets
+struct Event
+{
+    Objects jets, leptons, genJets;
+};
+
+
+/**
+ * Generates random objects
+ * 
+ * A small fraction of azimuthal angles is taken outside of the range [-pi, pi] so that the
+ * fallback for such angles is exercised.
+ */
+void Generate(Objects &objects, unsigned n, mt19937 &generator)
+{
+    uniform_real_distribution<double> etaDistr(-2.5, 2.5), phiDistr(-TMath::Pi(), TMath::Pi());
+    uniform_real_distribution<double> ptDistr(20., 200.), uniformDistr(0., 1.);
+    
+    for (unsigned i = 0; i < n; ++i)
+    {
+        objects.etas.emplace_back(etaDistr(generator));
+        objects.phis.emplace_back(phiDistr(generator) +
+          ((uniformDistr(generator) < 0.01) ? 2 * TMath::TwoPi() : 0.));
+        objects.pts.emplace_back(ptDistr(generator));
+    }
+}
+
+
+/// Reference implementation of cleaning, as in the original code of PECJetMETReader
+size_t CleanReference(double eta, double phi, Objects const &leptons, double leptonDR2)
+{
+    for (size_t i = 0; i < leptons.etas.size(); ++i)
+    {
+        double const dR2 = pow(eta - leptons.etas[i], 2) +
+          pow(TVector2::Phi_mpi_pi(phi - leptons.phis[i]), 2);
+        
+        if (dR2 < leptonDR2)
+            return i;
+    }
+    
+    return leptons.etas.size();
+}
+
+
+/// Reference implementation of matching, as in the original code of PECJetMETReader
+size_t MatchReference(double eta, double phi, double pt, Objects const &genJets, double maxDR2,
+  double maxDPt)
+{
+    double minDR2 = maxDR2;
+    size_t matched = genJets.etas.size();
+    
+    for (size_t i = 0; i < genJets.etas.size(); ++i)
+    {
+        double const dR2 = pow(eta - genJets.etas[i], 2) +
+          pow(TVector2::Phi_mpi_pi(phi - genJets.phis[i]), 2);
+        
+        if (dR2 < minDR2 and abs(pt - genJets.pts[i]) < maxDPt)
+        {
+            matched = i;
+            minDR2 = dR2;
+        }
+    }
+    
+    return matched;
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc > 2)
+    {
+        cerr << "Usage: " << argv[0] << " [numEvents]" << endl;
+        return EXIT_FAILURE;
+    }
+    
+    unsigned const numEvents = (argc > 1) ? stoul(argv[1]) : 100000;
+    
+    cout << "Vectorised implementation is " << ((DeltaR2Kernel::UsesAVX2()) ? "" : "not ") <<
+      "used" << endl;
+    
+    
+    // Generate events
+    mt19937 generator(4357);
+    uniform_int_distribution<unsigned> numJetsDistr(0, 15), numLeptonsDistr(0, 4),
+      numGenJetsDistr(0, 25);
+    vector<Event> events(numEvents);
+    
+    for (auto &event: events)
+    {
+        Generate(event.jets, numJetsDistr(generator), generator);
+        Generate(event.leptons, numLeptonsDistr(generator), generator);
+        Generate(event.genJets, numGenJetsDistr(generator), generator);
+    }
+    
+    double const leptonDR2 = pow(0.4, 2), maxDR2 = pow(0.2, 2), maxDPt = 30.;
+    vector<double> dR2Kernel, dR2Reference;
+    
+    
+    // Compare the results
+    unsigned long numMismatches = 0;
+    
+    for (auto const &event: events)
+    {
+        for (size_t j = 0; j < event.jets.etas.size(); ++j)
+        {
+            double const eta = event.jets.etas[j], phi = event.jets.phis[j],
+              pt = event.jets.pts[j];
+            auto const &genJets = event.genJets;
+            size_t const n = genJets.etas.size();
+            
+            dR2Kernel.resize(n);
+            DeltaR2Kernel::Compute(eta, phi, genJets.etas.data(), genJets.phis.data(), n,
+              dR2Kernel.data());
+            
+            dR2Reference.clear();
+            
+            for (size_t i = 0; i < n; ++i)
+                dR2Reference.emplace_back(pow(eta - genJets.etas[i], 2) +
+                  pow(TVector2::Phi_mpi_pi(phi - genJets.phis[i]), 2));
+            
+            if (memcmp(dR2Kernel.data(), dR2Reference.data(), n * sizeof(double)) != 0)
+                ++numMismatches;
+            
+            if (DeltaR2Kernel::FindFirstWithin(eta, phi, event.leptons.etas.data(),
+              event.leptons.phis.data(), event.leptons.etas.size(), leptonDR2) !=
+              CleanReference(eta, phi, event.leptons, leptonDR2))
+                ++numMismatches;
+            
+            for (double const dPt: {maxDPt, numeric_limits<double>::infinity()})
+            {
+                if (DeltaR2Kernel::FindClosest(eta, phi, pt, genJets.etas.data(),
+                  genJets.phis.data(), genJets.pts.data(), n, maxDR2, dPt) !=
+                  MatchReference(eta, phi, pt, genJets, maxDR2, dPt))
+                    ++numMismatches;
+            }
+        }
+    }
+    
+    cout << "Number of mismatches: " << numMismatches << endl;
+    
+    
+    // Measure the time needed for cleaning and matching with both implementations
+    for (bool const useKernel: {false, true})
+    {
+        auto const start = chrono::steady_clock::now();
+        unsigned long checksum = 0;
+        
+        for (auto const &event: events)
+        {
+            auto const &leptons = event.leptons;
+            auto const &genJets = event.genJets;
+            
+            for (size_t j = 0; j < event.jets.etas.size(); ++j)
+            {
+                double const eta = event.jets.etas[j], phi = event.jets.phis[j],
+                  pt = event.jets.pts[j];
+                
+                if (useKernel)
+                {
+                    checksum += DeltaR2Kernel::FindFirstWithin(eta, phi, leptons.etas.data(),
+                      leptons.phis.data(), leptons.etas.size(), leptonDR2);
+                    checksum += DeltaR2Kernel::FindClosest(eta, phi, pt, genJets.etas.data(),
+                      genJets.phis.data(), genJets.pts.data(), genJets.etas.size(), maxDR2,
+                      maxDPt);
+                }
+                else
+                {
+                    checksum += CleanReference(eta, phi, leptons, leptonDR2);
+                    checksum += MatchReference(eta, phi, pt, genJets, maxDR2, maxDPt);
+                }
+            }
+        }
+        
+        double const time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        
+        cout << ((useKernel) ? "DeltaR2Kernel: " : "Scalar loops: ") <<
+          time / numEvents * 1e9 << " ns/event, checksum " << checksum << endl;
+    }
+    
+    
+    return (numMismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
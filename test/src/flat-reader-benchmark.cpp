@@ -0,0 +1,314 @@
+/**
+ * Compares the speed of reading jets, leptons, and pile-up information with PEC readers and with
+ * readers for flat columnar files. The content of the PEC file is first converted into the flat
+ * format, so that both sets of readers process the same events.
+ */
+
+#include <mensura/Dataset.hpp>
+#include <mensura/Processor.hpp>
+
+#include <mensura/FlatReader/FlatInputData.hpp>
+#include <mensura/FlatReader/FlatJetMETReader.hpp>
+#include <mensura/FlatReader/FlatLeptonReader.hpp>
+#include <mensura/FlatReader/FlatPileUpReader.hpp>
+
+#include <mensura/PECReader/PECInputData.hpp>
+#include <mensura/PECReader/PECJetMETReader.hpp>
+#include <mensura/PECReader/PECLeptonReader.hpp>
+#include <mensura/PECReader/PECPileUpReader.hpp>
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+using namespace std;
+
+
+/// Buffers for columns of the flat tree
+struct FlatEvent
+{
+    static constexpr int maxSize = 128;
+    
+    UInt_t run, lumi;
+    ULong64_t event;
+    
+    Int_t nJet;
+    Float_t jetPt[maxSize], jetEta[maxSize], jetPhi[maxSize], jetMass[maxSize];
+    Float_t jetRawFactor[maxSize], jetArea[maxSize], jetPileUpID[maxSize];
+    Float_t jetBTagCSV[maxSize], jetBTagCMVA[maxSize], jetBTagDeepCSV[maxSize];
+    Int_t jetID[maxSize], jetHadronFlavour[maxSize], jetPartonFlavour[maxSize];
+    Float_t metPt, metPhi, rawMETPt, rawMETPhi;
+    
+    Int_t nElectron;
+    Float_t electronPt[maxSize], electronEta[maxSize], electronPhi[maxSize];
+    Float_t electronDEtaSC[maxSize], electronRelIso[maxSize];
+    Int_t electronCharge[maxSize], electronCutBased[maxSize];
+    
+    Int_t nMuon;
+    Float_t muonPt[maxSize], muonEta[maxSize], muonPhi[maxSize], muonRelIso[maxSize];
+    Int_t muonCharge[maxSize];
+    Bool_t muonLooseID[maxSize], muonTightID[maxSize];
+    
+    Int_t numPV;
+    Float_t expectedPileUp, rho;
+};
+
+
+/**
+ * Converts the content of a PEC file into the flat format
+ * 
+ * Jets are written without any selection. All loose leptons are written, and IDs are set such
+ * that the flat reader classifies them in the same way as the PEC reader.
+ */
+void ConvertToFlat(string const &pecFileName, string const &flatFileName)
+{
+    Dataset dataset(Dataset::Type::MC);
+    dataset.AddFile(pecFileName);
+    
+    Processor processor;
+    processor.RegisterPlugin(new PECInputData);
+    processor.RegisterPlugin(new PECLeptonReader);
+    
+    PECJetMETReader *jetReader = new PECJetMETReader;
+    jetReader->SetApplyJetID(false);
+    jetReader->ConfigureLeptonCleaning("");
+    jetReader->ReadRawMET();
+    processor.RegisterPlugin(jetReader);
+    
+    processor.RegisterPlugin(new PECPileUpReader);
+    
+    auto const *inputData = dynamic_cast<PECInputData const *>(processor.GetPlugin("InputData"));
+    auto const *leptonReader = dynamic_cast<LeptonReader const *>(processor.GetPlugin("Leptons"));
+    auto const *puReader = dynamic_cast<PileUpReader const *>(processor.GetPlugin("PileUp"));
+    
+    
+    // Set up the output tree
+    TFile outputFile(flatFileName.c_str(), "recreate");
+    TTree tree("Events", "Flat version of a PEC file");
+    FlatEvent e;
+    
+    tree.Branch("run", &e.run, "run/i");
+    tree.Branch("luminosityBlock", &e.lumi, "luminosityBlock/i");
+    tree.Branch("event", &e.event, "event/l");
+    
+    tree.Branch("nJet", &e.nJet, "nJet/I");
+    tree.Branch("Jet_pt", e.jetPt, "Jet_pt[nJet]/F");
+    tree.Branch("Jet_eta", e.jetEta, "Jet_eta[nJet]/F");
+    tree.Branch("Jet_phi", e.jetPhi, "Jet_phi[nJet]/F");
+    tree.Branch("Jet_mass", e.jetMass, "Jet_mass[nJet]/F");
+    tree.Branch("Jet_rawFactor", e.jetRawFactor, "Jet_rawFactor[nJet]/F");
+    tree.Branch("Jet_area", e.jetArea, "Jet_area[nJet]/F");
+    tree.Branch("Jet_puIdDisc", e.jetPileUpID, "Jet_puIdDisc[nJet]/F");
+    tree.Branch("Jet_btagCSVV2", e.jetBTagCSV, "Jet_btagCSVV2[nJet]/F");
+    tree.Branch("Jet_btagCMVA", e.jetBTagCMVA, "Jet_btagCMVA[nJet]/F");
+    tree.Branch("Jet_btagDeepB", e.jetBTagDeepCSV, "Jet_btagDeepB[nJet]/F");
+    tree.Branch("Jet_jetId", e.jetID, "Jet_jetId[nJet]/I");
+    tree.Branch("Jet_hadronFlavour", e.jetHadronFlavour, "Jet_hadronFlavour[nJet]/I");
+    tree.Branch("Jet_partonFlavour", e.jetPartonFlavour, "Jet_partonFlavour[nJet]/I");
+    tree.Branch("MET_pt", &e.metPt, "MET_pt/F");
+    tree.Branch("MET_phi", &e.metPhi, "MET_phi/F");
+    tree.Branch("RawMET_pt", &e.rawMETPt, "RawMET_pt/F");
+    tree.Branch("RawMET_phi", &e.rawMETPhi, "RawMET_phi/F");
+    
+    tree.Branch("nElectron", &e.nElectron, "nElectron/I");
+    tree.Branch("Electron_pt", e.electronPt, "Electron_pt[nElectron]/F");
+    tree.Branch("Electron_eta", e.electronEta, "Electron_eta[nElectron]/F");
+    tree.Branch("Electron_phi", e.electronPhi, "Electron_phi[nElectron]/F");
+    tree.Branch("Electron_deltaEtaSC", e.electronDEtaSC, "Electron_deltaEtaSC[nElectron]/F");
+    tree.Branch("Electron_pfRelIso03_all", e.electronRelIso,
+      "Electron_pfRelIso03_all[nElectron]/F");
+    tree.Branch("Electron_charge", e.electronCharge, "Electron_charge[nElectron]/I");
+    tree.Branch("Electron_cutBased", e.electronCutBased, "Electron_cutBased[nElectron]/I");
+    
+    tree.Branch("nMuon", &e.nMuon, "nMuon/I");
+    tree.Branch("Muon_pt", e.muonPt, "Muon_pt[nMuon]/F");
+    tree.Branch("Muon_eta", e.muonEta, "Muon_eta[nMuon]/F");
+    tree.Branch("Muon_phi", e.muonPhi, "Muon_phi[nMuon]/F");
+    tree.Branch("Muon_pfRelIso04_all", e.muonRelIso, "Muon_pfRelIso04_all[nMuon]/F");
+    tree.Branch("Muon_charge", e.muonCharge, "Muon_charge[nMuon]/I");
+    tree.Branch("Muon_looseId", e.muonLooseID, "Muon_looseId[nMuon]/O");
+    tree.Branch("Muon_tightId", e.muonTightID, "Muon_tightId[nMuon]/O");
+    
+    tree.Branch("PV_npvs", &e.numPV, "PV_npvs/I");
+    tree.Branch("Pileup_nTrueInt", &e.expectedPileUp, "Pileup_nTrueInt/F");
+    tree.Branch("fixedGridRhoFastjetAll", &e.rho, "fixedGridRhoFastjetAll/F");
+    
+    
+    // Copy all events
+    processor.OpenDataset(dataset);
+    
+    while (processor.ProcessEvent() != Plugin::EventOutcome::NoEvents)
+    {
+        auto const &eventID = inputData->GetEventID();
+        e.run = eventID.Run();
+        e.lumi = eventID.LumiBlock();
+        e.event = eventID.Event();
+        
+        e.nJet = 0;
+        
+        for (auto const &j: jetReader->GetJets())
+        {
+            if (e.nJet == FlatEvent::maxSize)
+                break;
+            
+            int const i = e.nJet++;
+            e.jetPt[i] = j.Pt();
+            e.jetEta[i] = j.Eta();
+            e.jetPhi[i] = j.Phi();
+            e.jetMass[i] = j.M();
+            e.jetRawFactor[i] = 1. - j.RawP4().Pt() / j.Pt();
+            e.jetArea[i] = j.Area();
+            e.jetPileUpID[i] = j.PileUpID();
+            e.jetBTagCSV[i] = j.BTag(BTagger::Algorithm::CSV);
+            e.jetBTagCMVA[i] = j.BTag(BTagger::Algorithm::CMVA);
+            e.jetBTagDeepCSV[i] = j.BTag(BTagger::Algorithm::DeepCSV);
+            e.jetID[i] = j.UserInt("ID");
+            e.jetHadronFlavour[i] = j.Flavour(Jet::FlavourType::Hadron);
+            e.jetPartonFlavour[i] = j.Flavour(Jet::FlavourType::Parton);
+        }
+        
+        e.metPt = jetReader->GetMET().Pt();
+        e.metPhi = jetReader->GetMET().Phi();
+        e.rawMETPt = jetReader->GetRawMET().Pt();
+        e.rawMETPhi = jetReader->GetRawMET().Phi();
+        
+        
+        // Tight leptons are a subset of loose ones. Identify them by their momenta
+        e.nElectron = e.nMuon = 0;
+        
+        for (auto const &l: leptonReader->GetLooseLeptons())
+        {
+            bool isTight = false;
+            
+            for (auto const &tightLepton: leptonReader->GetLeptons())
+            {
+                if (tightLepton.GetFlavour() == l.GetFlavour() and tightLepton.Pt() == l.Pt())
+                {
+                    isTight = true;
+                    break;
+                }
+            }
+            
+            if (l.GetFlavour() == Lepton::Flavour::Electron and
+              e.nElectron < FlatEvent::maxSize)
+            {
+                int const i = e.nElectron++;
+                e.electronPt[i] = l.Pt();
+                e.electronEta[i] = l.Eta();
+                e.electronPhi[i] = l.Phi();
+                e.electronDEtaSC[i] = l.UserFloat("etaSC") - l.Eta();
+                e.electronRelIso[i] = l.RelIso();
+                e.electronCharge[i] = l.Charge();
+                e.electronCutBased[i] = (isTight) ? 4 : 1;
+            }
+            else if (l.GetFlavour() == Lepton::Flavour::Muon and e.nMuon < FlatEvent::maxSize)
+            {
+                int const i = e.nMuon++;
+                e.muonPt[i] = l.Pt();
+                e.muonEta[i] = l.Eta();
+                e.muonPhi[i] = l.Phi();
+                e.muonRelIso[i] = l.RelIso();
+                e.muonCharge[i] = l.Charge();
+                e.muonLooseID[i] = true;
+                e.muonTightID[i] = isTight;
+            }
+        }
+        
+        e.numPV = puReader->GetNumVertices();
+        e.expectedPileUp = puReader->GetExpectedPileUp();
+        e.rho = puReader->GetRho();
+        
+        tree.Fill();
+    }
+    
+    tree.Write();
+}
+
+
+/**
+ * Reads all events in the given dataset with a configured processor
+ * 
+ * Jets, leptons, and pile-up information are accessed in each event so that lazy readers unpack
+ * them. Prints the time per event and a checksum that should coincide for the two formats.
+ */
+void MeasureReading(string const &label, Processor &processor, Dataset const &dataset)
+{
+    auto const *leptonReader = dynamic_cast<LeptonReader const *>(processor.GetPlugin("Leptons"));
+    auto const *jetReader = dynamic_cast<JetMETReader const *>(processor.GetPlugin("JetMET"));
+    auto const *puReader = dynamic_cast<PileUpReader const *>(processor.GetPlugin("PileUp"));
+    
+    auto const start = chrono::steady_clock::now();
+    processor.OpenDataset(dataset);
+    
+    unsigned long numEvents = 0;
+    double checksum = 0.;
+    
+    while (processor.ProcessEvent() != Plugin::EventOutcome::NoEvents)
+    {
+        ++numEvents;
+        
+        for (auto const &j: jetReader->GetJets())
+            checksum += j.Pt();
+        
+        checksum += leptonReader->GetLeptons().size() + jetReader->GetMET().Pt() +
+          puReader->GetNumVertices();
+    }
+    
+    double const time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    cout << label << ": " << numEvents << " events, " << 1e6 * time / numEvents <<
+      " us/event, checksum " << checksum << endl;
+}
+
+
+int main()
+{
+    string const pecFileName("../ttbar.root"), flatFileName("ttbar-flat.root");
+    ConvertToFlat(pecFileName, flatFileName);
+    
+    
+    // Reading with PEC readers
+    Dataset pecDataset(Dataset::Type::MC);
+    pecDataset.AddFile(pecFileName);
+    
+    Processor pecProcessor;
+    pecProcessor.RegisterPlugin(new PECInputData);
+    pecProcessor.RegisterPlugin(new PECLeptonReader);
+    
+    PECJetMETReader *pecJetReader = new PECJetMETReader;
+    pecJetReader->SetSelection(30., 2.4);
+    pecProcessor.RegisterPlugin(pecJetReader);
+    
+    pecProcessor.RegisterPlugin(new PECPileUpReader);
+    
+    
+    // Reading with flat readers
+    Dataset flatDataset(Dataset::Type::MC);
+    flatDataset.AddFile(flatFileName);
+    
+    Processor flatProcessor;
+    flatProcessor.RegisterPlugin(new FlatInputData);
+    flatProcessor.RegisterPlugin(new FlatLeptonReader);
+    
+    FlatJetMETReader *flatJetReader = new FlatJetMETReader;
+    flatJetReader->SetSelection(30., 2.4);
+    flatProcessor.RegisterPlugin(flatJetReader);
+    
+    flatProcessor.RegisterPlugin(new FlatPileUpReader);
+    
+    
+    // Run each reading twice so that both files are in the page cache for the second pass
+    for (unsigned pass = 0; pass < 2; ++pass)
+    {
+        MeasureReading("PEC ", pecProcessor, pecDataset);
+        MeasureReading("Flat", flatProcessor, flatDataset);
+    }
+    
+    
+    return EXIT_SUCCESS;
+}
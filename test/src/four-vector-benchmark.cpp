@@ -0,0 +1,197 @@
+/**
+ * Measures the effect of storing four-momenta of physics objects as PtEtaPhiMVector instead of
+ * TLorentzVector. Components of all jets in the test file are first read with PECJetMETReader.
+ * Then the main steps of the jet loop of that reader (construction of the four-momentum from
+ * pt, eta, phi, and mass, application of the correction factor, selection on pt and |eta|, and
+ * access to phi needed for cleaning against leptons) are repeated with both representations.
+ * Finally, the throughput of the complete PEC reader chain is measured. The optional command line
+ * argument gives the number of repetitions of the jet loop (20 by default).
+ */
+
+#include <mensura/Dataset.hpp>
+#include <mensura/Processor.hpp>
+#include <mensura/PtEtaPhiMVector.hpp>
+
+#include <mensura/PECReader/PECInputData.hpp>
+#include <mensura/PECReader/PECJetMETReader.hpp>
+#include <mensura/PECReader/PECLeptonReader.hpp>
+#include <mensura/PECReader/PECPileUpReader.hpp>
+
+#include <TLorentzVector.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+/// Components of a jet as stored in a PEC file
+struct JetComponents
+{
+    double pt, eta, phi, mass;
+    double corrFactor;
+};
+
+
+/// Jets from all events, with events delimited by offsets
+struct JetSample
+{
+    vector<JetComponents> jets;
+    vector<size_t> eventOffsets;
+};
+
+
+/// Reads components of all jets in the given dataset, without any selection
+JetSample ReadJets(Dataset const &dataset)
+{
+    Processor processor;
+    processor.RegisterPlugin(new PECInputData);
+    
+    PECJetMETReader *jetReader = new PECJetMETReader;
+    jetReader->SetSelection(0., numeric_limits<double>::infinity());
+    jetReader->SetApplyJetID(false);
+    jetReader->ConfigureLeptonCleaning("");
+    processor.RegisterPlugin(jetReader);
+    
+    JetSample sample;
+    processor.OpenDataset(dataset);
+    
+    while (processor.ProcessEvent() != Plugin::EventOutcome::NoEvents)
+    {
+        sample.eventOffsets.emplace_back(sample.jets.size());
+        
+        for (auto const &j: jetReader->GetJets())
+        {
+            TLorentzVector const rawP4 = j.RawP4();
+            sample.jets.push_back({rawP4.Pt(), rawP4.Eta(), rawP4.Phi(), rawP4.M(),
+              j.Pt() / rawP4.Pt()});
+        }
+    }
+    
+    sample.eventOffsets.emplace_back(sample.jets.size());
+    return sample;
+}
+
+
+/**
+ * Runs the jet loop with the given type of four-momentum
+ * 
+ * Selected four-momenta are stored in a buffer that is reused between events, as done in the
+ * reader. Prints the time per jet and a checksum that should coincide for all types up to
+ * rounding.
+ */
+template<typename P4>
+void RunJetLoop(string const &label, JetSample const &sample, unsigned numRepetitions)
+{
+    vector<P4> selectedJets;
+    double checksum = 0.;
+    
+    auto const start = chrono::steady_clock::now();
+    
+    for (unsigned rep = 0; rep < numRepetitions; ++rep)
+    {
+        for (size_t iEvent = 0; iEvent + 1 < sample.eventOffsets.size(); ++iEvent)
+        {
+            selectedJets.clear();
+            
+            for (size_t i = sample.eventOffsets[iEvent]; i < sample.eventOffsets[iEvent + 1]; ++i)
+            {
+                auto const &j = sample.jets[i];
+                
+                P4 p4;
+                p4.SetPtEtaPhiM(j.pt, j.eta, j.phi, j.mass);
+                p4 *= j.corrFactor;
+                
+                if (p4.Pt() < 30. or fabs(p4.Eta()) > 2.4)
+                    continue;
+                
+                checksum += p4.Phi();
+                selectedJets.emplace_back(p4);
+            }
+            
+            for (auto const &p4: selectedJets)
+                checksum += p4.Pt();
+        }
+    }
+    
+    double const time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    cout << label << " (" << sizeof(P4) << " bytes): " <<
+      time / (numRepetitions * sample.jets.size()) * 1e9 << " ns/jet, checksum " << checksum <<
+      endl;
+}
+
+
+/// Measures the throughput of the PEC reader chain, accessing jets in each event
+void MeasureReading(Dataset const &dataset)
+{
+    Processor processor;
+    processor.MeasureStageThroughput();
+    
+    processor.RegisterPlugin(new PECInputData);
+    processor.RegisterPlugin(new PECLeptonReader);
+    
+    PECJetMETReader *jetReader = new PECJetMETReader;
+    jetReader->SetSelection(30., 2.4);
+    processor.RegisterPlugin(jetReader);
+    
+    processor.RegisterPlugin(new PECPileUpReader);
+    
+    auto const start = chrono::steady_clock::now();
+    processor.OpenDataset(dataset);
+    
+    unsigned long numEvents = 0;
+    double checksum = 0.;
+    
+    while (processor.ProcessEvent() != Plugin::EventOutcome::NoEvents)
+    {
+        ++numEvents;
+        
+        for (auto const &j: jetReader->GetJets())
+            checksum += j.Pt();
+    }
+    
+    double const time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    cout << "Reader chain: " << numEvents / time << " events/s, checksum " << checksum << endl;
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc > 2)
+    {
+        cerr << "Usage: " << argv[0] << " [numRepetitions]" << endl;
+        return EXIT_FAILURE;
+    }
+    
+    unsigned const numRepetitions = (argc > 1) ? stoul(argv[1]) : 20;
+    
+    
+    Dataset dataset(Dataset::Type::MC);
+    dataset.AddFile("../ttbar.root");
+    
+    JetSample const sample = ReadJets(dataset);
+    cout << "Read " << sample.jets.size() << " jets in " << sample.eventOffsets.size() - 1 <<
+      " events" << endl;
+    
+    
+    // Run each version twice so that the first run of the first one does not suffer from cold
+    //caches
+    for (unsigned pass = 0; pass < 2; ++pass)
+    {
+        RunJetLoop<TLorentzVector>("TLorentzVector", sample, numRepetitions);
+        RunJetLoop<PtEtaPhiMVector>("PtEtaPhiMVector", sample, numRepetitions);
+    }
+    
+    MeasureReading(dataset);
+    
+    
+    return EXIT_SUCCESS;
+}
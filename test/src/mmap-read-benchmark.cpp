@@ -0,0 +1,140 @@
+/**
+ * Compares reading of a PEC file with ordinary system calls and through a memory mapping. The
+ * test file is scaled up by merging several copies of it so that the reading takes a measurable
+ * time. The reading mode is chosen with the first command line argument ("default" or "mmap") so
+ * that each mode can be run in a separate process and memory usage is not mixed between them.
+ * The second optional argument gives the number of copies (20 by default).
+ */
+
+#include <mensura/Dataset.hpp>
+#include <mensura/Processor.hpp>
+
+#include <mensura/PECReader/PECInputData.hpp>
+#include <mensura/PECReader/PECJetMETReader.hpp>
+#include <mensura/PECReader/PECLeptonReader.hpp>
+#include <mensura/PECReader/PECPileUpReader.hpp>
+
+#include <TFileMerger.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+using namespace std;
+
+
+/// Creates a file that contains the given number of copies of the source PEC file
+void ScaleUpFile(string const &srcFileName, string const &scaledFileName, unsigned numCopies)
+{
+    TFileMerger merger(false);
+    merger.OutputFile(scaledFileName.c_str(), "recreate");
+    
+    for (unsigned i = 0; i < numCopies; ++i)
+        merger.AddFile(srcFileName.c_str(), false);
+    
+    if (not merger.Merge())
+    {
+        cerr << "Failed to create file " << scaledFileName << "." << endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/**
+ * Prints memory usage of the process
+ * 
+ * Reports the current and peak resident set size. The former is split into anonymous memory and
+ * pages mapped from files, which include the memory-mapped input file.
+ */
+void PrintMemoryUsage()
+{
+    ifstream statusFile("/proc/self/status");
+    string line;
+    
+    while (getline(statusFile, line))
+    {
+        if (line.compare(0, 6, "VmRSS:") == 0 or line.compare(0, 6, "VmHWM:") == 0 or
+          line.compare(0, 8, "RssAnon:") == 0 or line.compare(0, 8, "RssFile:") == 0)
+            cout << "  " << line << endl;
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 or argc > 3 or (string(argv[1]) != "default" and string(argv[1]) != "mmap"))
+    {
+        cerr << "Usage: " << argv[0] << " (default | mmap) [numCopies]" << endl;
+        return EXIT_FAILURE;
+    }
+    
+    bool const useMapping = (string(argv[1]) == "mmap");
+    unsigned const numCopies = (argc > 2) ? stoul(argv[2]) : 20;
+    
+    
+    // Create the scaled-up file unless it exists already
+    string const scaledFileName("ttbar-x" + to_string(numCopies) + ".root");
+    
+    if (not filesystem::exists(scaledFileName))
+        ScaleUpFile("../ttbar.root", scaledFileName, numCopies);
+    
+    
+    // Set up reading of jets, leptons, and pile-up information
+    Dataset dataset(Dataset::Type::MC);
+    dataset.AddFile(scaledFileName);
+    
+    Processor processor;
+    
+    PECInputData *inputData = new PECInputData;
+    inputData->SetMemoryMapping(useMapping);
+    processor.RegisterPlugin(inputData);
+    
+    processor.RegisterPlugin(new PECLeptonReader);
+    
+    PECJetMETReader *jetReader = new PECJetMETReader;
+    jetReader->SetSelection(30., 2.4);
+    processor.RegisterPlugin(jetReader);
+    
+    processor.RegisterPlugin(new PECPileUpReader);
+    
+    auto const *leptonReader = dynamic_cast<LeptonReader const *>(processor.GetPlugin("Leptons"));
+    auto const *puReader = dynamic_cast<PileUpReader const *>(processor.GetPlugin("PileUp"));
+    
+    
+    // Read the file twice. The first pass might be affected by the state of the page cache, while
+    //in the second one the file is certainly cached
+    double const fileSize = filesystem::file_size(scaledFileName) / 1048576.;
+    
+    for (unsigned pass = 0; pass < 2; ++pass)
+    {
+        auto const start = chrono::steady_clock::now();
+        processor.OpenDataset(dataset);
+        
+        unsigned long numEvents = 0;
+        double checksum = 0.;
+        
+        while (processor.ProcessEvent() != Plugin::EventOutcome::NoEvents)
+        {
+            ++numEvents;
+            
+            for (auto const &j: jetReader->GetJets())
+                checksum += j.Pt();
+            
+            checksum += leptonReader->GetLeptons().size() + puReader->GetNumVertices();
+        }
+        
+        double const time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        
+        cout << argv[1] << ", pass " << pass + 1 << ": " << numEvents << " events, " <<
+          numEvents / time << " events/s, " << fileSize / time << " MB/s, checksum " <<
+          checksum << endl;
+        PrintMemoryUsage();
+    }
+    
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+/**
+ * Checks that PECSkimWriter produces complete copies of data PEC files. The input file is given
+ * with the first command line argument. It is filtered with PECTriggerFilterData, using two
+ * trigger ranges separated at the run given with the second argument, with one trigger in each
+ * range (the third and fourth arguments). Selected events are copied into file skim-data.root,
+ * with parallel unpacking enabled in PECInputData and a tree loaded by a plugin placed after the
+ * writer. Then the check verifies that
+ *  - every copied tree contains all branches of the corresponding input tree;
+ *  - event IDs in the copy coincide with IDs of events selected in a separate pass over the input;
+ *  - the same trigger filter, when applied to the copy, accepts all events in it.
+ */
+
+#include <mensura/Dataset.hpp>
+#include <mensura/Processor.hpp>
+#include <mensura/TFileService.hpp>
+
+#include <mensura/PECReader/PECInputData.hpp>
+#include <mensura/PECReader/PECPileUpReader.hpp>
+#include <mensura/PECReader/PECSkimWriter.hpp>
+#include <mensura/PECReader/PECTriggerFilter.hpp>
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+/// Reads the given data file and returns IDs of events accepted by the trigger filter
+vector<EventID> SelectEvents(string const &fileName, list<TriggerRange> const &triggerRanges,
+  unsigned long *numEvents = nullptr)
+{
+    Dataset dataset(Dataset::Type::Data);
+    dataset.AddFile(fileName);
+    
+    Processor processor;
+    processor.RegisterPlugin(new PECInputData);
+    processor.RegisterPlugin(BuildPECTriggerFilter(true, triggerRanges));
+    
+    PECInputData const *inputData =
+      dynamic_cast<PECInputData const *>(processor.GetPlugin("InputData"));
+    
+    processor.OpenDataset(dataset);
+    vector<EventID> eventIDs;
+    unsigned long numRead = 0;
+    
+    while (true)
+    {
+        Plugin::EventOutcome const status = processor.ProcessEvent();
+        
+        if (status == Plugin::EventOutcome::NoEvents)
+            break;
+        
+        ++numRead;
+        
+        if (status == Plugin::EventOutcome::Ok)
+            eventIDs.emplace_back(inputData->GetEventID());
+    }
+    
+    if (numEvents)
+        *numEvents = numRead;
+    
+    return eventIDs;
+}
+
+
+/// Returns names of all branches of the given tree, including subbranches
+set<string> ListBranches(TTree *tree)
+{
+    set<string> names;
+    TObjArray *branches = tree->GetListOfBranches();
+    
+    for (int i = 0; i < branches->GetEntriesFast(); ++i)
+    {
+        TBranch *branch = static_cast<TBranch *>(branches->At(i));
+        names.emplace(branch->GetName());
+        
+        TObjArray *subBranches = branch->GetListOfBranches();
+        
+        for (int j = 0; j < subBranches->GetEntriesFast(); ++j)
+            names.emplace(subBranches->At(j)->GetName());
+    }
+    
+    return names;
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc != 5)
+    {
+        cerr << "Usage: " << argv[0] << " inputFile splitRun trigger1 trigger2" << endl;
+        return EXIT_FAILURE;
+    }
+    
+    string const inputFileName(argv[1]);
+    EventID::RunNumber_t const splitRun = stoul(argv[2]);
+    string const skimFileName("skim-data.root");
+    
+    
+    // Triggers. Each range uses its own trigger so that a copy that includes decisions of only
+    //the first range encountered would be detected
+    list<TriggerRange> triggerRanges;
+    triggerRanges.emplace_back(0, splitRun - 1, argv[3], 1e3 /* a dummy luminosity */, argv[3]);
+    triggerRanges.emplace_back(splitRun, -1, argv[4], 1e3 /* a dummy luminosity */, argv[4]);
+    
+    
+    // Copy selected events
+    {
+        Dataset dataset(Dataset::Type::Data);
+        dataset.AddFile(inputFileName);
+        
+        Processor processor;
+        processor.RegisterService(new TFileService(skimFileName));
+        
+        PECInputData *inputData = new PECInputData;
+        inputData->SetParallelUnpacking();
+        processor.RegisterPlugin(inputData);
+        
+        processor.RegisterPlugin(BuildPECTriggerFilter(true, triggerRanges));
+        processor.RegisterPlugin(new PECSkimWriter(PECSkimWriter::Mode::CopyTrees));
+        processor.RegisterPlugin(new PECPileUpReader);
+        
+        processor.ProcessDataset(dataset);
+        processor.EndJob();
+    }
+    
+    
+    bool success = true;
+    
+    
+    // Compare branches of the input and copied trees
+    {
+        unique_ptr<TFile> inputFile(TFile::Open(inputFileName.c_str()));
+        unique_ptr<TFile> skimFile(TFile::Open(skimFileName.c_str()));
+        
+        for (char const *treeName: {"pecEventID/EventID", "pecTrigger/TriggerInfo",
+          "pecPileUp/PileUp"})
+        {
+            TTree *inputTree = dynamic_cast<TTree *>(inputFile->Get(treeName));
+            TTree *skimTree = dynamic_cast<TTree *>(skimFile->Get(treeName));
+            
+            if (not skimTree)
+            {
+                cout << "Tree \"" << treeName << "\" is missing in the copy.\n";
+                success = false;
+                continue;
+            }
+            
+            auto const inputBranches = ListBranches(inputTree);
+            auto const skimBranches = ListBranches(skimTree);
+            
+            for (auto const &name: inputBranches)
+            {
+                if (skimBranches.count(name) == 0)
+                {
+                    cout << "Branch \"" << name << "\" of tree \"" << treeName <<
+                      "\" is missing in the copy.\n";
+                    success = false;
+                }
+            }
+        }
+    }
+    
+    
+    // Compare events selected from the input file and the events in the copy. Since the copy
+    //contains only accepted events, the filter must accept all of them
+    unsigned long numSkimEvents;
+    auto const inputIDs = SelectEvents(inputFileName, triggerRanges);
+    auto const skimIDs = SelectEvents(skimFileName, triggerRanges, &numSkimEvents);
+    
+    if (skimIDs.size() != numSkimEvents)
+    {
+        cout << "Only " << skimIDs.size() << " events out of " << numSkimEvents <<
+          " in the copy pass the trigger selection.\n";
+        success = false;
+    }
+    
+    if (inputIDs != skimIDs)
+    {
+        cout << "Event IDs in the copy differ from IDs of events selected in the input file.\n";
+        success = false;
+    }
+    
+    
+    cout << "Events selected: " << inputIDs.size() << '\n';
+    cout << ((success) ? "Check passed" : "Check failed") << endl;
+    
+    return (success) ? EXIT_SUCCESS : EXIT_FAILURE;
+}